@@ -12,25 +12,40 @@
 
 #include <larrys_pico/LCD1602.h>
 #include <larrys_pico/button_matrix.h>
+#include <larrys_pico/spsc_queue.h>
 
+#include <utility>
 #include <vector>
 
+#include "eval_worker.h"
+#include "keymap.h"
+#include "math/equation.h"
+#include "math/eval_environment.h"
 #include "math/expr_tree.h"
 
-#define MATRIX_ROW_SIZE 5
-#define MATRIX_COL_SIZE 9
-
 struct CalculatorState {
   // Holds a pointer to the current equation (should be index 0)
   // might be able to remove
-  std::vector<picolator::math::ExprTree::ExprVec> history;
+  std::vector<picolator::math::Equation> history;
   int history_cursor;
-  picolator::math::ExprTree::LiteralPtr ans = {0};
 
-  // Holds all the equations in memory
-  picolator::math::ExprTree::ExprVec equation;
+  // ANS and the variables, every solve reads them from here
+  picolator::math::EvalEnvironment env;
+
+  // The equation being typed, a byte per key
+  picolator::math::Equation equation;
   int cursor;
 
+  // Solves CALCULATE and the preview on the second line on core 1
+  EvalWorker worker;
+  // The equation changed while worker was busy, the preview it is solving
+  // (if any) is out of date
+  bool preview_pending = false;
+  // Keys pressed while worker was calculating, handled once it is done. A
+  // preview never holds keys back. Only the main loop uses it, a key that
+  // doesn't fit is dropped with "Busy, key lost" on the second line
+  SpscQueue<std::pair<uint8_t, uint8_t>, 16> queued_presses;
+
   // if the screen should get  cleared on next button press
   bool clear = false;
   bool cleared = false;  // If the screen got cleared this frame
@@ -38,12 +53,21 @@ struct CalculatorState {
   // if the new character should overwrite or insert into place
   bool insert_mode = false;
 
-  // 2nd layer toggle
-  bool layer2 = false;
+  // Keymap layer for the next key press, goes back to 0 after
+  uint8_t layer = 0;
 
-  // Hardware functions might make use of
+  // Precision CALCULATE solves with, the faster ones are for graphing
+  picolator::math::Program::Mode mode = picolator::math::Program::Mode::EXACT;
+
+  // Hardware functions might make use of. The main loop calls lcd.render,
+  // update just hands it a frame
   LCD1602 lcd;
 
   ButtonMatrix<MATRIX_ROW_SIZE, MATRIX_COL_SIZE> buttons = {
       {15, 11, 14, 13, 12}, {27, 26, 22, 21, 20, 19, 18, 17, 16}};
+
+  // buttons is scanned from scan_timer's interrupt, which is the only thing
+  // pushing key_events, the main loop is the only thing popping them
+  SpscQueue<KeyEvent, 32> key_events;
+  repeating_timer_t scan_timer;
 };
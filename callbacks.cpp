@@ -12,35 +12,33 @@
 
 #include "math/binary_operator.h"
 #include "math/bracket.h"
+#include "math/error.h"
 #include "math/function.h"
 #include "math/literals.h"
 #include "math/literals_piece.h"
 #include "math/math_util.h"
+#include "math/program.h"
 #include "math/unary_operator.h"
 #include "pico/bootrom.h"
 
 using picolator::math::BinaryOperator;
 using picolator::math::Bracket;
-using picolator::math::DomainError;
+using picolator::math::Equation;
+using picolator::math::Error;
+using picolator::math::ErrorCode;
 using picolator::math::ExprTree;
 using picolator::math::Letter;
 using picolator::math::Literals;
 using picolator::math::LiteralsPiece;
-using picolator::math::NotImplementedError;
-using picolator::math::SyntaxError;
-using picolator::math::TypeError;
+using picolator::math::modeName;
+using picolator::math::Program;
+using picolator::math::TokenId;
 using picolator::math::UnaryOperator;
-using LP = ExprTree::LetterPtr;
 
 int cursorIndexToLcdIndex(const CalculatorState& state) {
   int lcd_cursor = 0;
-  int count = 0;
-  for (auto& e : state.equation) {
-    if (count++ < state.cursor) {
-      lcd_cursor += e->getSymbol().length();
-    } else {
-      break;
-    }
+  for (int i = 0; i < state.cursor && i < state.equation.size(); i++) {
+    lcd_cursor += state.equation.symbol(i).length();
   }
   return lcd_cursor;
 }
@@ -48,37 +46,56 @@ int cursorIndexToLcdIndex(const CalculatorState& state) {
 void redrawEquation(CalculatorState& state) {
   state.lcd.clear(0);
   state.lcd.setCursor(0, 0);
-  for (const auto& l : state.equation) {
-    state.lcd.put(l->getSymbol());
+  for (size_t i = 0; i < state.equation.size(); i++) {
+    state.lcd.put(std::string(state.equation.symbol(i)));
   }
+  redrawPreview(state);
   state.lcd.setCursor(0, cursorIndexToLcdIndex(state));
   state.lcd.update();
 }
 
-void copyExprVec(const ExprTree::ExprVec& src, ExprTree::ExprVec& dst) {
-  dst.clear();
-  for (const auto& l : src) {
-    dst.emplace_back(l);
-  }
+// Starts solving what the equation is so far on core 1, pollCalculation puts
+// it on the second line. Only the letters after the last edit get
+// re-tokenized so this is cheap per key press
+void redrawPreview(CalculatorState& state) {
+  state.lcd.clear(1);
+  state.preview_pending = !state.worker.preview(state.equation, state.env);
 }
 
-void insertEquation(CalculatorState& state,
-                    const ExprTree::LetterPtr& mapping) {
-  if (state.cursor == state.equation.size()) {
-    state.equation.emplace_back(mapping);
-    state.lcd.put(mapping->getSymbol(), true);
-    state.cursor += 1;
-  } else {
-    if (state.insert_mode) {
-      state.equation.insert(state.equation.begin() + state.cursor, mapping);
-    } else {
-      state.equation[state.cursor] = mapping;
-    }
-    state.cursor += 1;
+// Overwrites the key under the cursor unless in insert mode, then moves past
+// the key insert put there
+template <typename F>
+static void insertAtCursor(CalculatorState& state, F insert) {
+  bool at_end = state.cursor == state.equation.size();
+  if (!at_end && !state.insert_mode) {
+    state.equation.erase(state.cursor);
+  }
+  insert(state.cursor);
+  if (at_end) {
+    state.lcd.put(std::string(state.equation.symbol(state.cursor)), true);
   }
+  state.cursor += 1;
   redrawEquation(state);
 }
 
+void insertEquation(CalculatorState& state, TokenId id) {
+  insertAtCursor(state, [&](size_t idx) { state.equation.insert(idx, id); });
+}
+
+void insertVariable(CalculatorState& state, char name) {
+  insertAtCursor(state,
+                 [&](size_t idx) { state.equation.insertVariable(idx, name); });
+}
+
+// Next key pressed since the last call, releases are skipped. Never blocks
+std::optional<std::pair<uint8_t, uint8_t>> nextPress(CalculatorState& state) {
+  KeyEvent event;
+  while (state.key_events.pop(event)) {
+    if (event.pressed) return {std::make_pair(event.row, event.column)};
+  }
+  return {};
+}
+
 void reflash_cb(CalculatorState& state) {
   state.lcd.clear();
   state.lcd.setCursor(0, 0);
@@ -86,6 +103,9 @@ void reflash_cb(CalculatorState& state) {
   state.lcd.setCursor(1, 0);
   state.lcd.put("unplug battery!");
   state.lcd.update();
+  // The main loop renders and it won't get another turn
+  while (state.lcd.render()) {
+  }
 
   reset_usb_boot(0, 0);
 }
@@ -102,8 +122,7 @@ void moveRight_cb(CalculatorState& state) {
   if (state.cursor < state.equation.size()) {
     state.cursor += 1;
   } else if (state.cleared) {  // replace equation
-    copyExprVec(state.history.back(), state.equation);
-    // state.equation = state.history.back();
+    state.equation = state.history.back();
     state.cursor = 1;
   }
   redrawEquation(state);
@@ -112,8 +131,8 @@ void moveRight_cb(CalculatorState& state) {
 void moveUp_cb(CalculatorState& state) {
   printf("moveUp pressed\n");
   if (state.history_cursor < state.history.size()) {
-    copyExprVec(state.history[state.history.size() - ++state.history_cursor],
-                state.equation);
+    state.equation = state.history[state.history.size() -
+                                   ++state.history_cursor];
     redrawEquation(state);
   }
 }
@@ -121,63 +140,71 @@ void moveUp_cb(CalculatorState& state) {
 void moveDown_cb(CalculatorState& state) {
   printf("moveDown pressed\n");
   if (state.history_cursor > 1) {
-    copyExprVec(state.history[state.history.size() - --state.history_cursor],
-                state.equation);
+    state.equation = state.history[state.history.size() -
+                                   --state.history_cursor];
     redrawEquation(state);
   }
 }
 
-// Calculates the result and prints it on
-// the screen. or display error in case of error
+// Sends the equation to core 1 to be solved, pollCalculation shows the result
 void calculate_cb(CalculatorState& state) {
-  state.lcd.clear(1);
-  Literals::getAnswer() = state.ans->getLiteral();
   if (state.equation.empty()) {
     if (state.history.empty()) return;
     state.equation = state.history.back();
     redrawEquation(state);
   }
-  ExprTree::LiteralPtr value = 0;
-  try {
-    auto tree = ExprTree(state.equation);
-    value = tree.getValue();
+  if (!state.worker.submit(state.equation, state.mode, state.env)) return;
 
-  } catch (const DomainError& e) {
-    state.lcd.setCursor(1, 0);
-    state.lcd.put(e.what());
-    state.lcd.setView(0, 0);
-    state.lcd.setCursor(0, 0);
-    state.lcd.update();
-    return;
-  } catch (const SyntaxError& e) {
-    state.lcd.setCursor(1, 0);
-    state.lcd.put(e.what());
-    state.lcd.setView(0, 0);
-    state.lcd.setCursor(0, cursorIndexToLcdIndex(state));
+  state.lcd.clear(1);
+  state.lcd.setCursor(1, 0);
+  state.lcd.put("Computing...");
+  state.lcd.setCursor(0, cursorIndexToLcdIndex(state));
+  state.lcd.update();
+}
 
-    state.lcd.update();
+// Shows a preview core 1 finished, or starts the next one if the equation
+// changed since
+static void showPreview(CalculatorState& state) {
+  if (state.preview_pending) {
+    redrawPreview(state);
     return;
-  } catch (const TypeError& e) {
-    state.lcd.setCursor(1, 0);
-    state.lcd.put(e.what());
-    state.lcd.setView(0, 0);
-    state.lcd.setCursor(0, 0);
-    state.lcd.update();
+  }
+  const auto& value = state.worker.result().value();
+  if (!value) return;
+  state.lcd.setCursor(1, 0);
+  state.lcd.put("=" + value->toString());
+  state.lcd.setCursor(0, cursorIndexToLcdIndex(state));
+  state.lcd.update();
+}
+
+// Prints the result once core 1 is done with it, or the error (including
+// cancelled) in case of error. Keys are queued while it is busy so the
+// equation is still the one that was sent
+void pollCalculation(CalculatorState& state) {
+  if (state.worker.poll() != EvalWorker::Status::DONE) return;
+  if (state.worker.kind() == EvalWorker::Kind::PREVIEW) {
+    showPreview(state);
     return;
-  } catch (const NotImplementedError& e) {
-    state.lcd.setCursor(1, 0);
-    state.lcd.put(e.what());
-    state.lcd.setView(0, 0);
-    state.lcd.setCursor(0, 0);
-    state.lcd.update();
-  } catch (std::exception& e) {
+  }
+
+  state.preview_pending = false;
+  state.lcd.clear(1);
+  const auto& result = state.worker.result();
+  if (!result) {
+    const Error& error = result.error();
+    char msg[picolator::math::ERROR_MSG_SIZE];
+    formatError(error, msg, sizeof(msg));
     state.lcd.setCursor(1, 0);
-    state.lcd.put("caught error");
+    state.lcd.put(msg);
     state.lcd.setView(0, 0);
-    state.lcd.setCursor(0, 0);
+    // Leave the cursor where it was for syntax errors so they can be fixed
+    state.lcd.setCursor(0, (error.code == ErrorCode::SYNTAX_ERROR)
+                               ? cursorIndexToLcdIndex(state)
+                               : 0);
     state.lcd.update();
     return;
   }
+  ExprTree::LiteralPtr value = result.value();
 
   state.clear = true;
   state.lcd.setCursor(1, 0);
@@ -192,7 +219,7 @@ void calculate_cb(CalculatorState& state) {
   state.history.push_back(state.equation);
   state.equation.clear();
 
-  state.ans = value;
+  state.env.ans() = *value;
 }
 
 // Clears the screen and the result
@@ -208,18 +235,17 @@ void backspace_cb(CalculatorState& state) {
     clear_cb(state);
     return;
   }
-  state.equation.erase(state.equation.begin() + --state.cursor);
+  state.equation.erase(--state.cursor);
   state.lcd.setCursor(0, 0);
   redrawEquation(state);
 }
 
 void convertDouble_cb(CalculatorState& state) {
-  if (!state.ans) state.ans = 0;
   state.lcd.clear();
   state.lcd.setCursor(0, 0);
   state.lcd.put("ANS \x7E DOUBLE");
   state.lcd.setCursor(1, 0);
-  state.lcd.put("\x7E" + std::to_string(state.ans->getValue()));
+  state.lcd.put("\x7E" + std::to_string(state.env.ans().getValue()));
   state.lcd.update();
 }
 
@@ -229,13 +255,14 @@ static char selectVar(CalculatorState& state) {
   state.lcd.setCursor(0, 0);
   state.lcd.put("A B C D E F");
   state.lcd.setCursor(1, 0);
-  state.lcd.put("\x7E" + Literals::getVariable('A').getSymbol());
+  state.lcd.put("\x7E" + state.env.variable('A').getSymbol());
   state.lcd.setCursor(0, 0);
   state.lcd.update();
 
   while (1) {
-    sleep_ms(10);
-    auto but = state.buttons.getPressed(true);
+    // Nothing else renders while this waits for a key
+    if (!state.lcd.render()) sleep_ms(1);
+    auto but = nextPress(state);
     if (!but) continue;
     if (but->second == 8 && but->first == 4) break;
     if (but->second == 1 && but->first == 2 && cursor < 6) {
@@ -243,7 +270,7 @@ static char selectVar(CalculatorState& state) {
       state.lcd.setCursor(1, 0);
       state.lcd.clear(1);
 
-      state.lcd.put("\x7E" + Literals::getVariable('A' + cursor).getSymbol());
+      state.lcd.put("\x7E" + state.env.variable('A' + cursor).getSymbol());
       state.lcd.setCursor(0, cursor * 2);
 
       state.lcd.update();
@@ -252,7 +279,7 @@ static char selectVar(CalculatorState& state) {
       cursor--;
       state.lcd.setCursor(1, 0);
       state.lcd.clear(1);
-      state.lcd.put("\x7E" + Literals::getVariable('A' + cursor).getSymbol());
+      state.lcd.put("\x7E" + state.env.variable('A' + cursor).getSymbol());
       state.lcd.setCursor(0, cursor * 2);
 
       state.lcd.update();
@@ -262,24 +289,35 @@ static char selectVar(CalculatorState& state) {
 }
 
 void saveVar_cb(CalculatorState& state) {
-  if (!state.ans) state.ans = 0;
   char var = selectVar(state);
-  Literals::getVariable(var) = state.ans->getLiteral();
+  state.env.variable(var) = state.env.ans();
   state.lcd.clear();
   state.lcd.setCursor(0, 0);
   state.lcd.put("ANS \x7E " + std::string(1, var));
   state.lcd.setCursor(1, 0);
-  state.lcd.put("\x7E" + Literals::getVariable(var).toString());
+  state.lcd.put("\x7E" + state.env.variable(var).toString());
   state.lcd.setCursor(0, 0);
   state.lcd.update();
 }
 void getVar_cb(CalculatorState& state) {
-  if (!state.ans) state.ans = 0;
   char var = selectVar(state);
-  insertEquation(state, LP(new Literals(var)));
+  insertVariable(state, var);
   redrawEquation(state);
 }
 
 void noOp(CalculatorState&){};
 
-void layer2_cb(CalculatorState& state) { state.layer2 = true; }
\ No newline at end of file
+void layer2_cb(CalculatorState& state) { state.layer = 1; }
+
+// Cycles through the Program modes
+void mode_cb(CalculatorState& state) {
+  uint8_t next = static_cast<uint8_t>(state.mode) + 1;
+  if (next == static_cast<uint8_t>(Program::Mode::COUNT)) next = 0;
+  state.mode = static_cast<Program::Mode>(next);
+
+  state.lcd.clear();
+  state.lcd.setCursor(0, 0);
+  state.lcd.put("MODE \x7E " + std::string(modeName(state.mode)));
+  state.lcd.update();
+  state.clear = true;
+}
\ No newline at end of file
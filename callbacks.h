@@ -10,16 +10,20 @@
  */
 #pragma once
 
+#include <optional>
+#include <utility>
+
 #include "calculator_state.h"
-#include "math/expr_tree.h"
+#include "math/token.h"
 
 // Util for callback functions
 int cursorIndexToLcdIndex(const CalculatorState& state);
 void redrawEquation(CalculatorState& state);
-void copyExprVec(const picolator::math::ExprTree::ExprVec& src,
-                 picolator::math::ExprTree::ExprVec& dst);
-void insertEquation(CalculatorState& state,
-                    const picolator::math::ExprTree::LetterPtr& val);
+void redrawPreview(CalculatorState& state);
+void insertEquation(CalculatorState& state, picolator::math::TokenId id);
+void insertVariable(CalculatorState& state, char name);
+void pollCalculation(CalculatorState& state);
+std::optional<std::pair<uint8_t, uint8_t>> nextPress(CalculatorState& state);
 
 // Callbacks
 void noOp(CalculatorState&);
@@ -33,6 +37,7 @@ void clear_cb(CalculatorState& state);
 void backspace_cb(CalculatorState& state);
 void convertDouble_cb(CalculatorState& state);
 void layer2_cb(CalculatorState& state);
+void mode_cb(CalculatorState& state);
 
 void saveVar_cb(CalculatorState& state);
 void getVar_cb(CalculatorState& state);
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "eval_worker.h"
+
+using picolator::math::Equation;
+using picolator::math::EvalEnvironment;
+using picolator::math::ExprTree;
+using picolator::math::Program;
+
+uint32_t EvalWorker::run(void* context, uint32_t generation) {
+  auto& worker = *static_cast<EvalWorker*>(context);
+  Job& job = worker.job_;
+  if (job.kind == Kind::PREVIEW) {
+    job.result = worker.preview_.update(job.equation, job.env);
+  } else {
+    job.result = ExprTree::evaluate(job.equation, job.mode, job.env);
+  }
+  return generation;
+}
+
+void EvalWorker::start() { core1_.start(run, this); }
+
+bool EvalWorker::submit(Kind kind, const Equation& equation,
+                        Program::Mode mode, const EvalEnvironment& env) {
+  // A preview never holds up a calculation, it stops at its next check so
+  // this doesn't wait long
+  if (busy() && kind == Kind::CALCULATE && job_.kind == Kind::PREVIEW) {
+    cancel();
+    while (poll() == Status::COMPUTING) {
+    }
+  }
+  if (busy()) return false;
+  job_.kind = kind;
+  job_.equation = equation;
+  job_.mode = mode;
+  job_.env = env;
+  job_.env.setCancelFlag(&cancel_);
+  cancel_.store(false, std::memory_order_relaxed);
+
+  status_ = Status::COMPUTING;
+  core1_.push(++generation_);
+  return true;
+}
+
+void EvalWorker::cancel() {
+  if (busy()) cancel_.store(true, std::memory_order_relaxed);
+}
+
+EvalWorker::Status EvalWorker::poll() {
+  if (!busy()) return Status::IDLE;
+  uint32_t generation;
+  if (!core1_.poll(generation) || generation != generation_) {
+    return Status::COMPUTING;
+  }
+  status_ = Status::IDLE;
+  return Status::DONE;
+}
@@ -0,0 +1,112 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+
+#include <larrys_pico/core1_worker.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "math/equation.h"
+#include "math/error.h"
+#include "math/eval_environment.h"
+#include "math/expr_tree.h"
+#include "math/incremental_parser.h"
+#include "math/program.h"
+
+/**
+ * @brief Solves equations on core 1 so core 0 can keep scanning keys and
+ * drawing while a slow one runs. Only one job at a time, it works on its own
+ * copy of the equation and environment so core 0 can't change them under it.
+ */
+class EvalWorker {
+ public:
+  enum class Status : uint8_t { IDLE, COMPUTING, DONE };
+  // CALCULATE solves with the mode, PREVIEW solves the equation being typed
+  // with the IncrementalParser
+  enum class Kind : uint8_t { CALCULATE, PREVIEW };
+
+ private:
+  // Only touched by core 1 between submit pushing the job and it being sent
+  // back
+  struct Job {
+    Kind kind = Kind::CALCULATE;
+    picolator::math::Equation equation;
+    picolator::math::Program::Mode mode;
+    picolator::math::EvalEnvironment env;
+    picolator::math::Result<picolator::math::ExprTree::LiteralPtr> result =
+        picolator::math::ExprTree::LiteralPtr();
+  };
+
+  Core1Worker core1_;
+  Job job_;
+  // Only used on core 1, keeps its tokenizer states between previews
+  picolator::math::IncrementalParser preview_;
+  // Sent as the job word, what comes back has to match the last submit
+  uint32_t generation_ = 0;
+  std::atomic<bool> cancel_ = false;
+  Status status_ = Status::IDLE;
+
+  static uint32_t run(void* context, uint32_t generation);
+
+  bool submit(Kind kind, const picolator::math::Equation& equation,
+              picolator::math::Program::Mode mode,
+              const picolator::math::EvalEnvironment& env);
+
+ public:
+  // Launches core 1, has to be called before submit
+  void start();
+
+  /**
+   * @brief Starts solving equation on core 1. A running preview is cancelled
+   * first and its result dropped
+   *
+   * @return false if the last calculation isn't done yet
+   */
+  bool submit(const picolator::math::Equation& equation,
+              picolator::math::Program::Mode mode,
+              const picolator::math::EvalEnvironment& env) {
+    return submit(Kind::CALCULATE, equation, mode, env);
+  }
+
+  /**
+   * @brief Starts solving the preview of equation on core 1. Only the
+   * letters after the last preview's edit are re-tokenized
+   *
+   * @return false if the last job isn't done yet
+   */
+  bool preview(const picolator::math::Equation& equation,
+               const picolator::math::EvalEnvironment& env) {
+    return submit(Kind::PREVIEW, equation,
+                  picolator::math::Program::Mode::EXACT, env);
+  }
+
+  // Stops the job at its next instruction, it is still DONE but with a
+  // CANCELLED error
+  void cancel();
+
+  // Checks on the job without blocking, DONE is only returned once per job
+  Status poll();
+
+  bool busy() const { return status_ == Status::COMPUTING; }
+
+  // What the last job was
+  Kind kind() const { return job_.kind; }
+
+  // Only valid after poll returned DONE and until the next submit. A PREVIEW
+  // never has an error, its value is nullptr if it can't be solved
+  const picolator::math::Result<picolator::math::ExprTree::LiteralPtr>&
+  result() const {
+    return job_.result;
+  }
+  // The equation the last job solved
+  const picolator::math::Equation& equation() const { return job_.equation; }
+};
@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+
+#include "math/token.h"
+
+#define MATRIX_ROW_SIZE 5
+#define MATRIX_COL_SIZE 9
+
+namespace keymap {
+
+using picolator::math::TokenId;
+
+// What a key does when it isn't typing a token. The firmware maps each one to
+// a callback
+enum class Action : uint8_t {
+  NONE,  // falls back to the base layer
+  TOKEN,
+  NOOP,
+  REFLASH,
+  MOVE_LEFT,
+  MOVE_RIGHT,
+  MOVE_UP,
+  MOVE_DOWN,
+  CALCULATE,
+  CLEAR,
+  BACKSPACE,
+  CONVERT_DOUBLE,
+  SAVE_VAR,
+  GET_VAR,
+  LAYER2,
+  MODE,
+  COUNT
+};
+
+struct Key {
+  Action action = Action::NONE;
+  TokenId token = TokenId::NONE;
+};
+
+constexpr Key tok(TokenId id) { return {Action::TOKEN, id}; }
+constexpr Key act(Action action) { return {action, TokenId::NONE}; }
+// Transparent, uses the key from layer 0
+constexpr Key TRNS = {};
+
+constexpr uint8_t LAYERS = 2;
+
+// [layer][col][row]
+constexpr Key KEYMAP[LAYERS][MATRIX_COL_SIZE][MATRIX_ROW_SIZE] = {
+    {{act(Action::NOOP), act(Action::MOVE_UP), act(Action::NOOP),
+      act(Action::LAYER2), act(Action::REFLASH)},
+     {act(Action::NOOP), act(Action::MOVE_LEFT), act(Action::MOVE_RIGHT),
+      act(Action::NOOP), act(Action::NOOP)},
+     {act(Action::CONVERT_DOUBLE), act(Action::MOVE_DOWN), act(Action::NOOP),
+      act(Action::NOOP), act(Action::NOOP)},
+     {tok(TokenId::PI), tok(TokenId::E), tok(TokenId::SIN), tok(TokenId::COS),
+      tok(TokenId::TAN)},
+     {tok(TokenId::EXP), tok(TokenId::MOD), tok(TokenId::OPEN),
+      tok(TokenId::CLOSED), tok(TokenId::DIV)},
+     {tok(TokenId::SQRT), tok(TokenId::DIGIT_7), tok(TokenId::DIGIT_8),
+      tok(TokenId::DIGIT_9), tok(TokenId::MUL)},
+     {act(Action::GET_VAR), tok(TokenId::DIGIT_4), tok(TokenId::DIGIT_5),
+      tok(TokenId::DIGIT_6), tok(TokenId::SUB)},
+     {act(Action::BACKSPACE), tok(TokenId::DIGIT_1), tok(TokenId::DIGIT_2),
+      tok(TokenId::DIGIT_3), tok(TokenId::ADD)},
+     {act(Action::CLEAR), tok(TokenId::DIGIT_0), tok(TokenId::DECIMAL),
+      tok(TokenId::MINUS), act(Action::CALCULATE)}},
+    {{TRNS, TRNS, TRNS, TRNS, TRNS},
+     {TRNS, TRNS, TRNS, TRNS, TRNS},
+     {act(Action::MODE), TRNS, TRNS, TRNS, TRNS},
+     {TRNS, tok(TokenId::LN), tok(TokenId::ASIN), tok(TokenId::ACOS),
+      tok(TokenId::ATAN)},
+     {tok(TokenId::I), TRNS, TRNS, TRNS, TRNS},
+     {tok(TokenId::N_TH_ROOT), TRNS, TRNS, TRNS, TRNS},
+     {act(Action::SAVE_VAR), TRNS, TRNS, TRNS, TRNS},
+     {TRNS, TRNS, TRNS, TRNS, TRNS},
+     {TRNS, TRNS, TRNS, tok(TokenId::ANS), TRNS}}};
+
+static_assert(sizeof(Key) == 2);
+
+// Looks up a key, falling back to layer 0 for keys a layer doesn't set
+constexpr Key keyAt(uint8_t layer, uint8_t col, uint8_t row) {
+  const Key& key = KEYMAP[layer][col][row];
+  if (key.action == Action::NONE) return KEYMAP[0][col][row];
+  return key;
+}
+
+// Keys that auto-repeat while held, moving the cursor and deleting
+constexpr bool repeats(const Key& key) {
+  switch (key.action) {
+    case Action::MOVE_LEFT:
+    case Action::MOVE_RIGHT:
+    case Action::MOVE_UP:
+    case Action::MOVE_DOWN:
+    case Action::BACKSPACE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace keymap
@@ -25,12 +25,9 @@
 #include "callbacks.h"
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
-#include "math/binary_operator.h"
-#include "math/bracket.h"
-#include "math/function.h"
-#include "math/literals.h"
-#include "math/literals_piece.h"
+#include "keymap.h"
 #include "math/math_util.h"
+#include "math/token.h"
 #include "math/unary_operator.h"
 #include "pico/binary_info.h"
 #include "pico/bootrom.h"
@@ -38,90 +35,118 @@
 #include "pico/stdio.h"
 #include "pico/stdlib.h"
 
-using picolator::math::BinaryOperator;
-using picolator::math::Bracket;
+using keymap::Action;
 using picolator::math::ExprTree;
-using picolator::math::Function;
 using picolator::math::Letter;
-using picolator::math::Literals;
-using picolator::math::LiteralsPiece;
+using picolator::math::TokenId;
+using picolator::math::tokenInfo;
 using picolator::math::UnaryOperator;
 
-using LP = ExprTree::LetterPtr;
-
-LP reflash(new Function(reflash_cb));
-
-// No Operation just a placeholder for blank keys
-LP noop(new Function(noOp));
-
-LP moveLeft(new Function(moveLeft_cb));
-LP moveRight(new Function(moveRight_cb));
-LP moveUp(new Function(moveUp_cb));
-LP moveDown(new Function(moveDown_cb));
-LP calc(new Function(calculate_cb));
-LP clear(new Function(clear_cb));
-LP backspace(new Function(backspace_cb));
-LP convertDouble(new Function(convertDouble_cb));
-LP saveVar(new Function(saveVar_cb));
-LP getVar(new Function(getVar_cb));
-
-LP layer2(new Function(layer2_cb));
-
-// Operators
-// Binary ops
-LP op_div(new BinaryOperator("/", BinaryOperator::Type::DIVISION));
-LP op_add(new BinaryOperator("+", BinaryOperator::Type::ADDITION));
-LP op_sub(new BinaryOperator("-", BinaryOperator::Type::SUBTRACTION));
-LP op_mul(new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION));
-LP op_mod(new BinaryOperator("%", BinaryOperator::Type::MODULUS));
-LP op_exp(new BinaryOperator("^", BinaryOperator::Type::EXPONENT));
-LP op_n_sqrt(new BinaryOperator("^\xE8", BinaryOperator::Type::N_TH_ROOT));
-
-// Unary ops
-LP op_minus(new UnaryOperator("-", UnaryOperator::Type::MINUS));
-LP op_sin(new UnaryOperator("sin", UnaryOperator::Type::SIN));
-LP op_cos(new UnaryOperator("cos", UnaryOperator::Type::COS));
-LP op_tan(new UnaryOperator("tan", UnaryOperator::Type::TAN));
-LP op_asin(new UnaryOperator("asin", UnaryOperator::Type::ARCSIN));
-LP op_acos(new UnaryOperator("acos", UnaryOperator::Type::ARCCOS));
-LP op_atan(new UnaryOperator("atan", UnaryOperator::Type::ARCTAN));
-LP op_ln(new UnaryOperator("ln", UnaryOperator::Type::LN));
-LP op_sqrt(new UnaryOperator("\xE8", UnaryOperator::Type::SQUARE_ROOT));
-
-// Numbers
-#define LITP(a) (LP(new LiteralsPiece(a)))
-
-// Literals
-LP l_pi(new Literals(Literals::Type::PI));
-LP l_e(new Literals(Literals::Type::E));
-LP ANS(new Literals(Literals::Type::ANS));
-
-// Brackets
-LP b_open(new Bracket(Bracket::Type::OPEN));
-LP b_clos(new Bracket(Bracket::Type::CLOSED));
-
-LP button_mapping[MATRIX_COL_SIZE][MATRIX_ROW_SIZE]{
-    {noop, moveUp, noop, layer2, reflash},
-    {noop, moveLeft, moveRight, noop, noop},
-    {convertDouble, moveDown, noop, noop, noop},
-    {l_pi, l_e, op_sin, op_cos, op_tan},
-    {op_exp, op_mod, b_open, b_clos, op_div},
-    {op_sqrt, LITP('7'), LITP('8'), LITP('9'), op_mul},
-    {getVar, LITP('4'), LITP('5'), LITP('6'), op_sub},
-    {backspace, LITP('1'), LITP('2'), LITP('3'), op_add},
-    {clear, LITP('0'), LITP('.'), op_minus, calc}};
-
-// null means fallback to button_mapping
-LP button_mapping2[MATRIX_COL_SIZE][MATRIX_ROW_SIZE]{
-    {nullptr, nullptr, nullptr, nullptr, nullptr},
-    {nullptr, nullptr, nullptr, nullptr, nullptr},
-    {nullptr, nullptr, nullptr, nullptr, nullptr},
-    {nullptr, op_ln, op_asin, op_acos, op_atan},
-    {nullptr, nullptr, nullptr, nullptr, nullptr},
-    {op_n_sqrt, nullptr, nullptr, nullptr, nullptr},
-    {saveVar, nullptr, nullptr, nullptr, nullptr},
-    {nullptr, nullptr, nullptr, nullptr, nullptr},
-    {nullptr, nullptr, nullptr, ANS, nullptr}};
+using Callback = void (*)(CalculatorState&);
+
+// Indexed by keymap::Action, NONE and TOKEN never get called
+constexpr Callback ACTIONS[] = {
+    noOp,              // NONE
+    noOp,              // TOKEN
+    noOp,              // NOOP
+    reflash_cb,        // REFLASH
+    moveLeft_cb,       // MOVE_LEFT
+    moveRight_cb,      // MOVE_RIGHT
+    moveUp_cb,         // MOVE_UP
+    moveDown_cb,       // MOVE_DOWN
+    calculate_cb,      // CALCULATE
+    clear_cb,          // CLEAR
+    backspace_cb,      // BACKSPACE
+    convertDouble_cb,  // CONVERT_DOUBLE
+    saveVar_cb,        // SAVE_VAR
+    getVar_cb,         // GET_VAR
+    layer2_cb,         // LAYER2
+    mode_cb,           // MODE
+};
+static_assert(sizeof(ACTIONS) / sizeof(Callback) ==
+              static_cast<size_t>(Action::COUNT));
+
+// Scans a row of the button matrix per call, a full pass over the 5 rows
+// takes 5ms which is also how long KeyDebouncer waits by default
+constexpr int32_t SCAN_PERIOD_MS = 1;
+
+// Runs in the timer interrupt on core 0, core 1 is busy solving
+static bool scanKeys(repeating_timer_t* timer) {
+  auto& state = *static_cast<CalculatorState*>(timer->user_data);
+  state.buttons.scan(to_ms_since_boot(get_absolute_time()), state.key_events);
+  return true;
+}
+
+static void handlePress(CalculatorState& state,
+                        std::pair<uint8_t, uint8_t> press) {
+  // Clear on next button press if the flag is set
+  if (state.clear) {
+    state.lcd.clear();
+    state.clear = false;
+    state.cleared = true;
+  }
+
+  keymap::Key key = keymap::keyAt(state.layer, press.second, press.first);
+  state.layer = 0;
+
+  if (key.action != Action::TOKEN) {
+    ACTIONS[static_cast<size_t>(key.action)](state);
+    state.cleared = false;
+    return;
+  }
+
+  const auto& info = tokenInfo(key.token);
+  switch (info.classification) {
+    case Letter::Classification::UNARY: {
+      if (info.type != static_cast<uint8_t>(UnaryOperator::Type::MINUS)) {
+        state.equation.push_back(key.token);
+        state.equation.push_back(TokenId::OPEN);
+
+        state.lcd.put(std::string(info.symbol), true);
+        state.lcd.put(std::string(tokenInfo(TokenId::OPEN).symbol), true);
+        state.cursor += 2;
+
+        redrawPreview(state);
+        state.lcd.setCursor(0, cursorIndexToLcdIndex(state));
+        state.lcd.update();
+        break;
+      }
+    }  // fall through
+    default:
+      insertEquation(state, key.token);
+      break;
+  }
+  // Set the clear flag to false
+  state.cleared = false;
+}
+
+// Only a calculation holds keys back, a preview is out of date as soon as
+// another key comes in
+static bool calculating(const CalculatorState& state) {
+  return state.worker.busy() &&
+         state.worker.kind() == EvalWorker::Kind::CALCULATE;
+}
+
+// Stops a preview that is still running so the key doesn't wait for it, the
+// next one is started once it is back
+static void pressKey(CalculatorState& state,
+                     const std::pair<uint8_t, uint8_t>& key) {
+  if (state.worker.busy()) {
+    state.worker.cancel();
+    state.preview_pending = true;
+  }
+  handlePress(state, key);
+}
+
+// queued_presses is full, the key can't be kept but it shouldn't go missing
+// without the user knowing. The result replaces it once it is in
+static void showKeyLost(CalculatorState& state) {
+  state.lcd.clear(1);
+  state.lcd.setCursor(1, 0);
+  state.lcd.put("Busy, key lost");
+  state.lcd.setCursor(0, cursorIndexToLcdIndex(state));
+  state.lcd.update();
+}
 
 // smile
 uint8_t smile[] = {0x00, 0x00, 0x0A, 0x00, 0x11, 0x0E, 0x00, 0x00};
@@ -137,6 +162,8 @@ int main() {
   state.lcd.put("Picolator");
   state.lcd.put(1);
   state.lcd.update();
+  while (state.lcd.render()) {
+  }
 
   sleep_ms(500);
 
@@ -146,59 +173,47 @@ int main() {
 
   state.cursor = 0;
   state.equation.clear();
+  state.worker.start();
+  for (uint8_t row = 0; row < MATRIX_ROW_SIZE; row++) {
+    for (uint8_t col = 0; col < MATRIX_COL_SIZE; col++) {
+      state.buttons.debouncer().setRepeat(
+          row, col, keymap::repeats(keymap::keyAt(0, col, row)));
+    }
+  }
+  // Negative so the period is from start to start
+  add_repeating_timer_ms(-SCAN_PERIOD_MS, scanKeys, &state, &state.scan_timer);
   while (1) {
-    sleep_ms(10);
-    auto but = state.buttons.getPressed(true);
-
-    if (but) {
-      // state.lcd.clear();
-      // state.lcd.put(std::to_string(but->first) + " " +
-      // std::to_string(but->second)); state.lcd.update();
-
-      // Clear on next button press if the flag is set
-      if (state.clear) {
-        state.lcd.clear();
-        state.clear = false;
-        state.cleared = true;
-      }
+    pollCalculation(state);
+    // Catch up on what was pressed while core 1 was solving, a key can start
+    // another calculation so stop if it does
+    std::pair<uint8_t, uint8_t> queued;
+    while (!calculating(state) && state.queued_presses.pop(queued)) {
+      pressKey(state, queued);
+    }
 
-      // dont use ref or
-      auto mapping = button_mapping[but->second][but->first];
+    // The LCD is drawn a run at a time between key presses. It is blocking
+    // I2C so it stays out of the scan interrupt, a run is at most ~300us
+    bool rendered = state.lcd.render();
 
-      // if second layer is active change layer
-      if (state.layer2 == true) {
-        const auto& mapping2 = button_mapping2[but->second][but->first];
-        if (mapping2) {
-          mapping = button_mapping2[but->second][but->first];
-        }
-        state.layer2 = false;
-      }
+    auto but = nextPress(state);
+    if (!but) {
+      if (!rendered) sleep_ms(1);
+      continue;
+    }
 
-      switch (mapping->getClassification()) {
-        case Letter::Classification::FUNCTION:
-          reinterpret_cast<Function&>(*mapping).invoke(state);
-          break;
-        case Letter::Classification::UNARY: {
-          auto op = reinterpret_cast<UnaryOperator&>(*mapping);
-          if (op.getOp() != UnaryOperator::Type::MINUS) {
-            state.equation.emplace_back(mapping);
-            state.equation.emplace_back(b_open);
-
-            state.lcd.put(mapping->getSymbol(), true);
-            state.lcd.put(b_open->getSymbol(), true);
-
-            state.lcd.update();
-            state.cursor += 2;
-            break;
-          }
-        }  // fall through
-        default:
-          insertEquation(state, mapping);
-          break;
+    if (calculating(state)) {
+      // CLEAR stops the calculation, everything else waits for it
+      if (keymap::keyAt(state.layer, but->second, but->first).action ==
+          Action::CLEAR) {
+        state.worker.cancel();
+        while (state.queued_presses.pop(queued)) {
+        }
+        continue;
       }
-      // Set the clear flag to false
-      state.cleared = false;
+      if (!state.queued_presses.push(*but)) showKeyLost(state);
+      continue;
     }
+    pressKey(state, *but);
   }
   return 0;
 }
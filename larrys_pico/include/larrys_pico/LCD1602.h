@@ -10,27 +10,48 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include <utility>
 #include <vector>
 
-void lcd_clear(void);
-void lcd_set_cursor(int line, int position);
-void lcd_string(const char* s);
-void lcd_init();
-void lcd_char(char val);
+#include "lcd_transport.h"
+#include "triple_buffer.h"
 
 const int MAX_LINES = 2;
 const int MAX_CHARS = 16;
 
+// What the panel should show, update() publishes one for render() to draw
+struct LcdFrame {
+  char chars[MAX_LINES][MAX_CHARS];
+  uint8_t cursor_y;
+  uint8_t cursor_x;
+  // Counts up every update
+  uint32_t sequence;
+};
+
 // TODO update so it can handle custom chars
+//
+// Drawing is split in two. put, update and the rest are the UI side, update
+// only copies the view into a frame and returns. render is the renderer side,
+// called between key presses from the main loop (or from another thread) to
+// send the frame to the panel a change at a time. Only the renderer touches
+// the bus after init. The bus writes block so keep render out of interrupts,
+// one run is a few hundred us at 400kHz.
 class LCD1602 {
  private:
+  LcdTransport transport_;
+  TripleBuffer<LcdFrame> frames_;
+
+  // Renderer side, what is on the panel and where its cursor is
+  LcdFrame shown_ = {};
+  std::atomic<uint32_t> rendered_ = 0;
+
   // Holds the info of the entire screen
   std::vector<std::string> screen_buffer_ = {};
-
-  // What will actually be displayed on the screen
-  int screen_[MAX_LINES][MAX_CHARS] = {' '};
+  uint32_t sequence_ = 0;
 
   int screen_y_ = 0;
   int screen_x_ = 0;
@@ -40,7 +61,11 @@ class LCD1602 {
   int cursor_y_ = 0;
 
  public:
+#ifndef PICOLATOR_TEST
+  // On the default I2C pins
   LCD1602();
+#endif
+  explicit LCD1602(LcdBus& bus);
 
   // Place char or string wherever the cursor is
   void put(char val, bool scroll = false);
@@ -71,9 +96,29 @@ class LCD1602 {
   void clear();
   void clear(int y);
 
-  /* updates the screen_ and displays changes to the lcd module*/
+  /* publishes the view for render to display, doesn't wait for it */
   void update();
 
+  /**
+   * @brief Renderer side, sends the next difference between the latest
+   * update and the panel, a run of characters or the cursor.
+   *
+   * A run is the changed cells on one line, including unchanged ones between
+   * them when rewriting those is cheaper on the bus than another write. The
+   * panel moves its own cursor along as it is written to so a run needs one
+   * address command, and none after it if the cursor ends up in the right
+   * place (ie typing at the end of the line).
+   *
+   * @return false if the panel already shows the latest update
+   */
+  bool render();
+
+  // UI side, waits until another thread's render has shown the last update
+  void waitForRender() const {
+    while (rendered_.load() != sequence_) {
+    }
+  }
+
   void setCursor(int y, int x) { moveCursor(y - cursor_y_, x - cursor_x_); }
 
   bool moveCursor(int dy, int dx, bool scroll = true) {
@@ -94,7 +139,9 @@ class LCD1602 {
     }
 
     if (scroll) {
+#ifdef LCD_DEBUG
       printf("cursor x %d screen x %d\n", cursor_x_, screen_x_);
+#endif
       if (cursor_x_ < screen_x_) {
         screen_x_ = cursor_x_;
       } else if (cursor_x_ >= screen_x_ + MAX_CHARS) {
@@ -110,5 +157,6 @@ class LCD1602 {
     return true;
   }
 
+  // Talks to the panel directly, call before anything calls render
   void createChar(uint8_t location, uint8_t charmap[]);
 };
@@ -10,10 +10,10 @@
  */
 #pragma once
 #include <array>
-#include <optional>
-#include <utility>
 
 #include "button.h"
+#include "key_debouncer.h"
+#include "key_event.h"
 #include "pico/stdlib.h"
 
 template <size_t rows, size_t columns>
@@ -22,6 +22,11 @@ class ButtonMatrix {
   std::array<GpioInputButton, columns> buttons_;
   std::array<GpioOutput, rows> rows_;
 
+  // Row scan is driving and if it has been driven yet
+  uint8_t scan_row_ = 0;
+  bool scanning_ = false;
+  KeyDebouncer<rows, columns> debouncer_;
+
  public:
   ButtonMatrix(const std::array<uint8_t, rows>& row_pins,
                const std::array<uint8_t, columns>& column_pins) {
@@ -34,36 +39,30 @@ class ButtonMatrix {
     }
   }
 
+  // Debounces what scan reads, ie to turn on auto-repeat for some keys
+  KeyDebouncer<rows, columns>& debouncer() { return debouncer_; }
+
   /**
-   * @brief returns a pair if a button is pressed by index in array.
-   * @note Returns the index in the array not by pin so the first button in the
-   * first row would be <0,0> instead of the pin values
-   * @note Only one button can be pressed at once I am not fancy.
+   * @brief Scans one row per call, meant to be called from a repeating timer.
+   * Reads the row the last call drove and hands it to the debouncer, then
+   * drives the next row so it settles until the next call instead of in a
+   * sleep_ms.
    *
-   * @param wait_for_unpress will only return after the button is finished being
-   * pressed
-   * @return std::optional<std::pair<uint8_t, uint8_t>> index of pin being
-   * pressed
+   * @param time_ms timestamp for the events
+   * @param events anything with bool push(const KeyEvent&) (ie a SpscQueue)
    */
-  std::optional<std::pair<uint8_t, uint8_t>> getPressed(
-      bool wait_for_unpress = false) {
-    for (uint8_t i = 0; i < rows; i++) {
-      rows_[i].toggle();
-      sleep_ms(10);
+  template <typename Queue>
+  void scan(uint32_t time_ms, Queue& events) {
+    if (scanning_) {
+      uint32_t pressed = 0;
       for (uint8_t j = 0; j < columns; j++) {
-        if (buttons_[j].pressed()) {
-          // wait for button to be unpressed
-          if (wait_for_unpress) {
-            while (buttons_[j].pressed()) {
-              sleep_ms(10);
-            }
-          }
-          rows_[i].toggle();
-          return {std::make_pair(i, j)};
-        }
+        pressed |= static_cast<uint32_t>(buttons_[j].pressed()) << j;
       }
-      rows_[i].toggle();
+      debouncer_.update(time_ms, scan_row_, pressed, events);
+      rows_[scan_row_].toggle();
+      scan_row_ = (scan_row_ + 1) % rows;
     }
-    return {};
+    rows_[scan_row_].toggle();
+    scanning_ = true;
   }
-};
\ No newline at end of file
+};
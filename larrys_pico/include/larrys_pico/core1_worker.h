@@ -0,0 +1,134 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+
+#ifdef PICOLATOR_TEST
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#else
+#include "pico/multicore.h"
+#endif
+
+/**
+ * @brief Runs jobs on core 1. A job is a 32 bit word pushed through the
+ * inter-core FIFO and core 1 pushes one word back when it is done with it, so
+ * anything bigger has to be left somewhere both cores can see before pushing.
+ *
+ * @note Under PICOLATOR_TEST core 1 is a std::thread and the FIFOs are queues
+ * so the code using this can be tested on the host.
+ */
+class Core1Worker {
+ public:
+  // Called on core 1 for every job, returns the word sent back
+  using Handler = uint32_t (*)(void* context, uint32_t job);
+
+#ifdef PICOLATOR_TEST
+ private:
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable jobs_ready_;
+  std::deque<uint32_t> jobs_;
+  std::deque<uint32_t> results_;
+  bool stopping_ = false;
+
+ public:
+  Core1Worker() = default;
+  Core1Worker(const Core1Worker&) = delete;
+  Core1Worker& operator=(const Core1Worker&) = delete;
+
+  ~Core1Worker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    jobs_ready_.notify_one();
+    if (thread_.joinable()) thread_.join();
+  }
+
+  void start(Handler handler, void* context) {
+    thread_ = std::thread([this, handler, context] {
+      while (true) {
+        uint32_t job;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          jobs_ready_.wait(lock,
+                           [this] { return stopping_ || !jobs_.empty(); });
+          if (stopping_) return;
+          job = jobs_.front();
+          jobs_.pop_front();
+        }
+        uint32_t result = handler(context, job);
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.push_back(result);
+      }
+    });
+  }
+
+  void push(uint32_t job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(job);
+    }
+    jobs_ready_.notify_one();
+  }
+
+  bool poll(uint32_t& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (results_.empty()) return false;
+    result = results_.front();
+    results_.pop_front();
+    return true;
+  }
+#else
+ private:
+  // multicore_launch_core1 only takes a plain function, there is only one
+  // core 1 so these can be static
+  static inline Handler handler_ = nullptr;
+  static inline void* context_ = nullptr;
+
+  static void core1Main() {
+    while (true) {
+      uint32_t job = multicore_fifo_pop_blocking();
+      multicore_fifo_push_blocking(handler_(context_, job));
+    }
+  }
+
+ public:
+  /**
+   * @brief Launches core 1, only call once
+   *
+   * @param handler runs every job on core 1
+   * @param context passed to handler, has to outlive core 1
+   */
+  void start(Handler handler, void* context) {
+    handler_ = handler;
+    context_ = context;
+    multicore_launch_core1(core1Main);
+  }
+
+  // Blocks only if the FIFO (8 words deep) is full
+  void push(uint32_t job) { multicore_fifo_push_blocking(job); }
+
+  /**
+   * @brief Never blocks
+   *
+   * @return true and sets result if core 1 sent a word back
+   */
+  bool poll(uint32_t& result) {
+    if (!multicore_fifo_rvalid()) return false;
+    result = multicore_fifo_pop_blocking();
+    return true;
+  }
+#endif
+};
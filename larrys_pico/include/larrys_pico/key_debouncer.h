@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "key_event.h"
+
+/**
+ * @brief Turns raw samples of a key matrix into debounced press, release and
+ * auto-repeat events. Every key has its own state machine so any number can
+ * be held at once.
+ *
+ * Nothing in here touches a pin, whatever scans the matrix hands it a row at a
+ * time (ButtonMatrix::scan on the pico, made up traces in the tests).
+ */
+template <size_t rows, size_t columns>
+class KeyDebouncer {
+  static_assert(columns <= 32, "a row is sampled as a 32 bit mask");
+
+ public:
+  struct Config {
+    // How long a key has to read the same before a press or release counts
+    uint32_t debounce_ms = 5;
+    // Held repeating keys send their first repeat after delay, then every
+    // interval
+    uint32_t repeat_delay_ms = 500;
+    uint32_t repeat_interval_ms = 100;
+  };
+
+ private:
+  enum class State : uint8_t { UP, PRESSING, DOWN, RELEASING };
+
+  struct Key {
+    State state = State::UP;
+    bool repeats = false;
+    // When the key started PRESSING or RELEASING
+    uint32_t since_ms = 0;
+    // When a held key sends its next repeat
+    uint32_t repeat_ms = 0;
+  };
+
+  Config config_;
+  std::array<std::array<Key, columns>, rows> keys_ = {};
+
+ public:
+  KeyDebouncer() = default;
+  explicit KeyDebouncer(const Config& config) : config_(config) {}
+
+  // Held key sends a press every repeat_interval_ms, ie for the arrows
+  void setRepeat(uint8_t row, uint8_t column, bool repeats) {
+    keys_[row][column].repeats = repeats;
+  }
+
+  bool isDown(uint8_t row, uint8_t column) const {
+    State state = keys_[row][column].state;
+    return state == State::DOWN || state == State::RELEASING;
+  }
+
+  /**
+   * @brief Feeds the latest sample of one row
+   *
+   * @param time_ms when the row was read, only differences are used so it can
+   * roll over
+   * @param row which row was read
+   * @param pressed bit j set if column j reads pressed
+   * @param events anything with bool push(const KeyEvent&), if an event
+   * doesn't fit the key stays where it was and tries again next sample
+   */
+  template <typename Queue>
+  void update(uint32_t time_ms, uint8_t row, uint32_t pressed,
+              Queue& events) {
+    for (uint8_t j = 0; j < columns; j++) {
+      Key& key = keys_[row][j];
+      bool down = (pressed >> j) & 1;
+      switch (key.state) {
+        case State::UP:
+          if (down) {
+            key.state = State::PRESSING;
+            key.since_ms = time_ms;
+          }
+          break;
+        case State::PRESSING:
+          if (!down) {
+            key.state = State::UP;  // bounce
+          } else if (time_ms - key.since_ms >= config_.debounce_ms &&
+                     events.push({time_ms, row, j, true, false})) {
+            key.state = State::DOWN;
+            key.repeat_ms = time_ms + config_.repeat_delay_ms;
+          }
+          break;
+        case State::DOWN:
+          if (!down) {
+            key.state = State::RELEASING;
+            key.since_ms = time_ms;
+          } else if (key.repeats &&
+                     static_cast<int32_t>(time_ms - key.repeat_ms) >= 0 &&
+                     events.push({time_ms, row, j, true, true})) {
+            // From now so a late sample doesn't send a burst to catch up
+            key.repeat_ms = time_ms + config_.repeat_interval_ms;
+          }
+          break;
+        case State::RELEASING:
+          if (down) {
+            key.state = State::DOWN;  // bounce
+          } else if (time_ms - key.since_ms >= config_.debounce_ms &&
+                     events.push({time_ms, row, j, false, false})) {
+            key.state = State::UP;
+          }
+          break;
+      }
+    }
+  }
+};
@@ -0,0 +1,22 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+
+// A key going down or up, row and column index into the ButtonMatrix pins
+struct KeyEvent {
+  uint32_t time_ms;
+  uint8_t row;
+  uint8_t column;
+  bool pressed;
+  // Sent again because the key is held, always pressed
+  bool repeat;
+};
@@ -0,0 +1,79 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The PCF8574 is only rated for 100kHz, if a backpack doesn't keep up build
+// with -DLCD_I2C_BAUD=100000
+#ifndef LCD_I2C_BAUD
+#define LCD_I2C_BAUD (400 * 1000)
+#endif
+
+/**
+ * @brief Where LcdTransport sends its bytes, I2C on the pico and a fake in the
+ * tests
+ */
+class LcdBus {
+ public:
+  virtual ~LcdBus() = default;
+  // One I2C write to the backpack, every byte sets all 8 of its pins
+  virtual void write(const uint8_t* data, size_t size) = 0;
+  virtual void delayUs(uint32_t us) = 0;
+};
+
+/**
+ * @brief Drives a HD44780 (LCD1602) through a PCF8574 I2C backpack in 4 bit
+ * mode. Every nibble is 3 bus bytes (data, data with enable, data) and a whole
+ * run of LCD bytes goes out in one write.
+ *
+ * Nothing in a run has to wait: a bus byte takes 22.5us at 400kHz, so the
+ * enable pulse (min 450ns) is covered many times over and the next byte's
+ * first nibble is latched 67us after the last one, more than the 37us (52us
+ * on a slow part) a command or character takes. Only clear and home (1.52ms)
+ * and init sleep.
+ */
+class LcdTransport {
+ public:
+  enum class Mode : uint8_t { COMMAND = 0, CHARACTER = 1 };
+
+  // Bus bytes for one LCD byte
+  static constexpr size_t BYTES_PER_BYTE = 6;
+  // LCD bytes in one write, a cursor move and a full line
+  static constexpr size_t MAX_BATCH = 1 + 16;
+
+ private:
+  LcdBus& bus_;
+  uint8_t buffer_[MAX_BATCH * BYTES_PER_BYTE];
+  size_t size_ = 0;
+
+  void addNibble(uint8_t nibble, Mode mode);
+  void add(uint8_t val, Mode mode);
+  void flush();
+
+ public:
+  explicit LcdTransport(LcdBus& bus) : bus_(bus) {}
+
+  // Power on sequence into 4 bit mode, 2 lines, display on and cleared
+  void init();
+
+  void command(uint8_t command);
+  void setCursor(int line, int position);
+
+  /**
+   * @brief Moves the cursor and writes chars in as few bus writes as it can
+   * (one unless size is more than a line)
+   */
+  void writeAt(int line, int position, const char* chars, size_t size);
+
+  // Fills one of the 8 custom characters
+  void createChar(uint8_t location, const uint8_t charmap[8]);
+};
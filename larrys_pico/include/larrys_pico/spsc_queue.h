@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Wait-free ring buffer for exactly one producer and one consumer, ie
+ * a timer interrupt pushing key events and the main loop popping them.
+ *
+ * Each side only writes its own index and only reads the other's, so a push
+ * or pop is a couple of loads and stores with no locks and no retries. That is
+ * also all the Cortex-M0+ has, it can't do compare and swap.
+ *
+ * @tparam T copied in and out, keep it small
+ * @tparam capacity has to be a power of 2, holds capacity - 1 items
+ */
+template <typename T, size_t capacity>
+class SpscQueue {
+  static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0,
+                "capacity has to be a power of 2");
+  static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+ private:
+  static constexpr uint32_t MASK = capacity - 1;
+
+  T items_[capacity] = {};
+  // Next slot push writes, only the producer stores to it
+  std::atomic<uint32_t> head_ = 0;
+  // Next slot pop reads, only the consumer stores to it
+  std::atomic<uint32_t> tail_ = 0;
+
+ public:
+  // Producer only, false (and item is dropped) if the queue is full
+  bool push(const T& item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t next = (head + 1) & MASK;
+    if (next == tail_.load(std::memory_order_acquire)) return false;
+    items_[head] = item;
+    // Publishes the item to the consumer
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only, false if the queue is empty
+  bool pop(T& item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    item = items_[tail];
+    // Hands the slot back to the producer
+    tail_.store((tail + 1) & MASK, std::memory_order_release);
+    return true;
+  }
+
+  // Only exact when called from one of the two sides while the other is idle
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+  size_t size() const {
+    return (head_.load(std::memory_order_acquire) -
+            tail_.load(std::memory_order_acquire)) &
+           MASK;
+  }
+};
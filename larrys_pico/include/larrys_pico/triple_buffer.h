@@ -0,0 +1,63 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Hands whole values from one writer to one reader without locks. The
+ * writer fills back() and publishes it, the reader takes whatever was
+ * published last. Neither ever waits on the other, frames the reader didn't
+ * get to in time are skipped.
+ *
+ * With three buffers there is always one that is neither the latest published
+ * nor the one being read for the writer to use next. Publishing is an index
+ * store instead of a swap since the Cortex-M0+ has no atomic exchange.
+ */
+template <typename T>
+class TripleBuffer {
+  static_assert(std::atomic<uint8_t>::is_always_lock_free);
+
+ private:
+  T buffers_[3] = {};
+  // Only the writer stores to these two
+  std::atomic<uint8_t> latest_ = 0;
+  uint8_t back_ = 1;
+  // Only the reader stores to it
+  std::atomic<uint8_t> reading_ = 0;
+
+ public:
+  // Writer only, starts out as whatever was in the buffer last time
+  T& back() { return buffers_[back_]; }
+
+  // Writer only, makes back() the latest and moves on to a free buffer
+  void publish() {
+    latest_.store(back_);
+    uint8_t reading = reading_.load();
+    // reading can only equal back_ while take is retrying, then it's not
+    // reading anything
+    back_ = (reading == back_) ? (back_ + 1) % 3 : 3 - back_ - reading;
+  }
+
+  // Reader only, the latest published value, valid until the next take
+  const T& take() {
+    uint8_t latest = latest_.load();
+    while (true) {
+      reading_.store(latest);
+      // If it is still the latest the writer has seen reading_ and won't
+      // pick it
+      uint8_t check = latest_.load();
+      if (check == latest) break;
+      latest = check;
+    }
+    return buffers_[latest];
+  }
+};
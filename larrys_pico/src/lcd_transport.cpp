@@ -0,0 +1,125 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+
+#include "larrys_pico/lcd_transport.h"
+
+/**
+ * The commands and pin layout come from the raspberry pi example
+ * all credit goes to raspberry pi LTD
+ */
+
+/**
+ * Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// commands
+const int LCD_CLEARDISPLAY = 0x01;
+const int LCD_RETURNHOME = 0x02;
+const int LCD_ENTRYMODESET = 0x04;
+const int LCD_DISPLAYCONTROL = 0x08;
+const int LCD_FUNCTIONSET = 0x20;
+const int LCD_SETCGRAMADDR = 0x40;
+const int LCD_SETDDRAMADDR = 0x80;
+
+// flags for display entry mode
+const int LCD_ENTRYLEFT = 0x02;
+
+// flags for display and cursor control
+const int LCD_BLINKON = 0x01;
+const int LCD_DISPLAYON = 0x04;
+
+// flags for function set
+const int LCD_2LINE = 0x08;
+
+// flag for backlight control
+const int LCD_BACKLIGHT = 0x08;
+
+const int LCD_ENABLE_BIT = 0x04;
+
+// Datasheet timings
+const uint32_t POWER_ON_US = 40000;
+const uint32_t INIT_FIRST_US = 4100;
+const uint32_t INIT_US = 100;
+const uint32_t CLEAR_US = 1520;
+
+void LcdTransport::addNibble(uint8_t nibble, Mode mode) {
+  if (size_ + 3 > sizeof(buffer_)) flush();
+  uint8_t pins = static_cast<uint8_t>(mode) | (nibble << 4) | LCD_BACKLIGHT;
+  // Latched when enable goes low, the bytes either side give the setup and
+  // hold time
+  buffer_[size_++] = pins;
+  buffer_[size_++] = pins | LCD_ENABLE_BIT;
+  buffer_[size_++] = pins;
+}
+
+void LcdTransport::add(uint8_t val, Mode mode) {
+  addNibble(val >> 4, mode);
+  addNibble(val & 0xF, mode);
+}
+
+void LcdTransport::flush() {
+  if (size_ == 0) return;
+  bus_.write(buffer_, size_);
+  size_ = 0;
+}
+
+void LcdTransport::init() {
+  bus_.delayUs(POWER_ON_US);
+  // Still in 8 bit mode, the low data pins aren't wired so every nibble is a
+  // whole command. Three 8 bit function sets in case it was left half way
+  // through a 4 bit byte, then 4 bit mode
+  addNibble(0x3, Mode::COMMAND);
+  flush();
+  bus_.delayUs(INIT_FIRST_US);
+  addNibble(0x3, Mode::COMMAND);
+  flush();
+  bus_.delayUs(INIT_US);
+  addNibble(0x3, Mode::COMMAND);
+  addNibble(0x2, Mode::COMMAND);
+
+  add(LCD_FUNCTIONSET | LCD_2LINE, Mode::COMMAND);
+  add(LCD_ENTRYMODESET | LCD_ENTRYLEFT, Mode::COMMAND);
+  add(LCD_DISPLAYCONTROL | LCD_DISPLAYON | LCD_BLINKON, Mode::COMMAND);
+  command(LCD_CLEARDISPLAY);
+}
+
+void LcdTransport::command(uint8_t command) {
+  add(command, Mode::COMMAND);
+  flush();
+  if (command == LCD_CLEARDISPLAY || command == LCD_RETURNHOME) {
+    bus_.delayUs(CLEAR_US);
+  }
+}
+
+void LcdTransport::setCursor(int line, int position) {
+  command(LCD_SETDDRAMADDR | ((line == 0) ? 0x00 : 0x40) | position);
+}
+
+void LcdTransport::writeAt(int line, int position, const char* chars,
+                           size_t size) {
+  add(LCD_SETDDRAMADDR | ((line == 0) ? 0x00 : 0x40) | position,
+      Mode::COMMAND);
+  for (size_t i = 0; i < size; i++) {
+    add(static_cast<uint8_t>(chars[i]), Mode::CHARACTER);
+  }
+  flush();
+}
+
+void LcdTransport::createChar(uint8_t location, const uint8_t charmap[8]) {
+  location &= 0x7;  // we only have 8 locations 0-7
+  add(LCD_SETCGRAMADDR | (location << 3), Mode::COMMAND);
+  for (int i = 0; i < 8; i++) {
+    add(charmap[i], Mode::CHARACTER);
+  }
+  flush();
+}
@@ -0,0 +1,468 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "big_number.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "math_util.h"
+
+using picolator::math::BigInt;
+using picolator::math::BigRational;
+using picolator::math::Error;
+
+using Limb = BigInt::Limb;
+using Magnitude = BigInt::Magnitude;
+
+// Below this many limbs schoolbook multiplication beats Karatsuba
+static constexpr size_t KARATSUBA_THRESHOLD = 32;
+static constexpr uint64_t LIMB_BASE = 1ULL << 32;
+
+//////////////////////////
+// Magnitude helpers
+//////////////////////////
+
+static void trim(Magnitude& mag) {
+  while (!mag.empty() && mag.back() == 0) mag.pop_back();
+}
+
+static int compareMag(const Magnitude& lhs, const Magnitude& rhs) {
+  if (lhs.size() != rhs.size()) return lhs.size() < rhs.size() ? -1 : 1;
+  for (size_t i = lhs.size(); i-- > 0;) {
+    if (lhs[i] != rhs[i]) return lhs[i] < rhs[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+static Magnitude addMag(const Magnitude& lhs, const Magnitude& rhs) {
+  const Magnitude& big = lhs.size() >= rhs.size() ? lhs : rhs;
+  const Magnitude& small = lhs.size() >= rhs.size() ? rhs : lhs;
+  Magnitude res(big.size() + 1);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < big.size(); i++) {
+    carry += static_cast<uint64_t>(big[i]) + (i < small.size() ? small[i] : 0);
+    res[i] = static_cast<Limb>(carry);
+    carry >>= 32;
+  }
+  res[big.size()] = static_cast<Limb>(carry);
+  trim(res);
+  return res;
+}
+
+// lhs - rhs, lhs must be >= rhs
+static Magnitude subMag(const Magnitude& lhs, const Magnitude& rhs) {
+  Magnitude res(lhs.size());
+  int64_t borrow = 0;
+  for (size_t i = 0; i < lhs.size(); i++) {
+    int64_t diff = static_cast<int64_t>(lhs[i]) - borrow -
+                   (i < rhs.size() ? static_cast<int64_t>(rhs[i]) : 0);
+    borrow = diff < 0;
+    res[i] = static_cast<Limb>(diff);
+  }
+  trim(res);
+  return res;
+}
+
+// res += value << (32 * offset)
+static void addShifted(Magnitude& res, const Magnitude& value, size_t offset) {
+  if (res.size() < value.size() + offset + 1) {
+    res.resize(value.size() + offset + 1);
+  }
+  uint64_t carry = 0;
+  size_t i = 0;
+  for (; i < value.size(); i++) {
+    carry += static_cast<uint64_t>(res[i + offset]) + value[i];
+    res[i + offset] = static_cast<Limb>(carry);
+    carry >>= 32;
+  }
+  for (i += offset; carry; i++) {
+    if (i == res.size()) res.push_back(0);
+    carry += res[i];
+    res[i] = static_cast<Limb>(carry);
+    carry >>= 32;
+  }
+}
+
+static Magnitude mulSchoolbook(const Magnitude& lhs, const Magnitude& rhs) {
+  if (lhs.empty() || rhs.empty()) return {};
+  Magnitude res(lhs.size() + rhs.size());
+  for (size_t i = 0; i < lhs.size(); i++) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < rhs.size(); j++) {
+      carry += static_cast<uint64_t>(lhs[i]) * rhs[j] + res[i + j];
+      res[i + j] = static_cast<Limb>(carry);
+      carry >>= 32;
+    }
+    res[i + rhs.size()] = static_cast<Limb>(carry);
+  }
+  trim(res);
+  return res;
+}
+
+static Magnitude mulMag(const Magnitude& lhs, const Magnitude& rhs) {
+  if (lhs.size() < KARATSUBA_THRESHOLD || rhs.size() < KARATSUBA_THRESHOLD) {
+    return mulSchoolbook(lhs, rhs);
+  }
+
+  // lhs = a1 * B^half + a0, rhs = b1 * B^half + b0
+  size_t half = std::max(lhs.size(), rhs.size()) / 2;
+  auto low = [half](const Magnitude& mag) {
+    Magnitude res(mag.begin(), mag.begin() + std::min(half, mag.size()));
+    trim(res);
+    return res;
+  };
+  auto high = [half](const Magnitude& mag) {
+    if (mag.size() <= half) return Magnitude();
+    return Magnitude(mag.begin() + half, mag.end());
+  };
+  Magnitude a0 = low(lhs), a1 = high(lhs);
+  Magnitude b0 = low(rhs), b1 = high(rhs);
+
+  Magnitude z0 = mulMag(a0, b0);
+  Magnitude z2 = mulMag(a1, b1);
+  // (a0 + a1)(b0 + b1) - z0 - z2 = a0 * b1 + a1 * b0
+  Magnitude z1 = subMag(subMag(mulMag(addMag(a0, a1), addMag(b0, b1)), z0), z2);
+
+  Magnitude res = z0;
+  addShifted(res, z1, half);
+  addShifted(res, z2, 2 * half);
+  trim(res);
+  return res;
+}
+
+// Divides by a single limb and returns the remainder
+static Limb divModLimb(const Magnitude& mag, Limb divisor,
+                       Magnitude& quotient) {
+  quotient.assign(mag.size(), 0);
+  uint64_t rem = 0;
+  for (size_t i = mag.size(); i-- > 0;) {
+    uint64_t cur = (rem << 32) | mag[i];
+    quotient[i] = static_cast<Limb>(cur / divisor);
+    rem = cur % divisor;
+  }
+  trim(quotient);
+  return static_cast<Limb>(rem);
+}
+
+// mag << bits where bits < 32, always adds one extra limb
+static Magnitude shiftLeft(const Magnitude& mag, int bits) {
+  Magnitude res(mag.size() + 1);
+  for (size_t i = 0; i < mag.size(); i++) {
+    uint64_t cur = static_cast<uint64_t>(mag[i]) << bits;
+    res[i] |= static_cast<Limb>(cur);
+    res[i + 1] = static_cast<Limb>(cur >> 32);
+  }
+  return res;
+}
+
+// Knuth's algorithm D, rhs has to have at least 2 limbs
+static void divModMag(const Magnitude& lhs, const Magnitude& rhs,
+                      Magnitude& quotient, Magnitude& remainder) {
+  // Normalize so the top limb of the divisor has its high bit set
+  int bits = __builtin_clz(rhs.back());
+  Magnitude v = shiftLeft(rhs, bits);
+  v.pop_back();
+  Magnitude u = shiftLeft(lhs, bits);
+
+  size_t n = v.size();
+  size_t m = lhs.size() - n;
+  quotient.assign(m + 1, 0);
+
+  for (size_t j = m + 1; j-- > 0;) {
+    uint64_t top = (static_cast<uint64_t>(u[j + n]) << 32) | u[j + n - 1];
+    uint64_t qhat = top / v[n - 1];
+    uint64_t rhat = top % v[n - 1];
+    while (qhat >= LIMB_BASE ||
+           qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+      qhat--;
+      rhat += v[n - 1];
+      if (rhat >= LIMB_BASE) break;
+    }
+
+    // u -= qhat * v
+    int64_t borrow = 0;
+    int64_t diff;
+    for (size_t i = 0; i < n; i++) {
+      uint64_t product = qhat * v[i];
+      diff = static_cast<int64_t>(u[i + j]) - borrow -
+             static_cast<int64_t>(product & 0xFFFFFFFF);
+      u[i + j] = static_cast<Limb>(diff);
+      borrow = static_cast<int64_t>(product >> 32) - (diff >> 32);
+    }
+    diff = static_cast<int64_t>(u[j + n]) - borrow;
+    u[j + n] = static_cast<Limb>(diff);
+
+    // qhat was one too big, add v back
+    if (diff < 0) {
+      qhat--;
+      uint64_t carry = 0;
+      for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(u[i + j]) + v[i];
+        u[i + j] = static_cast<Limb>(carry);
+        carry >>= 32;
+      }
+      u[j + n] += static_cast<Limb>(carry);
+    }
+    quotient[j] = static_cast<Limb>(qhat);
+  }
+  trim(quotient);
+
+  // Undo the normalization for the remainder
+  remainder.assign(n, 0);
+  for (size_t i = 0; i < n; i++) {
+    remainder[i] = bits ? (u[i] >> bits) |
+                              static_cast<Limb>(
+                                  static_cast<uint64_t>(u[i + 1]) << 32 >> bits)
+                        : u[i];
+  }
+  trim(remainder);
+}
+
+//////////////////////////
+// BigInt
+//////////////////////////
+
+BigInt::BigInt(Magnitude mag, bool negative) : mag_(std::move(mag)) {
+  trim(mag_);
+  negative_ = negative && !mag_.empty();
+}
+
+BigInt::BigInt(int64_t value) : negative_(value < 0) {
+  uint64_t mag = negative_ ? 0 - static_cast<uint64_t>(value) : value;
+  while (mag) {
+    mag_.push_back(static_cast<Limb>(mag));
+    mag >>= 32;
+  }
+}
+
+size_t BigInt::bitLength() const {
+  if (mag_.empty()) return 0;
+  return mag_.size() * 32 - __builtin_clz(mag_.back());
+}
+
+bool BigInt::fitsInt64() const { return bitLength() < 64; }
+
+int64_t BigInt::toInt64() const {
+  uint64_t mag = 0;
+  for (size_t i = std::min<size_t>(mag_.size(), 2); i-- > 0;) {
+    mag = (mag << 32) | mag_[i];
+  }
+  return negative_ ? -static_cast<int64_t>(mag) : static_cast<int64_t>(mag);
+}
+
+double BigInt::toDouble(int64_t& shift) const {
+  // The top three limbs hold more than the 53 bits a double can keep
+  size_t start = mag_.size() > 3 ? mag_.size() - 3 : 0;
+  double res = 0;
+  for (size_t i = mag_.size(); i-- > start;) {
+    res = res * LIMB_BASE + mag_[i];
+  }
+  shift = static_cast<int64_t>(start) * 32;
+  return negative_ ? -res : res;
+}
+
+std::string BigInt::toString() const {
+  if (mag_.empty()) return "0";
+
+  // Peel off 9 decimal digits at a time
+  std::string res;
+  Magnitude cur = mag_, next;
+  while (!cur.empty()) {
+    Limb chunk = divModLimb(cur, 1000000000, next);
+    cur.swap(next);
+    for (int i = 0; i < 9 && (!cur.empty() || chunk); i++) {
+      res.push_back('0' + chunk % 10);
+      chunk /= 10;
+    }
+  }
+  if (negative_) res.push_back('-');
+  std::reverse(res.begin(), res.end());
+  return res;
+}
+
+BigInt BigInt::operator-() const { return BigInt(mag_, !negative_); }
+
+namespace picolator::math {
+
+BigInt operator+(const BigInt& lhs, const BigInt& rhs) {
+  if (lhs.negative_ == rhs.negative_) {
+    return BigInt(addMag(lhs.mag_, rhs.mag_), lhs.negative_);
+  }
+  if (compareMag(lhs.mag_, rhs.mag_) >= 0) {
+    return BigInt(subMag(lhs.mag_, rhs.mag_), lhs.negative_);
+  }
+  return BigInt(subMag(rhs.mag_, lhs.mag_), rhs.negative_);
+}
+
+BigInt operator-(const BigInt& lhs, const BigInt& rhs) { return lhs + -rhs; }
+
+BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+  return BigInt(mulMag(lhs.mag_, rhs.mag_), lhs.negative_ != rhs.negative_);
+}
+
+BigInt operator/(const BigInt& lhs, const BigInt& rhs) {
+  BigInt quotient, remainder;
+  BigInt::divMod(lhs, rhs, quotient, remainder);
+  return quotient;
+}
+
+BigInt operator%(const BigInt& lhs, const BigInt& rhs) {
+  BigInt quotient, remainder;
+  BigInt::divMod(lhs, rhs, quotient, remainder);
+  return remainder;
+}
+
+bool operator==(const BigInt& lhs, const BigInt& rhs) {
+  return lhs.negative_ == rhs.negative_ && lhs.mag_ == rhs.mag_;
+}
+
+}  // namespace picolator::math
+
+void BigInt::divMod(const BigInt& lhs, const BigInt& rhs, BigInt& quotient,
+                    BigInt& remainder) {
+  if (rhs.isZero()) {
+    raise(Error::divideByZero());
+    quotient = remainder = 0;
+    return;
+  }
+
+  Magnitude q, r;
+  if (compareMag(lhs.mag_, rhs.mag_) < 0) {
+    r = lhs.mag_;
+  } else if (rhs.mag_.size() == 1) {
+    Limb rem = divModLimb(lhs.mag_, rhs.mag_[0], q);
+    if (rem) r.push_back(rem);
+  } else {
+    divModMag(lhs.mag_, rhs.mag_, q, r);
+  }
+  quotient = BigInt(std::move(q), lhs.negative_ != rhs.negative_);
+  remainder = BigInt(std::move(r), lhs.negative_);
+}
+
+BigInt BigInt::gcd(BigInt a, BigInt b) {
+  a.negative_ = false;
+  b.negative_ = false;
+  while (!b.isZero()) {
+    BigInt rem = a % b;
+    a = std::move(b);
+    b = std::move(rem);
+  }
+  return a;
+}
+
+BigInt BigInt::pow(BigInt base, uint64_t exp) {
+  BigInt res = 1;
+  while (exp) {
+    if (exp & 1) res = res * base;
+    exp >>= 1;
+    if (exp) base = base * base;
+  }
+  return res;
+}
+
+//////////////////////////
+// BigRational
+//////////////////////////
+
+BigRational::BigRational(const BigInt& num, const BigInt& den) {
+  if (den.isZero()) {
+    raise(Error::divideByZero());
+    return;
+  }
+  if (den == 1) {
+    num_ = num;
+    return;
+  }
+  BigInt gcd = BigInt::gcd(num, den);
+  num_ = num / gcd;
+  den_ = den / gcd;
+  if (den_.isNegative()) {
+    num_ = -num_;
+    den_ = -den_;
+  }
+}
+
+BigRational BigRational::parseDecimal(std::string_view digits) {
+  // 9 digits at a time fit in a limb so there is one BigInt op per chunk
+  BigInt num;
+  int64_t chunk = 0, chunk_scale = 1;
+  uint64_t decimals = 0;
+  bool after_point = false;
+  for (char c : digits) {
+    if (c == '.') {
+      if (after_point) break;
+      after_point = true;
+      continue;
+    }
+    chunk = chunk * 10 + (c - '0');
+    chunk_scale *= 10;
+    if (after_point) decimals++;
+    if (chunk_scale == 1000000000) {
+      num = num * BigInt(chunk_scale) + BigInt(chunk);
+      chunk = 0;
+      chunk_scale = 1;
+    }
+  }
+  num = num * BigInt(chunk_scale) + BigInt(chunk);
+  return BigRational(num, BigInt::pow(10, decimals));
+}
+
+bool BigRational::fitsInt64() const {
+  return num_.fitsInt64() && den_.fitsInt64();
+}
+
+double BigRational::getValue() const {
+  int64_t num_shift, den_shift;
+  double num = num_.toDouble(num_shift);
+  double den = den_.toDouble(den_shift);
+  return std::ldexp(num / den, num_shift - den_shift);
+}
+
+std::string BigRational::toString() const {
+  if (isInteger()) return num_.toString();
+  return num_.toString() + "/" + den_.toString();
+}
+
+namespace picolator::math {
+
+BigRational operator+(const BigRational& lhs, const BigRational& rhs) {
+  if (lhs.isInteger() && rhs.isInteger()) {
+    return BigRational(lhs.num_ + rhs.num_);
+  }
+  return BigRational(lhs.num_ * rhs.den_ + rhs.num_ * lhs.den_,
+                     lhs.den_ * rhs.den_);
+}
+
+BigRational operator-(const BigRational& lhs, const BigRational& rhs) {
+  return lhs + BigRational(-rhs.num_, rhs.den_);
+}
+
+BigRational operator*(const BigRational& lhs, const BigRational& rhs) {
+  if (lhs.isInteger() && rhs.isInteger()) {
+    return BigRational(lhs.num_ * rhs.num_);
+  }
+  return BigRational(lhs.num_ * rhs.num_, lhs.den_ * rhs.den_);
+}
+
+BigRational operator/(const BigRational& lhs, const BigRational& rhs) {
+  return BigRational(lhs.num_ * rhs.den_, lhs.den_ * rhs.num_);
+}
+
+}  // namespace picolator::math
+
+BigRational BigRational::pow(const BigRational& base, int64_t exp) {
+  uint64_t abs_exp = exp < 0 ? 0 - static_cast<uint64_t>(exp) : exp;
+  BigInt num = BigInt::pow(base.num_, abs_exp);
+  BigInt den = BigInt::pow(base.den_, abs_exp);
+  if (exp < 0) return BigRational(den, num);
+  return BigRational(num, den);
+}
@@ -0,0 +1,118 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace picolator::math {
+
+/**
+ * @brief Arbitrary precision integer.
+ * Only used once a LONG or FRACTION overflows int64, so it favours being
+ * simple over being clever except for Karatsuba on very large products.
+ */
+class BigInt {
+ public:
+  using Limb = uint32_t;
+  using Magnitude = std::vector<Limb>;
+
+ private:
+  // little endian limbs without leading zeros, empty for 0
+  Magnitude mag_;
+  bool negative_ = false;
+
+  BigInt(Magnitude mag, bool negative);
+
+ public:
+  BigInt() = default;
+  BigInt(int64_t value);
+
+  inline bool isZero() const { return mag_.empty(); }
+  inline bool isNegative() const { return negative_; }
+  inline size_t limbs() const { return mag_.size(); }
+  size_t bitLength() const;
+
+  // True if the value is in [-INT64_MAX, INT64_MAX]
+  bool fitsInt64() const;
+  int64_t toInt64() const;
+
+  /**
+   * @brief Returns the top bits of the number as a double
+   *
+   * @param shift set to how many low bits were dropped, the value is
+   *        approximately result * 2^shift
+   */
+  double toDouble(int64_t& shift) const;
+  std::string toString() const;
+
+  BigInt operator-() const;
+  friend BigInt operator+(const BigInt& lhs, const BigInt& rhs);
+  friend BigInt operator-(const BigInt& lhs, const BigInt& rhs);
+  friend BigInt operator*(const BigInt& lhs, const BigInt& rhs);
+  // Truncating division like the builtin integers
+  friend BigInt operator/(const BigInt& lhs, const BigInt& rhs);
+  friend BigInt operator%(const BigInt& lhs, const BigInt& rhs);
+  friend bool operator==(const BigInt& lhs, const BigInt& rhs);
+  friend bool operator!=(const BigInt& lhs, const BigInt& rhs) {
+    return !(lhs == rhs);
+  }
+
+  static void divMod(const BigInt& lhs, const BigInt& rhs, BigInt& quotient,
+                     BigInt& remainder);
+  // Always positive
+  static BigInt gcd(BigInt a, BigInt b);
+  static BigInt pow(BigInt base, uint64_t exp);
+};
+
+/**
+ * @brief Exact fraction of two BigInts, always reduced with a positive
+ * denominator
+ */
+class BigRational {
+ private:
+  BigInt num_;
+  BigInt den_ = 1;
+
+ public:
+  BigRational(const BigInt& num, const BigInt& den = 1);
+
+  /**
+   * @brief Parses typed digits exactly, for numbers too long for
+   * Number::parseDecimal. 1.25 becomes 5/4
+   *
+   * @param digits only 0-9 and at most one '.', anything past a second '.'
+   * is ignored
+   */
+  static BigRational parseDecimal(std::string_view digits);
+
+  inline const BigInt& numerator() const { return num_; }
+  inline const BigInt& denominator() const { return den_; }
+  inline bool isInteger() const { return den_ == 1; }
+
+  // True if both parts fit in int64 so it can go back to a LONG or FRACTION
+  bool fitsInt64() const;
+  double getValue() const;
+  std::string toString() const;
+
+  friend BigRational operator+(const BigRational& lhs,
+                               const BigRational& rhs);
+  friend BigRational operator-(const BigRational& lhs,
+                               const BigRational& rhs);
+  friend BigRational operator*(const BigRational& lhs,
+                               const BigRational& rhs);
+  friend BigRational operator/(const BigRational& lhs,
+                               const BigRational& rhs);
+  static BigRational pow(const BigRational& base, int64_t exp);
+};
+
+}  // namespace picolator::math
@@ -55,8 +55,13 @@ class BinaryOperator : public Letter {
     }
   }
 
-  Literals solve(const Literals& lhs, const Literals& rhs) {
-    switch (op_) {
+  Literals solve(const Literals& lhs, const Literals& rhs) const {
+    return solve(op_, lhs, rhs);
+  }
+
+  static Literals solve(const Type& op, const Literals& lhs,
+                        const Literals& rhs) {
+    switch (op) {
       case Type::ADDITION:
         return lhs + rhs;
         break;
@@ -67,23 +72,75 @@ class BinaryOperator : public Letter {
         return lhs * rhs;
         break;
       case Type::DIVISION:
-        if (rhs.getValue() == 0) throw DomainError("/");
+        if (rhs.isZero()) {
+          raise(Error::divideByZero());
+          return Literals(0);
+        }
         return lhs / rhs;
       case Type::EXPONENT:
-        if (lhs.getValue() == 0 && rhs.getValue() == 0)
-          throw DomainError("exp");
-        return pow(lhs.getValue(), rhs.getValue());
+        if (lhs.isZero() && rhs.isZero()) {
+          raise(Error::domain("exp"));
+          return Literals(0);
+        }
+        return lhs ^ rhs;
       case Type::N_TH_ROOT:
-        if (lhs.getValue() == 0) throw DomainError("n_sqrt()");
+        if (lhs.isZero()) {
+          raise(Error::domain("n_sqrt()"));
+          return Literals(0);
+        }
         // This is meant to be backwards
-        return pow(rhs.getValue(), 1 / lhs.getValue());
+        return nthRoot(lhs, rhs);
       case Type::MODULUS:
         return lhs % rhs;
       default:
-        throw NotImplementedError(std::string(__func__));
+        raise(Error::notImplemented(__func__));
+        return Literals(0);
+    }
+  }
+
+  /**
+   * @brief Same as solve but stores the result in lhs so the result isn't
+   * copied back onto the stack
+   */
+  static void solveInPlace(const Type& op, Literals& lhs,
+                           const Literals& rhs) {
+    switch (op) {
+      case Type::ADDITION:
+        lhs += rhs;
+        break;
+      case Type::MULTIPLICATION:
+        lhs *= rhs;
+        break;
+      case Type::DIVISION:
+        if (rhs.isZero()) {
+          raise(Error::divideByZero());
+          break;
+        }
+        lhs /= rhs;
+        break;
+      default:
+        lhs = solve(op, lhs, rhs);
+        break;
     }
   }
 
   inline const Type getType() const { return op_; }
+
+ private:
+  // n_th root of x, odd roots of negatives stay real so the cube root of -8
+  // is -2. Even roots of negatives are complex
+  static Literals nthRoot(const Literals& n, const Literals& x) {
+    const Number& n_num = n.getNumber();
+    bool odd = n.getType() == Literals::Type::LONG &&
+               n_num.kind == Number::Kind::LONG && n_num.num % 2 != 0;
+    if (!x.isComplex() && !n.isComplex() && x.getValue() < 0 && odd) {
+      return -pow(-x.getValue(), 1 / n.getValue());
+    }
+    if (x.isComplex() || n.isComplex() || x.getValue() < 0) {
+      Complex inverse = Complex{Number::fromLong(1), Number()} / n.toComplex();
+      return Literals(Complex::pow(x.toComplex(), inverse));
+    }
+    return pow(x.getValue(), 1 / n.getValue());
+  }
 };
 }  // namespace picolator::math
\ No newline at end of file
@@ -14,24 +14,16 @@
 namespace picolator::math {
 class Bracket : public Letter {
  public:
-  enum class Type { OPEN, CLOSED, EQUATION };
-  using LetterVec = std::vector<std::shared_ptr<Letter>>;
+  enum class Type { OPEN, CLOSED };
  private:
   Type type_;
 
  public:
-  
-  LetterVec letters_;
   Bracket(const Type& type)
       : Letter((type == Type::OPEN) ? "(" : ")",
                Letter::Classification::BRACKET, 1),
         type_(type) {}
 
-  Bracket(LetterVec&& letters)
-      : Letter("Todo Impl", Letter::Classification::BRACKET, 1),
-        type_(Type::EQUATION),
-        letters_(std::move(letters)) {}
-
   const Type& getType() const { return type_; };
 };
 }  // namespace picolator::math
\ No newline at end of file
@@ -0,0 +1,174 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "complex.h"
+
+#include <cmath>
+#include <limits>
+
+#include "math_util.h"
+
+namespace picolator::math {
+
+// res if it fit, otherwise the same thing worked out with doubles. fallback
+// is only called when needed since getValue() on constants calls pow
+template <typename Fallback>
+static inline Number orDouble(const Number& res, Fallback fallback) {
+  return (res.kind == Number::Kind::BIG) ? Number::fromDouble(fallback())
+                                         : res;
+}
+
+// a*c + b*d, or a*c - b*d when subtract is set
+static Number mulAdd(const Number& a, const Number& c, const Number& b,
+                     const Number& d, bool subtract) {
+  Number bd = b * d;
+  return orDouble(a * c + (subtract ? -bd : bd), [&] {
+    double bd_value = b.getValue() * d.getValue();
+    return a.getValue() * c.getValue() + (subtract ? -bd_value : bd_value);
+  });
+}
+
+// Parts smaller then rounding error are treated as 0 so e^(i*pi) is -1
+static double snap(double part, double scale) {
+  return (std::fabs(part) <= scale * std::numeric_limits<double>::epsilon() * 4)
+             ? 0
+             : part;
+}
+
+Complex Complex::fromStd(const std::complex<double>& z) {
+  double scale = std::abs(z);
+  return {Number::fromDouble(snap(z.real(), scale)),
+          Number::fromDouble(snap(z.imag(), scale))};
+}
+
+Complex Complex::polar(double r, double theta) {
+  return fromStd(std::polar(r, theta));
+}
+
+std::complex<double> Complex::toStd() const {
+  return {re.getValue(), im.getValue()};
+}
+
+double Complex::abs() const { return std::abs(toStd()); }
+
+double Complex::arg() const { return std::arg(toStd()); }
+
+std::string Complex::toString() const {
+  std::string imag = im.toString();
+  if (imag == "1") {
+    imag.clear();
+  } else if (imag == "-1") {
+    imag = "-";
+  }
+  if (re.getValue() == 0) {
+    return imag + "i";
+  }
+  std::string res = re.toString();
+  if (imag.empty() || imag[0] != '-') res += "+";
+  return res + imag + "i";
+}
+
+Complex Complex::exp(const Complex& z) { return fromStd(std::exp(z.toStd())); }
+
+Complex Complex::log(const Complex& z) {
+  if (z.re.getValue() == 0 && z.im.getValue() == 0) {
+    raise(Error::domain("ln"));
+    return {};
+  }
+  return fromStd(std::log(z.toStd()));
+}
+
+Complex Complex::sqrt(const Complex& z) {
+  return fromStd(std::sqrt(z.toStd()));
+}
+
+Complex Complex::pow(const Complex& base, const Complex& exp) {
+  // Whole powers stay exact, (1+i)^2 = 2i
+  if (exp.isReal() && exp.re.kind == Number::Kind::LONG) {
+    return base ^ exp.re.num;
+  }
+  if (base.re.getValue() == 0 && base.im.getValue() == 0) {
+    if (exp.re.getValue() > 0) return {Number::fromLong(0), Number()};
+    raise(Error::domain("exp"));
+    return {};
+  }
+  return fromStd(std::pow(base.toStd(), exp.toStd()));
+}
+
+Complex Complex::sin(const Complex& z) { return fromStd(std::sin(z.toStd())); }
+
+Complex Complex::cos(const Complex& z) { return fromStd(std::cos(z.toStd())); }
+
+Complex Complex::tan(const Complex& z) { return fromStd(std::tan(z.toStd())); }
+
+Complex Complex::asin(const Complex& z) {
+  return fromStd(std::asin(z.toStd()));
+}
+
+Complex Complex::acos(const Complex& z) {
+  return fromStd(std::acos(z.toStd()));
+}
+
+Complex Complex::atan(const Complex& z) {
+  return fromStd(std::atan(z.toStd()));
+}
+
+Complex operator+(const Complex& lhs, const Complex& rhs) {
+  return {orDouble(lhs.re + rhs.re,
+                   [&] { return lhs.re.getValue() + rhs.re.getValue(); }),
+          orDouble(lhs.im + rhs.im,
+                   [&] { return lhs.im.getValue() + rhs.im.getValue(); })};
+}
+
+Complex operator-(const Complex& z) {
+  return {orDouble(-z.re, [&] { return -z.re.getValue(); }),
+          orDouble(-z.im, [&] { return -z.im.getValue(); })};
+}
+
+// (a+bi)(c+di) = (ac-bd) + (ad+bc)i
+Complex operator*(const Complex& lhs, const Complex& rhs) {
+  const Number &a = lhs.re, &b = lhs.im, &c = rhs.re, &d = rhs.im;
+  return {mulAdd(a, c, b, d, true), mulAdd(a, d, b, c, false)};
+}
+
+// (a+bi)/(c+di) = ((ac+bd) + (bc-ad)i) / (c^2+d^2)
+Complex operator/(const Complex& lhs, const Complex& rhs) {
+  const Number &a = lhs.re, &b = lhs.im, &c = rhs.re, &d = rhs.im;
+  Number den = mulAdd(c, c, d, d, false);
+  if (den.getValue() == 0) {
+    raise(Error::divideByZero());
+    return {};
+  }
+  Number re = mulAdd(a, c, b, d, false);
+  Number im = mulAdd(b, c, a, d, true);
+  return {orDouble(re / den, [&] { return re.getValue() / den.getValue(); }),
+          orDouble(im / den, [&] { return im.getValue() / den.getValue(); })};
+}
+
+Complex operator^(const Complex& z, int64_t n) {
+  uint64_t exp = (n < 0) ? 0 - static_cast<uint64_t>(n) : n;
+  Complex res = {Number::fromLong(1), Number::fromLong(0)};
+  Complex square = z;
+  while (exp) {
+    if (exp & 1) res = res * square;
+    exp >>= 1;
+    if (exp) square = square * square;
+  }
+  if (n < 0) {
+    return Complex{Number::fromLong(1), Number::fromLong(0)} / res;
+  }
+  return res;
+}
+
+bool operator==(const Complex& lhs, const Complex& rhs) {
+  return lhs.re == rhs.re && lhs.im == rhs.im;
+}
+
+}  // namespace picolator::math
@@ -0,0 +1,69 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <complex>
+#include <string>
+#include <type_traits>
+
+#include "number.h"
+
+namespace picolator::math {
+
+/**
+ * @brief re + im*i stored as two Numbers so 1/2 + 3i stays exact.
+ *
+ * +, -, * and / use the Number ops on the parts and only drop a part to a
+ * double if it would be BIG. The functions go through std::complex<double>.
+ * Nothing here touches the heap.
+ */
+struct Complex {
+  Number re;
+  Number im;
+
+  static Complex fromStd(const std::complex<double>& z);
+  // r * e^(i*theta)
+  static Complex polar(double r, double theta);
+
+  std::complex<double> toStd() const;
+  // Polar form of the number
+  double abs() const;
+  double arg() const;
+  inline bool isReal() const {
+    return im.kind != Number::Kind::BIG && im.getValue() == 0;
+  }
+  // 1+2i, 3-i or 2i
+  std::string toString() const;
+
+  static Complex exp(const Complex& z);
+  // Principal branch, raises a domain error for 0
+  static Complex log(const Complex& z);
+  static Complex sqrt(const Complex& z);
+  static Complex pow(const Complex& base, const Complex& exp);
+  static Complex sin(const Complex& z);
+  static Complex cos(const Complex& z);
+  static Complex tan(const Complex& z);
+  static Complex asin(const Complex& z);
+  static Complex acos(const Complex& z);
+  static Complex atan(const Complex& z);
+};
+
+static_assert(std::is_trivially_copyable_v<Complex>);
+
+Complex operator+(const Complex& lhs, const Complex& rhs);
+Complex operator-(const Complex& z);
+Complex operator*(const Complex& lhs, const Complex& rhs);
+// Raises DIVIDE_BY_ZERO
+Complex operator/(const Complex& lhs, const Complex& rhs);
+// z^n by squaring, stays exact as long as the parts fit
+Complex operator^(const Complex& z, int64_t n);
+bool operator==(const Complex& lhs, const Complex& rhs);
+
+}  // namespace picolator::math
@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "equation.h"
+
+#include <algorithm>
+
+#include "error.h"
+
+using picolator::math::Equation;
+using picolator::math::Error;
+using picolator::math::Letter;
+using picolator::math::TokenId;
+
+Equation::Equation(std::initializer_list<TokenId> ids) {
+  codes_.reserve(ids.size());
+  for (TokenId id : ids) push_back(id);
+}
+
+TokenId Equation::token(size_t idx) const {
+  Code code = codes_[idx];
+  return code < FIRST_VARIABLE ? static_cast<TokenId>(code) : TokenId::NONE;
+}
+
+const std::shared_ptr<Letter>& Equation::operator[](size_t idx) const {
+  Code code = codes_[idx];
+  if (code < FIRST_VARIABLE) {
+    return tokenLetter(static_cast<TokenId>(code));
+  }
+  return variableLetter(variables_[code - FIRST_VARIABLE]);
+}
+
+std::string_view Equation::symbol(size_t idx) const {
+  Code code = codes_[idx];
+  if (code < FIRST_VARIABLE) {
+    return tokenInfo(static_cast<TokenId>(code)).symbol;
+  }
+  return std::string_view(&variables_[code - FIRST_VARIABLE], 1);
+}
+
+void Equation::insertCode(size_t idx, Code code) {
+  codes_.insert(codes_.begin() + idx, code);
+}
+
+void Equation::insert(size_t idx, TokenId id) {
+  if (id == TokenId::NONE || id >= TokenId::COUNT) {
+    picolator::math::raise(Error::notImplemented(__func__));
+    return;
+  }
+  insertCode(idx, static_cast<Code>(id));
+}
+
+void Equation::insertVariable(size_t idx, char name) {
+  if (name < 'A' || name >= 'A' + Literals::VARIABLE_COUNT) {
+    picolator::math::raise(Error::domain("Var doesn't exist"));
+    return;
+  }
+  auto it = std::find(variables_.begin(), variables_.end(), name);
+  if (it == variables_.end()) {
+    variables_.push_back(name);
+    it = variables_.end() - 1;
+  }
+  insertCode(idx,
+             static_cast<Code>(FIRST_VARIABLE + (it - variables_.begin())));
+}
+
+void Equation::append(const Equation& other, size_t idx) {
+  Code code = other.codes_[idx];
+  if (code < FIRST_VARIABLE) {
+    insertCode(size(), code);
+  } else {
+    insertVariable(size(), other.variables_[code - FIRST_VARIABLE]);
+  }
+}
+
+void Equation::set(size_t idx, TokenId id) {
+  erase(idx);
+  insert(idx, id);
+}
+
+void Equation::erase(size_t idx) { codes_.erase(codes_.begin() + idx); }
+
+void Equation::truncate(size_t size) {
+  if (size < codes_.size()) codes_.resize(size);
+}
+
+void Equation::clear() {
+  codes_.clear();
+  variables_.clear();
+}
+
+size_t Equation::bytes() const {
+  return sizeof(*this) + codes_.capacity() * sizeof(Code) +
+         variables_.capacity();
+}
@@ -0,0 +1,81 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "letter.h"
+#include "literals.h"
+#include "token.h"
+
+namespace picolator::math {
+
+/**
+ * @brief An equation as it was typed, one byte per key. Codes below
+ * TokenId::COUNT are the token itself, the rest are variables and index a
+ * small side table of variable names. The letters only get looked up when the
+ * equation is drawn or parsed, so copying one into the history is a memcpy.
+ */
+class Equation {
+ public:
+  using Code = uint8_t;
+
+ private:
+  static constexpr Code FIRST_VARIABLE = static_cast<Code>(TokenId::COUNT);
+  static_assert(static_cast<size_t>(TokenId::COUNT) +
+                        Literals::VARIABLE_COUNT <=
+                    UINT8_MAX + 1,
+                "Equation codes don't fit in a byte");
+
+  std::vector<Code> codes_ = {};
+  // Name of each variable used, a variable's code is FIRST_VARIABLE + its
+  // index. Never shrinks until clear() so codes stay valid
+  std::vector<char> variables_ = {};
+
+  void insertCode(size_t idx, Code code);
+
+ public:
+  Equation() = default;
+  Equation(std::initializer_list<TokenId> ids);
+
+  size_t size() const { return codes_.size(); }
+  bool empty() const { return codes_.empty(); }
+
+  // Token at idx, NONE for variables
+  TokenId token(size_t idx) const;
+
+  // Letter to parse for idx, shared with every other equation
+  const std::shared_ptr<Letter>& operator[](size_t idx) const;
+
+  // What gets drawn on the lcd for idx
+  std::string_view symbol(size_t idx) const;
+
+  void push_back(TokenId id) { insert(size(), id); }
+  void insert(size_t idx, TokenId id);
+  void insertVariable(size_t idx, char name);
+  // Copies idx from other onto the end
+  void append(const Equation& other, size_t idx);
+  void set(size_t idx, TokenId id);
+
+  void erase(size_t idx);
+  // Drops everything from size onwards
+  void truncate(size_t size);
+  void clear();
+
+  // Heap and object bytes used, for comparing against a LetterPtr per key
+  size_t bytes() const;
+};
+
+}  // namespace picolator::math
@@ -0,0 +1,95 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "error.h"
+
+#include <cstdio>
+
+using picolator::math::Error;
+using picolator::math::ErrorCode;
+using picolator::math::MathError;
+
+void picolator::math::formatError(const Error& error, char* buf,
+                                  size_t size) {
+  switch (error.code) {
+    case ErrorCode::DOMAIN_ERROR:
+      snprintf(buf, size, "%s Domain error", error.what);
+      break;
+    case ErrorCode::DIVIDE_BY_ZERO:
+      snprintf(buf, size, "/ By 0");
+      break;
+    case ErrorCode::SYNTAX_ERROR:
+      snprintf(buf, size, "Syntax E %s", error.what);
+      break;
+    case ErrorCode::TYPE_ERROR:
+      snprintf(buf, size, "Type E %s-%s", error.what, error.type);
+      break;
+    case ErrorCode::NOT_IMPLEMENTED:
+      snprintf(buf, size, "NIMP %s", error.what);
+      break;
+    case ErrorCode::OVERFLOW_ERROR:
+      snprintf(buf, size, "%s Overflow", error.what);
+      break;
+    case ErrorCode::CANCELLED:
+      snprintf(buf, size, "Cancelled");
+      break;
+    default:
+      snprintf(buf, size, "Error");
+      break;
+  }
+}
+
+MathError::MathError(const Error& error) : error_(error) {
+  formatError(error, msg_, sizeof(msg_));
+}
+
+#if PICOLATOR_EXCEPTIONS
+
+void picolator::math::raise(const Error& error) {
+  switch (error.code) {
+    case ErrorCode::DOMAIN_ERROR:
+      throw DomainError(error.what);
+    case ErrorCode::DIVIDE_BY_ZERO:
+      throw DivideByZero();
+    case ErrorCode::SYNTAX_ERROR:
+      throw SyntaxError(error.what, error.idx);
+    case ErrorCode::TYPE_ERROR:
+      throw TypeError(error.what, error.type);
+    case ErrorCode::NOT_IMPLEMENTED:
+      throw NotImplementedError(error.what);
+    case ErrorCode::OVERFLOW_ERROR:
+      throw OverflowError(error.what);
+    case ErrorCode::CANCELLED:
+      throw Cancelled();
+    default:
+      throw MathError(error);
+  }
+}
+
+#else
+
+// Each thread has its own so evaluations running at the same time can't see
+// each others errors
+static PICOLATOR_THREAD_LOCAL Error pending_error;
+
+void picolator::math::raise(const Error& error) {
+  // Keep the first error, anything after it is usually caused by it
+  if (!pending_error) pending_error = error;
+}
+
+bool picolator::math::hasError() { return static_cast<bool>(pending_error); }
+
+Error picolator::math::takeError() {
+  Error error = pending_error;
+  pending_error = {};
+  return error;
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+// Set to 0 to build without exceptions, defaults to whatever the compiler
+// was told (-fno-exceptions turns them off)
+#ifndef PICOLATOR_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define PICOLATOR_EXCEPTIONS 1
+#else
+#define PICOLATOR_EXCEPTIONS 0
+#endif
+#endif
+
+// Storage for the pending error without exceptions. Set it to nothing for
+// targets without TLS, then only one thread can run the math at a time
+#ifndef PICOLATOR_THREAD_LOCAL
+#define PICOLATOR_THREAD_LOCAL thread_local
+#endif
+
+namespace picolator::math {
+
+// math.h already defines DOMAIN, hence the _ERROR on the end
+enum class ErrorCode : uint8_t {
+  NONE,
+  DOMAIN_ERROR,
+  DIVIDE_BY_ZERO,
+  SYNTAX_ERROR,
+  TYPE_ERROR,
+  NOT_IMPLEMENTED,
+  OVERFLOW_ERROR,
+  CANCELLED
+};
+
+/**
+ * @brief Everything needed to show an error. It only points at string
+ * literals so it can be made and copied without touching the heap.
+ */
+struct Error {
+  ErrorCode code = ErrorCode::NONE;
+  // Token the parser was on for syntax errors, -1 when not known
+  int16_t idx = -1;
+  // Function or op that failed ie "sqrt", or the syntax error message
+  const char* what = "";
+  // Type that wasn't allowed, only used by TYPE_ERROR
+  const char* type = "";
+
+  static constexpr Error domain(const char* ftn_name) {
+    return {ErrorCode::DOMAIN_ERROR, -1, ftn_name, ""};
+  }
+  static constexpr Error divideByZero() {
+    return {ErrorCode::DIVIDE_BY_ZERO, -1, "/", ""};
+  }
+  static constexpr Error syntax(const char* msg, int idx) {
+    return {ErrorCode::SYNTAX_ERROR, static_cast<int16_t>(idx), msg, ""};
+  }
+  static constexpr Error typeError(const char* ftn, const char* type) {
+    return {ErrorCode::TYPE_ERROR, -1, ftn, type};
+  }
+  static constexpr Error notImplemented(const char* func) {
+    return {ErrorCode::NOT_IMPLEMENTED, -1, func, ""};
+  }
+  static constexpr Error overflow(const char* what) {
+    return {ErrorCode::OVERFLOW_ERROR, -1, what, ""};
+  }
+  static constexpr Error cancelled() {
+    return {ErrorCode::CANCELLED, -1, "", ""};
+  }
+
+  explicit constexpr operator bool() const { return code != ErrorCode::NONE; }
+};
+
+// Longest message formatError writes, including the null
+constexpr size_t ERROR_MSG_SIZE = 48;
+
+/**
+ * @brief Writes the message shown on the lcd for error, ie
+ * "sqrt Domain error" or "/ By 0"
+ */
+void formatError(const Error& error, char* buf, size_t size);
+
+/**
+ * @brief Base of the exceptions thrown when PICOLATOR_EXCEPTIONS is on. The
+ * message is formatted into the exception so nothing is allocated.
+ */
+class MathError : public std::exception {
+ private:
+  Error error_;
+  char msg_[ERROR_MSG_SIZE];
+
+ public:
+  explicit MathError(const Error& error);
+  const char* what() const noexcept override { return msg_; }
+  const Error& error() const { return error_; }
+};
+
+class DomainError : public MathError {
+ public:
+  explicit DomainError(const char* ftn_name)
+      : MathError(Error::domain(ftn_name)) {}
+};
+
+class DivideByZero : public MathError {
+ public:
+  DivideByZero() : MathError(Error::divideByZero()) {}
+};
+
+class SyntaxError : public MathError {
+ public:
+  SyntaxError(const char* msg, int idx)
+      : MathError(Error::syntax(msg, idx)), idx_(idx) {}
+  const int idx_;
+};
+
+class TypeError : public MathError {
+ public:
+  TypeError(const char* ftn, const char* type)
+      : MathError(Error::typeError(ftn, type)) {}
+};
+
+class NotImplementedError : public MathError {
+ public:
+  explicit NotImplementedError(const char* func)
+      : MathError(Error::notImplemented(func)) {}
+};
+
+class OverflowError : public MathError {
+ public:
+  explicit OverflowError(const char* what) : MathError(Error::overflow(what)) {}
+};
+
+class Cancelled : public MathError {
+ public:
+  Cancelled() : MathError(Error::cancelled()) {}
+};
+
+/**
+ * @brief Reports an error from anywhere in the math engine.
+ *
+ * With exceptions this throws the matching MathError. Without them the first
+ * error is kept until takeError() and raise returns, so the caller has to
+ * return some placeholder value that is safe to keep using.
+ */
+#if PICOLATOR_EXCEPTIONS
+[[noreturn]]
+#endif
+void raise(const Error& error);
+
+#if PICOLATOR_EXCEPTIONS
+// Errors never sit pending when they are thrown
+constexpr bool hasError() { return false; }
+inline Error takeError() { return {}; }
+#else
+// True once raise() has been called and the error hasn't been taken
+bool hasError();
+// Returns the pending error (NONE if there isn't one) and clears it
+Error takeError();
+#endif
+
+/**
+ * @brief Runs f and returns the error it raised, NONE if it worked. This is
+ * the only place errors turn back into normal return values.
+ *
+ * Only MathErrors are caught, anything else (ie bad_alloc) still goes up.
+ */
+template <typename F>
+Error capture(F&& f) {
+#if PICOLATOR_EXCEPTIONS
+  try {
+    std::forward<F>(f)();
+  } catch (const MathError& e) {
+    return e.error();
+  }
+  return {};
+#else
+  // Put back anything the caller had pending so nested captures don't eat it
+  Error outer = takeError();
+  std::forward<F>(f)();
+  Error error = takeError();
+  if (outer) raise(outer);
+  return error;
+#endif
+}
+
+/**
+ * @brief Either a value or the Error that stopped it from being made, like
+ * std::expected
+ */
+template <typename T>
+class Result {
+ private:
+  T value_ = {};
+  Error error_ = {};
+
+ public:
+  Result(T value) : value_(std::move(value)) {}
+  Result(const Error& error) : error_(error) {}
+
+  bool ok() const { return !error_; }
+  explicit operator bool() const { return ok(); }
+
+  // Only valid when ok()
+  const T& value() const { return value_; }
+  T& value() { return value_; }
+  const T& operator*() const { return value_; }
+  const T* operator->() const { return &value_; }
+
+  const Error& error() const { return error_; }
+};
+
+}  // namespace picolator::math
@@ -0,0 +1,30 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "eval_environment.h"
+
+#include "error.h"
+
+using picolator::math::EvalEnvironment;
+using picolator::math::Error;
+
+uint8_t EvalEnvironment::variableSlot(char name) {
+  if (name < 'A' || name >= 'A' + Literals::VARIABLE_COUNT) {
+    picolator::math::raise(Error::domain("Var doesn't exist"));
+    return ANS_SLOT;
+  }
+  return ANS_SLOT + 1 + (name - 'A');
+}
+
+const EvalEnvironment& EvalEnvironment::empty() {
+  // Never written to so it is safe to share between threads
+  static const EvalEnvironment environment;
+  return environment;
+}
@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "literals.h"
+
+namespace picolator::math {
+
+/**
+ * @brief The values ANS and the variables have while a Program runs. Programs
+ * only read from it, so evaluations with their own environments (or sharing
+ * one nobody is writing to) can run at the same time on both cores.
+ *
+ * Every value has a slot that Program binds to when it is compiled, so
+ * loading one is just an array index.
+ */
+class EvalEnvironment {
+ public:
+  static constexpr uint8_t ANS_SLOT = 0;
+  static constexpr uint8_t SLOTS = 1 + Literals::VARIABLE_COUNT;
+  static_assert(std::atomic<bool>::is_always_lock_free);
+
+  /**
+   * @brief Slot a variable is stored in
+   *
+   * @param name 'A' to 'F', anything else raises a domain error and gives
+   * ANS_SLOT
+   */
+  static uint8_t variableSlot(char name);
+
+  // Everything 0, what solving without an environment uses
+  static const EvalEnvironment& empty();
+
+ private:
+  Literals slots_[SLOTS] = {0, 0, 0, 0, 0, 0, 0};
+  // Set by another thread (or core) to stop a Program part way through
+  const std::atomic<bool>* cancel_ = nullptr;
+
+ public:
+  Literals& ans() { return slots_[ANS_SLOT]; }
+  const Literals& ans() const { return slots_[ANS_SLOT]; }
+
+  Literals& variable(char name) { return slots_[variableSlot(name)]; }
+  const Literals& variable(char name) const {
+    return slots_[variableSlot(name)];
+  }
+
+  // Only call with slots from ANS_SLOT or variableSlot
+  const Literals& slot(uint8_t slot) const { return slots_[slot]; }
+
+  /**
+   * @brief Lets a Program running with this environment be cancelled. Once
+   * flag is true it stops before its next instruction with a CANCELLED error
+   *
+   * @param flag has to outlive any Program running with this environment,
+   * nullptr to never cancel
+   */
+  void setCancelFlag(const std::atomic<bool>* flag) { cancel_ = flag; }
+  bool cancelled() const {
+    return cancel_ && cancel_->load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace picolator::math
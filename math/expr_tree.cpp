@@ -12,14 +12,20 @@
 #include "expr_tree.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
 #include <queue>
-#include <stack>
+#include <unordered_map>
+#include <utility>
 
 #include "binary_operator.h"
 #include "bracket.h"
+#include "equation.h"
 #include "literals.h"
 #include "literals_piece.h"
 #include "math_util.h"
+#include "tokenizer.h"
 #include "unary_operator.h"
 
 // todo remove
@@ -27,80 +33,323 @@
 
 using picolator::math::BinaryOperator;
 using picolator::math::Bracket;
+using picolator::math::Equation;
+using picolator::math::Error;
+using picolator::math::EvalEnvironment;
 using picolator::math::ExprTree;
 using picolator::math::Letter;
 using picolator::math::Literals;
 using picolator::math::LiteralsPiece;
+using picolator::math::Program;
+using picolator::math::Result;
+using picolator::math::Tokenizer;
 using picolator::math::UnaryOperator;
 
-ExprTree::ExprTree(const ExprTree::ExprVec& expr) {
-  root_ = std::move(createTree(minimizeTreeInput(expr)));
+ExprTree::ExprTree(const ExprTree::ExprVec& expr, size_t max_depth) {
+  root_ = createTree(minimizeTreeInput(expr), max_depth);
+  program_ = compile();
 }
 
-// checks if letter has a value
-#define LETTER_PTR_HAS_VALUE(l)                                        \
-  (l->value->getClassification() == Letter::Classification::LITERAL || \
-   l->current_value != nullptr)
+ExprTree::ExprTree(const Equation& expr, size_t max_depth) {
+  root_ = createTree(minimizeTreeInput(expr), max_depth);
+  program_ = compile();
+}
 
-#define LETTER_PTR_GET_VALUE(l)                               \
-  ((l->current_value != nullptr)                              \
-       ? reinterpret_cast<const Literals&>(*l->current_value) \
-       : reinterpret_cast<const Literals&>(*l->value))
+ExprTree ExprTree::fromTokens(const ExprVec& tokens, size_t max_depth,
+                              const EvalEnvironment& env) {
+  ExprTree tree;
+  tree.root_ = tree.createTree(tokens, max_depth);
+  tree.program_ = tree.compile(Program::Mode::EXACT, env);
+  return tree;
+}
 
-ExprTree::LiteralPtr ExprTree::getValue() {
-  std::stack<ExprTreeNode*> node_stack;
-  node_stack.emplace(root_.get());
+ExprTree::NodeIndex ExprTree::addNode(const LetterPtr& value, NodeIndex lhs,
+                                      NodeIndex rhs) {
+  nodes_.emplace_back(ExprTreeNode{value, {lhs, rhs}});
+  return static_cast<NodeIndex>(nodes_.size() - 1);
+}
 
-  while (!node_stack.empty()) {
-    // Save this at the start so if the stack is altered we
-    // still have a reference to the top
+ExprTree::LiteralPtr ExprTree::getValue(const EvalEnvironment& env) const {
+  return std::make_shared<Literals>(program_.run(env).reduce());
+}
 
-    auto* top = node_stack.top();
-    // This is a value pop off the stack nothing to do here
-    if (LETTER_PTR_HAS_VALUE(top)) {
-      node_stack.pop();
-      continue;
+ExprTree::LiteralPtr ExprTree::getValue(Program::Mode mode,
+                                        const EvalEnvironment& env) const {
+  // Constants folded for EXACT would skip the other mode's math
+  if (mode != Program::Mode::EXACT && mode_ == Program::Mode::EXACT) {
+    return std::make_shared<Literals>(
+        compile(mode, env).run(mode, env).reduce());
+  }
+  return std::make_shared<Literals>(program_.run(mode, env).reduce());
+}
+
+Result<ExprTree::LiteralPtr> ExprTree::evaluate(
+    Program::Mode mode, const EvalEnvironment& env) const {
+  LiteralPtr value;
+  Error error =
+      picolator::math::capture([&] { value = getValue(mode, env); });
+  if (error) return error;
+  return value;
+}
+
+template <typename Letters>
+Result<ExprTree::LiteralPtr> ExprTree::evaluateLetters(
+    const Letters& equation, Program::Mode mode, const EvalEnvironment& env) {
+  LiteralPtr value;
+  Error error = picolator::math::capture([&] {
+    ExprTree tree;
+    tree.root_ = tree.createTree(minimizeTreeInput(equation), MAX_DEPTH);
+    // Without exceptions a parse error leaves an empty tree behind
+    if (picolator::math::hasError()) return;
+    tree.program_ = tree.compile(mode, env);
+    tree.mode_ = mode;
+    if (!picolator::math::hasError()) value = tree.getValue(mode, env);
+  });
+  if (error) return error;
+  return value;
+}
+
+Result<ExprTree::LiteralPtr> ExprTree::evaluate(const ExprVec& equation,
+                                                Program::Mode mode,
+                                                const EvalEnvironment& env) {
+  return evaluateLetters(equation, mode, env);
+}
+
+Result<ExprTree::LiteralPtr> ExprTree::evaluate(const Equation& equation,
+                                                Program::Mode mode,
+                                                const EvalEnvironment& env) {
+  return evaluateLetters(equation, mode, env);
+}
+
+// Literals that are only known when the tree is solved
+static bool isReference(const Literals& literal) {
+  return literal.getTokenType() == Literals::Type::VARIABLE ||
+         literal.getTokenType() == Literals::Type::ANS;
+}
+
+// Checks if two literal tokens will always have the same value
+static bool sameLiteral(const Literals& lhs, const Literals& rhs) {
+  if (lhs.getTokenType() != rhs.getTokenType()) return false;
+
+  switch (lhs.getTokenType()) {
+    case Literals::Type::VARIABLE:
+      return lhs.getVariableName() == rhs.getVariableName();
+    case Literals::Type::ANS:
+      return true;
+    default:
+      // Exact compare of the value, the string keeps 1/2 and 2/4 apart
+      return lhs.getValue() == rhs.getValue() &&
+             lhs.toString() == rhs.toString();
+  }
+}
+
+// Type of the op in a BINARY or UNARY letter
+static uint16_t opType(const Letter& letter) {
+  if (letter.getClassification() == Letter::Classification::BINARY) {
+    return static_cast<uint16_t>(
+        reinterpret_cast<const BinaryOperator&>(letter).getType());
+  }
+  return static_cast<uint16_t>(
+      reinterpret_cast<const UnaryOperator&>(letter).getOp());
+}
+
+ExprTree::NodeIndex ExprTree::optimize(std::vector<ExprTreeNode>& dag,
+                                       bool fold,
+                                       const EvalEnvironment& env) const {
+  if (root_ == NO_NODE) {
+    return NO_NODE;
+  }
+
+  // Constant folding, solve every subtree that doesn't use a VARIABLE or ANS.
+  // The same Literals math is used so fractions and constants stay exact
+  std::vector<std::optional<Literals>> folded(nodes_.size());
+  for (size_t i = 0; fold && i < nodes_.size(); i++) {
+    if (env.cancelled()) {
+      raise(Error::cancelled());
+      return NO_NODE;
     }
-    switch (top->value->getClassification()) {
-      case Letter::Classification::LITERAL:
-        // Set the current literals to current value
-        top->current_value = std::make_shared<Literals>(
-            *reinterpret_cast<Literals*>(top->value.get()));
-        break;
-      case Letter::Classification::BINARY: {
-        // Check if we can calculate binary
-        bool has_vals = true;
-        if (!LETTER_PTR_HAS_VALUE(top->children[0])) {
-          node_stack.push(top->children[0].get());
-          has_vals = false;
-        }
-        if (!LETTER_PTR_HAS_VALUE(top->children[1])) {
-          if (top->children[1] == nullptr) {
+    const auto& node = nodes_[i];
+    Error error = picolator::math::capture([&] {
+      switch (node.value->getClassification()) {
+        case Letter::Classification::LITERAL: {
+          const auto& literal = reinterpret_cast<const Literals&>(*node.value);
+          if (!isReference(literal)) folded[i].emplace(literal);
+        } break;
+        case Letter::Classification::BINARY:
+          if (folded[node.children[0]] && folded[node.children[1]]) {
+            folded[i].emplace(BinaryOperator::solve(
+                static_cast<BinaryOperator::Type>(opType(*node.value)),
+                *folded[node.children[0]], *folded[node.children[1]]));
           }
-          node_stack.push(top->children[1].get());
-          has_vals = false;
-        }
+          break;
+        case Letter::Classification::UNARY:
+          if (folded[node.children[0]]) {
+            folded[i].emplace(UnaryOperator::solve(
+                static_cast<UnaryOperator::Type>(opType(*node.value)),
+                *folded[node.children[0]]));
+          }
+          break;
+        default:
+          break;
+      }
+    });
+    if (error) {
+      // Leave it unfolded so the error is raised when the program is run
+      // just like it would be without folding
+      folded[i].reset();
+    }
+  }
 
-        if (has_vals) {
-          auto& binary_op = reinterpret_cast<BinaryOperator&>(*(top->value));
-          top->current_value = std::make_shared<Literals>(
-              binary_op.solve(*top->children[0]->current_value,
-                              *top->children[1]->current_value));
-        }
-      } break;
-      case Letter::Classification::UNARY:
-        // Check if we can calculate binary
-        if (!LETTER_PTR_HAS_VALUE(top->children[0])) {
-          node_stack.push(top->children[0].get());
-        } else {
-          auto& unary_op = reinterpret_cast<UnaryOperator&>(*(top->value));
-          top->current_value = std::make_shared<Literals>(
-              Literals(unary_op.solve(*top->children[0]->current_value)));
+  // Find the nodes still needed, children of folded nodes are not. Parents
+  // come after their children so walk the arena backwards
+  std::vector<bool> needed(nodes_.size(), false);
+  needed[root_] = true;
+  for (size_t i = nodes_.size(); i-- > 0;) {
+    if (!needed[i] || folded[i]) continue;
+    for (auto child : nodes_[i].children) {
+      if (child != NO_NODE) needed[child] = true;
+    }
+  }
+
+  auto hashNode = [](const ExprTreeNode& node) {
+    size_t hash = static_cast<size_t>(node.value->getClassification());
+    if (node.value->getClassification() == Letter::Classification::LITERAL) {
+      const auto& literal = reinterpret_cast<const Literals&>(*node.value);
+      hash = hash * 31 + static_cast<size_t>(literal.getTokenType());
+      hash = hash * 31 + (isReference(literal)
+                              ? literal.getVariableName()
+                              : std::hash<double>()(literal.getValue()));
+    } else {
+      hash = hash * 31 + opType(*node.value);
+      hash = hash * 31 + node.children[0];
+      hash = hash * 31 + node.children[1];
+    }
+    return hash;
+  };
+  auto sameNode = [](const ExprTreeNode& lhs, const ExprTreeNode& rhs) {
+    if (lhs.value->getClassification() != rhs.value->getClassification()) {
+      return false;
+    }
+    if (lhs.value->getClassification() == Letter::Classification::LITERAL) {
+      return sameLiteral(reinterpret_cast<const Literals&>(*lhs.value),
+                         reinterpret_cast<const Literals&>(*rhs.value));
+    }
+    return opType(*lhs.value) == opType(*rhs.value) &&
+           lhs.children[0] == rhs.children[0] &&
+           lhs.children[1] == rhs.children[1];
+  };
+
+  // Common subexpression elimination, copy the needed nodes into the dag in
+  // order reusing any node that is identical to one already added
+  std::vector<NodeIndex> remap(nodes_.size(), NO_NODE);
+  std::unordered_multimap<size_t, NodeIndex> seen;
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    if (!needed[i]) continue;
+
+    ExprTreeNode node;
+    bool is_literal = nodes_[i].value->getClassification() ==
+                      Letter::Classification::LITERAL;
+    if (folded[i] && !is_literal) {
+      node.value = LetterPtr(new Literals(*folded[i]));
+    } else {
+      node.value = nodes_[i].value;
+      for (int c = 0; c < 2; c++) {
+        if (nodes_[i].children[c] != NO_NODE) {
+          node.children[c] = remap[nodes_[i].children[c]];
         }
+      }
+    }
+
+    size_t hash = hashNode(node);
+    auto range = seen.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++) {
+      if (sameNode(dag[it->second], node)) {
+        remap[i] = it->second;
         break;
+      }
+    }
+    if (remap[i] == NO_NODE) {
+      dag.emplace_back(std::move(node));
+      remap[i] = static_cast<NodeIndex>(dag.size() - 1);
+      seen.emplace(hash, remap[i]);
+    }
+  }
+  return remap[root_];
+}
+
+// Adds the instruction for a single node, its children must already be on the
+// stack
+static void compileNode(Program& program, const Letter& letter) {
+  switch (letter.getClassification()) {
+    case Letter::Classification::LITERAL: {
+      const auto& literal = reinterpret_cast<const Literals&>(letter);
+      if (literal.getTokenType() == Literals::Type::VARIABLE) {
+        program.loadVariable(literal.getVariableName());
+      } else if (literal.getTokenType() == Literals::Type::ANS) {
+        program.loadAns();
+      } else {
+        program.pushLiteral(literal);
+      }
+    } break;
+    case Letter::Classification::BINARY:
+      program.binary(static_cast<BinaryOperator::Type>(opType(letter)));
+      break;
+    case Letter::Classification::UNARY:
+      program.unary(static_cast<UnaryOperator::Type>(opType(letter)));
+      break;
+    default:
+      picolator::math::raise(Error::syntax("", 0));
+      break;
+  }
+}
+
+Program ExprTree::compile(Program::Mode mode,
+                          const EvalEnvironment& env) const {
+  Program program;
+  std::vector<ExprTreeNode> dag;
+  NodeIndex root = optimize(dag, mode == Program::Mode::EXACT, env);
+  if (root == NO_NODE) {
+    return program;
+  }
+
+  // Nodes used by more then one parent get solved once and saved in a temp
+  std::vector<int> uses(dag.size(), 0);
+  for (const auto& node : dag) {
+    for (auto child : node.children) {
+      if (child != NO_NODE) uses[child]++;
+    }
+  }
+  std::vector<int> slots(dag.size(), -1);
+
+  // Post order walk of the dag with an explicit stack, the bool is true once
+  // the node's children have been pushed
+  std::vector<std::pair<NodeIndex, bool>> stack = {{root, false}};
+  while (!stack.empty()) {
+    auto [idx, expanded] = stack.back();
+    stack.pop_back();
+    const auto& node = dag[idx];
+
+    if (slots[idx] != -1) {
+      program.loadTemp(slots[idx]);
+      continue;
+    }
+    if (!expanded && node.children[0] != NO_NODE) {
+      stack.emplace_back(idx, true);
+      // rhs goes on first so the lhs gets compiled first
+      if (node.children[1] != NO_NODE) {
+        stack.emplace_back(node.children[1], false);
+      }
+      stack.emplace_back(node.children[0], false);
+      continue;
+    }
+
+    compileNode(program, *node.value);
+    if (picolator::math::hasError()) return Program();
+    if (uses[idx] > 1) {
+      slots[idx] = program.storeTemp();
     }
   }
-  return LiteralPtr(new Literals(LETTER_PTR_GET_VALUE(root_).reduce()));
+  return program;
 }
 
 void ExprTree::print() {
@@ -109,19 +358,19 @@ void ExprTree::print() {
   printf("Not impled\n");
 }
 
-int ExprTree::countLeafs(
-    const std::unique_ptr<ExprTreeNode>& start_node) const {
+int ExprTree::countLeafs(NodeIndex start_node) const {
   int count = 0;
 
-  if (start_node) {
-    std::queue<const ExprTreeNode*> node_stack;
-    node_stack.push(start_node.get());
+  if (start_node != NO_NODE) {
+    std::queue<NodeIndex> node_stack;
+    node_stack.push(start_node);
     while (!node_stack.empty()) {
-      if (node_stack.front()->children.empty()) {
+      const auto& node = nodes_[node_stack.front()];
+      if (node.children[0] == NO_NODE) {
         count++;
       } else {
-        for (const auto& node : node_stack.front()->children) {
-          node_stack.push(node.get());
+        for (auto child : node.children) {
+          if (child != NO_NODE) node_stack.push(child);
         }
       }
       node_stack.pop();
@@ -131,180 +380,149 @@ int ExprTree::countLeafs(
   return count;
 }
 
-// Init tree putting all literals into 1 object and grouping brackets into 1
-// Letter
-ExprTree::ExprVec ExprTree::minimizeTreeInput(const ExprTree::ExprVec& expr) {
-  ExprVec minimized_literal_input;
-
-  // copy the current vector input into our minimized_literal_input chopping off
-  // any literals where we can
-  std::string cur_literal = "";
-  bool has_decimal = false;
-  for (const auto& l : expr) {
-    if (l->getClassification() != Letter::Classification::LITERAL_PIECE) {
-      if (!cur_literal.empty()) {
-        if (has_decimal) {
-          minimized_literal_input.emplace_back(
-              new Literals(std::stod(cur_literal)));
-        } else {
-          minimized_literal_input.emplace_back(
-              new Literals(std::stol(cur_literal)));
-        }
-        cur_literal = "";
-        has_decimal = false;
-        if (l->getClassification() == Letter::Classification::BRACKET &&
-                reinterpret_cast<const Bracket&>(*l).getType() ==
-                    Bracket::Type::OPEN ||
-            l->getClassification() == Letter::Classification::LITERAL) {
-          // add a mult symbol
-          minimized_literal_input.emplace_back(
-              new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION));
-        }
-      }
-      if (l->getClassification() == Letter::Classification::BINARY &&
-          reinterpret_cast<const BinaryOperator&>(*l).getType() ==
-              BinaryOperator::Type::SUBTRACTION) {
-        minimized_literal_input.emplace_back(
-            new BinaryOperator("+", BinaryOperator::Type::ADDITION));
-        minimized_literal_input.emplace_back(
-            new UnaryOperator("-", UnaryOperator::Type::MINUS));
-      } else {
-        minimized_literal_input.push_back(l);
-      }
-    } else {
-      const auto& lit = reinterpret_cast<const LiteralsPiece&>(*l);
-      if (lit.value_ == '.') {
-        has_decimal = true;
-      }
-      cur_literal += static_cast<char>(lit.value_);
-    }
-  }
-  if (cur_literal != "") {
-    if (has_decimal) {
-      minimized_literal_input.emplace_back(
-          new Literals(std::stod(cur_literal)));
-    } else {
-      minimized_literal_input.emplace_back(
-          new Literals(std::stol(cur_literal)));
-    }
+// Init tree putting all literals into 1 object
+template <typename Letters>
+ExprTree::ExprVec ExprTree::minimizeTreeInput(const Letters& expr) {
+  // copy the current vector input into our tokenizer chopping off any literals
+  // where we can
+  Tokenizer tokenizer;
+  for (size_t i = 0; i < expr.size(); i++) {
+    tokenizer.add(expr, i);
   }
+  tokenizer.finish(expr);
 
-  // go through the minimized input again but getting rid of brackets
-  ExprVec minimized_input;
-  std::stack<ExprVec> bracket_stack;
-
-  for (const auto& l : minimized_literal_input) {
-    if (l->getClassification() == Letter ::Classification::BRACKET &&
-        reinterpret_cast<const Bracket&>(*l).getType() !=
-            Bracket::Type::EQUATION) {
-      if (reinterpret_cast<const Bracket&>(*l).getType() ==
-          Bracket::Type::OPEN) {
-        bracket_stack.emplace(ExprVec());
-      } else {
-        if (bracket_stack.top().empty()) {
-          throw SyntaxError("Empty Bracket", 0);
-        }
-        if (bracket_stack.size() == 1) {
-          minimized_input.emplace_back(
-              LetterPtr(new Bracket(std::move(bracket_stack.top()))));
-          bracket_stack.pop();
-        } else {
-          Bracket* brack = new Bracket(std::move(bracket_stack.top()));
-          bracket_stack.pop();
-          bracket_stack.top().emplace_back(std::move(brack));
-        }
-      }
-    } else {
-      if (bracket_stack.empty()) {
-        minimized_input.push_back(l);
-      } else {
-        bracket_stack.top().push_back(l);
-      }
-    }
-  }
-
-  if (bracket_stack.size() == 1) {
-    if (bracket_stack.top().empty()) {
-      throw SyntaxError("Empty Bracket", 0);
-    }
-    minimized_input.emplace_back(
-        LetterPtr(new Bracket(std::move(bracket_stack.top()))));
-  }
+  return tokenizer.getTokens();
+}
 
-  if (bracket_stack.size() > 2) {
-    throw SyntaxError("", 0);
+ExprTree::NodeIndex ExprTree::createTree(const ExprVec& tokens,
+                                         size_t max_depth) {
+  if (tokens.empty()) {
+    return NO_NODE;  // no expresion to parse
   }
 
-  return minimized_input;
-}
+  // Every letter other then a bracket ends up as exactly one node so the arena
+  // only needs to be allocated once
+  nodes_.reserve(std::count_if(tokens.begin(), tokens.end(),
+                               [](const LetterPtr& l) {
+                                 return l->getClassification() !=
+                                        Letter::Classification::BRACKET;
+                               }));
 
-ExprTree::ExprTreeNodePtr ExprTree::createTree(const ExprTree::ExprVec& expr) {
-  if (expr.empty()) {
-    return nullptr;  // no expresion to parse
-  }
+  // An operator still waiting on its operands, or an open bracket. A binary
+  // op coming in with a priority >= bound gets this one solved first
+  struct PendingOp {
+    uint32_t pos;
+    uint8_t bound;
+    bool bracket;
+  };
+  std::vector<PendingOp> ops;
+  std::vector<NodeIndex> operands;
 
-  if (expr.size() == 1) {
-    if (expr[0]->getClassification() == Letter::Classification::LITERAL) {
-      ExprTreeNodePtr node(new ExprTreeNode);
-      node->value = expr[0];
-      node->current_value =
-          std::make_shared<Literals>(reinterpret_cast<Literals&>(*expr[0]));
-      return node;
-    } else if (expr[0]->getClassification() ==
-               Letter::Classification::BRACKET) {
-      return createTree(reinterpret_cast<Bracket&>(*(expr[0])).letters_);
+  // Pops the top op and its operands into a new node
+  auto reduce = [&] {
+    const LetterPtr& op = tokens[ops.back().pos];
+    ops.pop_back();
+    NodeIndex rhs = operands.back();
+    operands.pop_back();
+    if (op->getClassification() == Letter::Classification::UNARY) {
+      operands.push_back(addNode(op, rhs));
+    } else {
+      operands.back() = addNode(op, operands.back(), rhs);
     }
-  }
-
-  // Find the letter with the highest priority then split the tree
-  // into 2 vecs one with before it and one after
-  auto op_it = std::max_element(expr.begin(), expr.end(),
-                                [](const LetterPtr& l1, const LetterPtr& l2) {
-                                  return l1->getPriority() < l2->getPriority();
-                                });
-  size_t op_pos = std::distance(expr.begin(), op_it);
+  };
+  // Solves the ops back to the last open bracket that bind tighter then
+  // priority
+  auto reduceFor = [&](uint8_t priority) {
+    while (!ops.empty() && !ops.back().bracket &&
+           priority >= ops.back().bound) {
+      reduce();
+    }
+  };
+  auto push = [&](size_t pos, uint8_t bound, bool bracket) {
+    if (ops.size() >= max_depth) {
+      raise(Error::syntax("Too Deep", pos));
+      return false;
+    }
+    ops.push_back({static_cast<uint32_t>(pos), bound, bracket});
+    return true;
+  };
 
-  if (expr[op_pos]->getClassification() == Letter::Classification::BINARY) {
-    ExprVec lhs;
+  bool want_operand = true;
+  for (size_t pos = 0; pos < tokens.size(); pos++) {
+    const Letter& letter = *tokens[pos];
+    bool is_bracket =
+        letter.getClassification() == Letter::Classification::BRACKET;
+    bool is_open = is_bracket && reinterpret_cast<const Bracket&>(letter)
+                                         .getType() == Bracket::Type::OPEN;
 
-    if (op_pos == 0 || op_pos == expr.size() - 1) {
-      throw picolator::math::SyntaxError("", 0);
+    if (want_operand) {
+      switch (letter.getClassification()) {
+        case Letter::Classification::LITERAL:
+          operands.push_back(addNode(tokens[pos]));
+          want_operand = false;
+          continue;
+        case Letter::Classification::UNARY:
+          // Unary ops only grab the operand directly after them so -2^2 is
+          // (-2)^2
+          if (!push(pos, letter.getPriority(), false)) return NO_NODE;
+          continue;
+        default:
+          if (is_open) {
+            if (!push(pos, 0, true)) return NO_NODE;
+            continue;
+          }
+          // Binary op with no lhs ie "*2", "()" or something that can't be
+          // solved
+          raise(Error::syntax(
+              (is_bracket && !ops.empty() && ops.back().bracket)
+                  ? "Empty Bracket"
+                  : "",
+              pos));
+          return NO_NODE;
+      }
     }
 
-    for (auto it = expr.begin(); it < op_it; it++) {
-      lhs.push_back(*it);
-    }
-    ExprVec rhs;  // std::copy doesn't seem to work
-    for (auto it = op_it + 1; it < expr.end(); it++) {
-      rhs.push_back(*it);
+    if (letter.getClassification() == Letter::Classification::BINARY) {
+      reduceFor(letter.getPriority());
+      // Exponents are right associative (2^3^2 == 2^9) so an equal priority
+      // op waits for them, everything else is left associative
+      uint8_t bound = letter.getPriority();
+      auto type = reinterpret_cast<const BinaryOperator&>(letter).getType();
+      if (type == BinaryOperator::Type::EXPONENT ||
+          type == BinaryOperator::Type::N_TH_ROOT) {
+        bound++;
+      }
+      if (!push(pos, bound, false)) return NO_NODE;
+      want_operand = true;
+    } else if (is_bracket && !is_open) {
+      reduceFor(UINT8_MAX);
+      if (ops.empty()) {
+        raise(Error::syntax("", pos));  // Close without an open
+        return NO_NODE;
+      }
+      ops.pop_back();
+    } else {
+      // Two operands next to each other without an operator ie "2 sin(3)"
+      raise(Error::syntax("", pos));
+      return NO_NODE;
     }
+  }
 
-    // get nodes
-    ExprTreeNodePtr node(new ExprTreeNode);
-    node->children.emplace_back(createTree(lhs));
-    node->children.emplace_back(createTree(rhs));
-    node->value = *op_it;
-    return node;
-  } else if (expr[op_pos]->getClassification() ==
-             Letter::Classification::UNARY) {
-    if (op_pos != 0 || expr.size() == 1) {
-      throw picolator::math::SyntaxError("", 0);
-    } else {
-      ExprVec rhs;
-      for (auto it = op_it + 1; it < expr.end(); it++) {
-        rhs.push_back(*it);
-      }
+  // An operator with nothing after it ie "2+"
+  if (want_operand) {
+    raise(Error::syntax(
+        (!ops.empty() && ops.back().bracket) ? "Empty Bracket" : "",
+        tokens.size()));
+    return NO_NODE;
+  }
 
-      ExprTreeNodePtr node(new ExprTreeNode);
-      node->children.emplace_back(createTree(rhs));
-      node->value = *op_it;
-      return node;
+  // Brackets left open are closed at the end
+  while (!ops.empty()) {
+    if (ops.back().bracket) {
+      ops.pop_back();
+    } else {
+      reduce();
     }
-  } else if (expr[op_pos]->getClassification() ==
-             Letter::Classification::BRACKET) {
-    const Bracket& brack = reinterpret_cast<const Bracket&>(**op_it);
-    return createTree(brack.letters_);
-  } else {  // invalid op not sure what I should do here
-    throw std::exception();
   }
+  return operands.back();
 }
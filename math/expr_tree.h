@@ -9,14 +9,25 @@
  * @author: qawse3dr a.k.a Larry Milne
  */
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "error.h"
+#include "eval_environment.h"
 #include "letter.h"
 #include "literals.h"
+#include "program.h"
+
+// Can be set from the build, each level costs 8 bytes of heap while parsing
+#ifndef PICOLATOR_MAX_DEPTH
+#define PICOLATOR_MAX_DEPTH 256
+#endif
 
 namespace picolator::math {
 
+class Equation;
+
 class ExprTree {
  public:
   using LetterPtr = std::shared_ptr<Letter>;
@@ -25,33 +36,155 @@ class ExprTree {
   using ExprVec = std::vector<LetterPtr>;
 
  private:
+  // Index of a node in the tree's node arena
+  using NodeIndex = uint32_t;
+  static constexpr NodeIndex NO_NODE = UINT32_MAX;
+
   struct ExprTreeNode {
-    std::vector<std::unique_ptr<ExprTreeNode>> children;
     LetterPtr value;
-    LiteralPtr current_value = nullptr;
+    // Unary ops only use the first child and literals use neither
+    NodeIndex children[2] = {NO_NODE, NO_NODE};
   };
-  using ExprTreeNodePtr = std::unique_ptr<ExprTreeNode>;
 
-  ExprTreeNodePtr root_ = {};
+  // Holds every node in the tree in one block of memory. Children are always
+  // added before their parents so the tree can be solved front to back
+  std::vector<ExprTreeNode> nodes_ = {};
+  NodeIndex root_ = NO_NODE;
+
+  // The tree lowered into instructions, built once when the tree is created
+  Program program_ = {};
+  // What program_ was compiled for, only EXACT has its constants folded
+  Program::Mode mode_ = Program::Mode::EXACT;
+
+  // Adds a node to the end of the arena and returns its index
+  NodeIndex addNode(const LetterPtr& value, NodeIndex lhs = NO_NODE,
+                    NodeIndex rhs = NO_NODE);
+
+  /**
+   * @brief Optimizes the tree before it gets compiled. Subtrees that don't use
+   * a VARIABLE or ANS are solved ahead of time and identical subtrees are
+   * merged so they only get solved once
+   *
+   * @param dag filled with the optimized nodes, a node can have more then one
+   * parent
+   * @param fold solve the constant subtrees, they are solved with exact math
+   * so only do it for Program::Mode::EXACT
+   * @param env only its cancel flag is used, checked before each fold
+   * @return NodeIndex root of the dag
+   */
+  NodeIndex optimize(std::vector<ExprTreeNode>& dag, bool fold,
+                     const EvalEnvironment& env) const;
+
+  // Parses and compiles for mode, what the static evaluates use
+  template <typename Letters>
+  static Result<LiteralPtr> evaluateLetters(const Letters& equation,
+                                            Program::Mode mode,
+                                            const EvalEnvironment& env);
 
   // Helper for print function simply counts how many leaf nodes
   // there are so printing can be done easier
-  int countLeafs(const std::unique_ptr<ExprTreeNode>& start_node) const;
+  int countLeafs(NodeIndex start_node) const;
 
-  // takes in a current expanded tree input and minimize it's literals and
-  // brackets to make solving easier
-  ExprVec minimizeTreeInput(const ExprVec& expr);
-  ExprTreeNodePtr createTree(const ExprVec& expr);
+  // takes in a current expanded tree input and minimize it's literals to
+  // make solving easier. Letters is an ExprVec or an Equation
+  template <typename Letters>
+  static ExprVec minimizeTreeInput(const Letters& expr);
+
+  /**
+   * @brief Operator precedence (shunting yard) parser.
+   * Pending operators and brackets go on a vector instead of the call stack so
+   * deep nesting can't overflow the pico's small stack
+   *
+   * @param tokens output of the Tokenizer, brackets are still separate
+   * letters
+   * @param max_depth most brackets and operators that can be waiting at once,
+   * more gives a "Too Deep" syntax error
+   * @return NodeIndex root of the tree, NO_NODE if tokens is empty
+   */
+  NodeIndex createTree(const ExprVec& tokens, size_t max_depth);
+
+  ExprTree() = default;
 
  public:
-  ExprTree(const ExprVec& expr);
+  // Default for how deep an equation can nest. The parser and the program
+  // both keep their stacks on the heap so this only bounds memory use
+  static constexpr size_t MAX_DEPTH = PICOLATOR_MAX_DEPTH;
+
+  ExprTree(const ExprVec& expr, size_t max_depth = MAX_DEPTH);
+  ExprTree(const Equation& expr, size_t max_depth = MAX_DEPTH);
 
   /**
-   * @brief Get the float value of the tree
+   * @brief Creates a tree from input that has already been through the
+   * Tokenizer
    *
-   * @return float
+   * @param tokens Tokenizer::getTokens()
+   * @param env only its cancel flag is used, see compile
    */
-  LiteralPtr getValue();
+  static ExprTree fromTokens(
+      const ExprVec& tokens, size_t max_depth = MAX_DEPTH,
+      const EvalEnvironment& env = EvalEnvironment::empty());
+
+  /**
+   * @brief Solves the tree, can be called more then once
+   *
+   * @param env values of ANS and the variables, only read
+   * @return LiteralPtr reduced value of the tree
+   */
+  LiteralPtr getValue(
+      const EvalEnvironment& env = EvalEnvironment::empty()) const;
+
+  /**
+   * @brief Solves the tree with the given precision
+   *
+   * @param mode Program::Mode::EXACT is the same as getValue()
+   * @return LiteralPtr reduced value of the tree
+   */
+  LiteralPtr getValue(
+      Program::Mode mode,
+      const EvalEnvironment& env = EvalEnvironment::empty()) const;
+
+  /**
+   * @brief getValue that hands back the error instead of throwing it
+   *
+   * @return Result<LiteralPtr> reduced value of the tree or what went wrong
+   */
+  Result<LiteralPtr> evaluate(
+      Program::Mode mode = Program::Mode::EXACT,
+      const EvalEnvironment& env = EvalEnvironment::empty()) const;
+
+  /**
+   * @brief Builds and solves an equation without throwing, works the same
+   * with or without exceptions
+   *
+   * @param equation same input the constructor takes
+   * @return Result<LiteralPtr> reduced value, or the error and the token the
+   * parser was on when it happened
+   */
+  static Result<LiteralPtr> evaluate(
+      const ExprVec& equation, Program::Mode mode = Program::Mode::EXACT,
+      const EvalEnvironment& env = EvalEnvironment::empty());
+  static Result<LiteralPtr> evaluate(
+      const Equation& equation, Program::Mode mode = Program::Mode::EXACT,
+      const EvalEnvironment& env = EvalEnvironment::empty());
+
+  /**
+   * @brief Lowers the tree into a postfix program
+   *
+   * @param mode what the program will be run with. Constants are only folded
+   * for EXACT, the other modes have to round and overflow the same way
+   * whether a value is constant or not
+   * @param env only its cancel flag is used, folding can take as long as
+   * running so it stops with a CANCELLED error too
+   * @return Program that solves the tree when ran
+   */
+  Program compile(
+      Program::Mode mode = Program::Mode::EXACT,
+      const EvalEnvironment& env = EvalEnvironment::empty()) const;
+
+  // Compiled version of this tree, run it directly to solve the tree again
+  // with a different EvalEnvironment. It is compiled for EXACT, use
+  // compile(mode) to run it with one of the other modes
+  const Program& getProgram() const { return program_; }
 
   // prints a pretty version of the tree
   void print();
@@ -0,0 +1,313 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "fixed.h"
+
+#include <cmath>
+
+#include "math_util.h"
+
+namespace picolator::math {
+
+static constexpr Fixed PI_FIXED = Fixed::fromRaw(13493037705);
+static constexpr Fixed HALF_PI_FIXED = Fixed::fromRaw(6746518852);
+static constexpr Fixed TWO_PI_FIXED = Fixed::fromRaw(26986075409);
+static constexpr Fixed LN2_FIXED = Fixed::fromRaw(2977044472);
+static constexpr Fixed LOG2E_FIXED = Fixed::fromRaw(6196328019);
+
+// atan(2^-i) for CORDIC
+static constexpr int64_t ATAN_TABLE[] = {
+    3373259426, 1991351318, 1052175346, 534100635, 268086748, 134174063,
+    67103403,   33553749,   16777131,   8388597,   4194303,   2097152,
+    1048576,    524288,     262144,     131072,    65536,     32768,
+    16384,      8192,       4096,       2048,      1024,      512,
+    256,        128,        64,         32,        16,        8,
+    4,          2};
+static constexpr int CORDIC_STEPS = sizeof(ATAN_TABLE) / sizeof(int64_t);
+// 1 / CORDIC gain, starting x at this makes the result unscaled
+static constexpr int64_t CORDIC_K = 2608131496;
+
+static inline uint64_t magnitude(int64_t i) {
+  return (i < 0) ? 0 - static_cast<uint64_t>(i) : i;
+}
+
+// Sets the sign on a magnitude, saturating if it doesn't fit
+static Fixed withSign(uint64_t mag, bool negative) {
+  constexpr uint64_t max = std::numeric_limits<int64_t>::max();
+  if (mag > max) return negative ? Fixed::min() : Fixed::max();
+  int64_t raw = static_cast<int64_t>(mag);
+  return Fixed::fromRaw(negative ? -raw : raw);
+}
+
+Fixed::Fixed(double d) {
+  constexpr double limit = 2147483648.0;
+  if (std::isnan(d)) {
+    raw_ = 0;
+  } else if (d >= limit) {
+    raw_ = max().raw_;
+  } else if (d <= -limit) {
+    raw_ = min().raw_;
+  } else {
+    raw_ = std::llround(d * ONE);
+  }
+}
+
+Fixed::operator double() const { return static_cast<double>(raw_) / ONE; }
+
+// No int128 on the pico so the 128 bit product is done in 32 bit halves
+Fixed operator*(Fixed lhs, Fixed rhs) {
+  uint64_t a = magnitude(lhs.raw_), b = magnitude(rhs.raw_);
+  uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+  uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+
+  uint64_t low = a_lo * b_lo;
+  uint64_t mid1 = a_lo * b_hi;
+  uint64_t mid2 = a_hi * b_lo;
+  uint64_t mid = (low >> 32) + (mid1 & 0xFFFFFFFF) + (mid2 & 0xFFFFFFFF);
+  uint64_t hi = a_hi * b_hi + (mid1 >> 32) + (mid2 >> 32) + (mid >> 32);
+  uint64_t lo = (mid << 32) | (low & 0xFFFFFFFF);
+
+  bool negative = (lhs.raw_ < 0) != (rhs.raw_ < 0);
+  if (hi >> 32) return negative ? Fixed::min() : Fixed::max();
+  // Round to nearest using the first bit that gets shifted out
+  uint64_t res = (hi << 32) | (lo >> 32);
+  if ((lo >> 31) & 1) res++;
+  return withSign(res, negative);
+}
+
+// Shift and subtract division of lhs * 2^32 by rhs
+Fixed operator/(Fixed lhs, Fixed rhs) {
+  if (rhs.raw_ == 0) {
+    raise(Error::divideByZero());
+    return Fixed();
+  }
+  uint64_t a = magnitude(lhs.raw_), b = magnitude(rhs.raw_);
+  bool negative = (lhs.raw_ < 0) != (rhs.raw_ < 0);
+
+  uint64_t rem = 0, quot = 0;
+  for (int i = 63 + Fixed::FRAC_BITS; i >= 0; i--) {
+    if (quot >> 63) return negative ? Fixed::min() : Fixed::max();
+    bool carry = rem >> 63;
+    uint64_t bit = (i >= Fixed::FRAC_BITS) ? (a >> (i - Fixed::FRAC_BITS)) & 1
+                                           : 0;
+    rem = (rem << 1) | bit;
+    quot <<= 1;
+    if (carry || rem >= b) {
+      rem -= b;
+      quot |= 1;
+    }
+  }
+  return withSign(quot, negative);
+}
+
+/**
+ * @brief Rotates (K, 0) by angle with CORDIC
+ *
+ * @param angle between -pi/2 and pi/2
+ */
+static void cordicRotate(int64_t angle, int64_t& cos, int64_t& sin) {
+  int64_t x = CORDIC_K, y = 0, z = angle;
+  for (int i = 0; i < CORDIC_STEPS; i++) {
+    int64_t x_shift = x >> i, y_shift = y >> i;
+    if (z >= 0) {
+      x -= y_shift;
+      y += x_shift;
+      z -= ATAN_TABLE[i];
+    } else {
+      x += y_shift;
+      y -= x_shift;
+      z += ATAN_TABLE[i];
+    }
+  }
+  cos = x;
+  sin = y;
+}
+
+// cos and sin of any angle
+static void sinCos(Fixed x, Fixed& cos, Fixed& sin) {
+  x = fmod(x, TWO_PI_FIXED);
+  if (x > PI_FIXED) x = x - TWO_PI_FIXED;
+  if (x < -PI_FIXED) x = x + TWO_PI_FIXED;
+
+  // Mirror into -pi/2..pi/2, sin stays the same and cos flips
+  bool flip = false;
+  if (x > HALF_PI_FIXED) {
+    x = PI_FIXED - x;
+    flip = true;
+  } else if (x < -HALF_PI_FIXED) {
+    x = -PI_FIXED - x;
+    flip = true;
+  }
+
+  int64_t c, s;
+  cordicRotate(x.raw(), c, s);
+  cos = Fixed::fromRaw(flip ? -c : c);
+  sin = Fixed::fromRaw(s);
+}
+
+Fixed sin(Fixed x) {
+  Fixed c, s;
+  sinCos(x, c, s);
+  return s;
+}
+
+Fixed cos(Fixed x) {
+  Fixed c, s;
+  sinCos(x, c, s);
+  return c;
+}
+
+Fixed tan(Fixed x) {
+  Fixed c, s;
+  sinCos(x, c, s);
+  return s / c;
+}
+
+Fixed atan(Fixed x) {
+  // Vectoring only converges for small y so atan(x) = pi/2 - atan(1/x)
+  if (x > Fixed(1)) return HALF_PI_FIXED - atan(Fixed(1) / x);
+  if (x < Fixed(-1)) return -HALF_PI_FIXED - atan(Fixed(1) / x);
+
+  int64_t vx = Fixed::ONE, vy = x.raw(), z = 0;
+  for (int i = 0; i < CORDIC_STEPS; i++) {
+    int64_t x_shift = vx >> i, y_shift = vy >> i;
+    if (vy > 0) {
+      vx += y_shift;
+      vy -= x_shift;
+      z += ATAN_TABLE[i];
+    } else {
+      vx -= y_shift;
+      vy += x_shift;
+      z -= ATAN_TABLE[i];
+    }
+  }
+  return Fixed::fromRaw(z);
+}
+
+Fixed asin(Fixed x) {
+  if (x > Fixed(1) || x < Fixed(-1)) {
+    raise(Error::domain("asin"));
+    return Fixed();
+  }
+  if (x == Fixed(1)) return HALF_PI_FIXED;
+  if (x == Fixed(-1)) return -HALF_PI_FIXED;
+  return atan(x / sqrt(Fixed(1) - x * x));
+}
+
+Fixed acos(Fixed x) {
+  if (x > Fixed(1) || x < Fixed(-1)) {
+    raise(Error::domain("acos"));
+    return Fixed();
+  }
+  return HALF_PI_FIXED - asin(x);
+}
+
+Fixed sqrt(Fixed x) {
+  if (x < Fixed()) {
+    raise(Error::domain("sqrt"));
+    return Fixed();
+  }
+  if (x == Fixed()) return x;
+
+  // Integer sqrt of the raw value is sqrt(x) * 2^16, Newton fixes the rest
+  uint64_t raw = x.raw(), root = 0;
+  for (uint64_t bit = uint64_t{1} << 62; bit != 0; bit >>= 2) {
+    if (raw >= root + bit) {
+      raw -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+  }
+  Fixed y = Fixed::fromRaw(static_cast<int64_t>(root) << 16);
+  for (int i = 0; i < 3; i++) {
+    y = Fixed::fromRaw((y + x / y).raw() / 2);
+  }
+  return y;
+}
+
+// log2 one bit at a time, m^2 >= 2 means the next bit is set
+Fixed log(Fixed x) {
+  if (x <= Fixed()) {
+    raise(Error::domain("ln"));
+    return Fixed();
+  }
+
+  int msb = 63 - __builtin_clzll(static_cast<uint64_t>(x.raw()));
+  int k = msb - Fixed::FRAC_BITS;
+  Fixed m = Fixed::fromRaw((k >= 0) ? x.raw() >> k : x.raw() << -k);
+
+  int64_t frac = 0;
+  for (int i = 1; i <= Fixed::FRAC_BITS; i++) {
+    m = m * m;
+    if (m >= Fixed(2)) {
+      m = Fixed::fromRaw(m.raw() >> 1);
+      frac |= int64_t{1} << (Fixed::FRAC_BITS - i);
+    }
+  }
+  return Fixed::fromRaw(k * Fixed::ONE + frac) * LN2_FIXED;
+}
+
+// e^x = 2^k * e^r with r < ln2 so the series converges fast
+Fixed exp(Fixed x) {
+  if (x > Fixed(21)) return Fixed::max();
+  if (x < Fixed(-23)) return Fixed();
+
+  Fixed t = x * LOG2E_FIXED;
+  int32_t k = t.floor();
+  Fixed r = (t - Fixed(k)) * LN2_FIXED;
+
+  Fixed sum = Fixed(1), term = Fixed(1);
+  for (int n = 1; term != Fixed(); n++) {
+    term = term * r / Fixed(n);
+    sum = sum + term;
+  }
+  if (k >= 0) {
+    if (sum.raw() > (std::numeric_limits<int64_t>::max() >> k)) {
+      return Fixed::max();
+    }
+    return Fixed::fromRaw(sum.raw() << k);
+  }
+  return Fixed::fromRaw(sum.raw() >> -k);
+}
+
+Fixed pow(Fixed base, Fixed exponent) {
+  // Whole powers by squaring so negative bases work
+  if ((exponent.raw() & (Fixed::ONE - 1)) == 0) {
+    uint64_t n = magnitude(exponent.floor());
+    Fixed res = Fixed(1), square = base;
+    while (n) {
+      if (n & 1) res = res * square;
+      n >>= 1;
+      if (n) square = square * square;
+    }
+    return (exponent < Fixed()) ? Fixed(1) / res : res;
+  }
+  if (base == Fixed() && exponent > Fixed()) return Fixed();
+  if (base <= Fixed()) {
+    raise(Error::domain("exp"));
+    return Fixed();
+  }
+  return exp(exponent * log(base));
+}
+
+Fixed fmod(Fixed x, Fixed y) {
+  if (y == Fixed()) {
+    raise(Error::divideByZero());
+    return Fixed();
+  }
+  // INT64_MIN % -1 traps, anything % -1 is 0 anyways
+  if (y.raw() == -1) {
+    return Fixed();
+  }
+  return Fixed::fromRaw(x.raw() % y.raw());
+}
+
+}  // namespace picolator::math
@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace picolator::math {
+
+/**
+ * @brief Q32.32 fixed point number. Everything is done with integer math so
+ * it doesn't go through soft float on the pico. Results that don't fit
+ * saturate at max() and min() instead of wrapping.
+ */
+class Fixed {
+ public:
+  static constexpr int FRAC_BITS = 32;
+  static constexpr int64_t ONE = int64_t{1} << FRAC_BITS;
+
+ private:
+  int64_t raw_ = 0;
+
+ public:
+  constexpr Fixed() = default;
+  constexpr Fixed(int i) : raw_(static_cast<int64_t>(i) * ONE) {}
+  explicit Fixed(double d);
+
+  static constexpr Fixed fromRaw(int64_t raw) {
+    Fixed f;
+    f.raw_ = raw;
+    return f;
+  }
+  static constexpr Fixed max() {
+    return fromRaw(std::numeric_limits<int64_t>::max());
+  }
+  static constexpr Fixed min() {
+    return fromRaw(std::numeric_limits<int64_t>::min());
+  }
+  // Smallest step, 2^-32
+  static constexpr Fixed epsilon() { return fromRaw(1); }
+
+  constexpr int64_t raw() const { return raw_; }
+  explicit operator double() const;
+  // Rounds towards -inf like >>
+  constexpr int32_t floor() const {
+    return static_cast<int32_t>(raw_ >> FRAC_BITS);
+  }
+
+  friend constexpr Fixed operator+(Fixed lhs, Fixed rhs) {
+    int64_t res = 0;
+    if (__builtin_add_overflow(lhs.raw_, rhs.raw_, &res)) {
+      return (rhs.raw_ > 0) ? max() : min();
+    }
+    return fromRaw(res);
+  }
+  friend constexpr Fixed operator-(Fixed lhs, Fixed rhs) {
+    int64_t res = 0;
+    if (__builtin_sub_overflow(lhs.raw_, rhs.raw_, &res)) {
+      return (rhs.raw_ < 0) ? max() : min();
+    }
+    return fromRaw(res);
+  }
+  friend constexpr Fixed operator-(Fixed f) { return Fixed() - f; }
+  friend Fixed operator*(Fixed lhs, Fixed rhs);
+  // Raises DIVIDE_BY_ZERO
+  friend Fixed operator/(Fixed lhs, Fixed rhs);
+
+  friend constexpr bool operator==(Fixed lhs, Fixed rhs) {
+    return lhs.raw_ == rhs.raw_;
+  }
+  friend constexpr bool operator!=(Fixed lhs, Fixed rhs) {
+    return lhs.raw_ != rhs.raw_;
+  }
+  friend constexpr bool operator<(Fixed lhs, Fixed rhs) {
+    return lhs.raw_ < rhs.raw_;
+  }
+  friend constexpr bool operator>(Fixed lhs, Fixed rhs) {
+    return lhs.raw_ > rhs.raw_;
+  }
+  friend constexpr bool operator<=(Fixed lhs, Fixed rhs) {
+    return lhs.raw_ <= rhs.raw_;
+  }
+  friend constexpr bool operator>=(Fixed lhs, Fixed rhs) {
+    return lhs.raw_ >= rhs.raw_;
+  }
+};
+
+static_assert(std::is_trivially_copyable_v<Fixed>);
+static_assert(sizeof(Fixed) == 8);
+
+// Integer only versions of the math.h functions. Domain errors are raised
+// like the Literals versions
+Fixed sin(Fixed x);
+Fixed cos(Fixed x);
+Fixed tan(Fixed x);
+Fixed asin(Fixed x);
+Fixed acos(Fixed x);
+Fixed atan(Fixed x);
+Fixed sqrt(Fixed x);
+Fixed log(Fixed x);
+Fixed exp(Fixed x);
+Fixed pow(Fixed base, Fixed exp);
+Fixed fmod(Fixed x, Fixed y);
+
+}  // namespace picolator::math
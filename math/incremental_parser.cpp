@@ -0,0 +1,73 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "incremental_parser.h"
+
+#include "error.h"
+
+using picolator::math::Equation;
+using picolator::math::Error;
+using picolator::math::ErrorCode;
+using picolator::math::EvalEnvironment;
+using picolator::math::ExprTree;
+using picolator::math::IncrementalParser;
+
+ExprTree::LiteralPtr IncrementalParser::update(const Equation& equation,
+                                               const EvalEnvironment& env) {
+  // Find the first letter that changed since the last update. Letters are
+  // shared so this compares pointers, the variable tables can differ
+  size_t same = 0;
+  while (same < equation.size() && same < letters_.size() &&
+         equation[same] == letters_[same]) {
+    same++;
+  }
+
+  if (same == equation.size() && same == letters_.size() && !cancelled_) {
+    retokenized_ = 0;
+    return value_;
+  }
+
+  // Go back to before the first changed letter and tokenize from there
+  tokenizer_.restore(states_[same]);
+  states_.resize(same + 1);
+  letters_.truncate(same);
+  retokenized_ = equation.size() - same;
+
+  value_ = nullptr;
+  cancelled_ = false;
+  Error error = capture([&] {
+    for (size_t i = same; i < equation.size(); i++) {
+      letters_.append(equation, i);
+      tokenizer_.add(letters_, i);
+      states_.emplace_back(tokenizer_.getState());
+    }
+    tokenizer_.finish(letters_);
+    ExprTree tree =
+        ExprTree::fromTokens(tokenizer_.getTokens(), ExprTree::MAX_DEPTH, env);
+    if (!hasError()) value_ = tree.getValue(env);
+  });
+  if (error) {
+    // Most of the time the equation just isn't finished yet. Drop any letter
+    // that failed to tokenize so every letter still has a saved state
+    letters_.truncate(states_.size() - 1);
+    value_ = nullptr;
+    cancelled_ = error.code == ErrorCode::CANCELLED;
+  }
+  return value_;
+}
+
+void IncrementalParser::reset() {
+  letters_.clear();
+  states_ = {Tokenizer::State()};
+  tokenizer_.restore(states_[0]);
+  value_ = nullptr;
+  retokenized_ = 0;
+  cancelled_ = false;
+}
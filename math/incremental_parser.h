@@ -0,0 +1,64 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <vector>
+
+#include "equation.h"
+#include "expr_tree.h"
+#include "tokenizer.h"
+
+namespace picolator::math {
+
+/**
+ * @brief Solves the equation while it is being typed for the live preview.
+ * Keeps the tokenizer state from before every letter of the last equation so
+ * after an edit only the letters from the edit onwards get re-tokenized.
+ *
+ * Only tokenizing is incremental, the tree is still built, compiled and
+ * solved from all of the tokens on every change.
+ */
+class IncrementalParser {
+ private:
+  // Equation the saved states belong to
+  Equation letters_ = {};
+  // states_[i] is the tokenizer state before letters_[i] was added, the last
+  // one is the state after every letter
+  std::vector<Tokenizer::State> states_ = {Tokenizer::State()};
+  Tokenizer tokenizer_;
+
+  ExprTree::LiteralPtr value_ = nullptr;
+  size_t retokenized_ = 0;
+  // The last update was cancelled so value_ has to be solved again even if
+  // the equation is the same
+  bool cancelled_ = false;
+
+ public:
+  /**
+   * @brief Updates to a new version of the equation and solves it
+   *
+   * @param equation the equation being typed
+   * @param env values of ANS and the variables, a change to them isn't seen
+   * until the equation changes. Its cancel flag stops the update with a
+   * nullptr value
+   * @return ExprTree::LiteralPtr value of the equation or nullptr if it can't
+   * be solved (ie it ends in a +)
+   */
+  ExprTree::LiteralPtr update(
+      const Equation& equation,
+      const EvalEnvironment& env = EvalEnvironment::empty());
+
+  // Forget the last equation, the next update starts from scratch
+  void reset();
+
+  // How many letters the last update had to tokenize
+  size_t getRetokenized() const { return retokenized_; }
+};
+}  // namespace picolator::math
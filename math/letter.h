@@ -11,6 +11,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace picolator::math {
@@ -45,11 +46,17 @@ class Letter {
 
  public:
   Letter(std::string symbol, Classification c, uint8_t priority)
-      : symbol_(symbol), classification_(c), priority_(priority){};
+      : symbol_(std::move(symbol)), classification_(c), priority_(priority){};
+  Letter(const Letter&) = default;
+  Letter(Letter&&) noexcept = default;
+  Letter& operator=(const Letter&) = default;
+  Letter& operator=(Letter&&) noexcept = default;
+  virtual ~Letter() = default;
 
   const Classification& getClassification() const { return classification_; }
 
-  std::string getSymbol() const { return symbol_; }
+  // What gets drawn on the lcd for this letter
+  virtual std::string getSymbol() const { return symbol_; }
 
   inline int8_t getPriority() const { return priority_; }
 };
@@ -10,12 +10,24 @@
  */
 #include "literals.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <optional>
+#include <utility>
 
 #include "math_util.h"
 
-using picolator::math::Constant;
+using picolator::math::BigInt;
+using picolator::math::BigRational;
+using picolator::math::Complex;
+using picolator::math::Error;
 using picolator::math::Literals;
+using picolator::math::Number;
+using picolator::math::Polynomial;
+
+// Largest power that is worked out exactly, past this ^ gives a double
+static constexpr double MAX_EXACT_POW_BITS = 1 << 14;
 
 std::string typeToString(Literals::Type type) {
   switch (type) {
@@ -25,450 +37,328 @@ std::string typeToString(Literals::Type type) {
       return "e";
     case Literals::Type::ANS:
       return "ANS";
+    case Literals::Type::COMPLEX:
+      return "i";
     default:
       return "X";
   }
 }
+
+static Literals::Type typeOf(const Number& number) {
+  switch (number.kind) {
+    case Number::Kind::LONG:
+      return Literals::Type::LONG;
+    case Number::Kind::DOUBLE:
+      return Literals::Type::DOUBLE;
+    case Number::Kind::FRACTION:
+      return Literals::Type::FRACTION;
+    case Number::Kind::DECIMAL:
+      return Literals::Type::DECIMAL;
+    case Number::Kind::CONSTANT:
+      if (number.e_pow == 0) return Literals::Type::PI;
+      if (number.pi_pow == 0) return Literals::Type::E;
+      return Literals::Type::MONOMIAL;
+    default:
+      return Literals::Type::DOUBLE;
+  }
+}
+
 Literals::Literals(double d)
-    : Letter(std::to_string(d), Letter::Classification::LITERAL, 0),
-      num_(d),
-      type_(Type::DOUBLE) {}
+    : Letter("", Letter::Classification::LITERAL, 0),
+      type_(Type::DOUBLE),
+      number_(Number::fromDouble(d)),
+      value_(d) {}
 Literals::Literals(long l)
-    : Letter(std::to_string(l), Letter::Classification::LITERAL, 0),
-      num_(l),
-      type_(Type::LONG) {}
+    : Letter("", Letter::Classification::LITERAL, 0),
+      type_(Type::LONG),
+      number_(Number::fromLong(l)),
+      value_(l) {}
 Literals::Literals(int l)
-    : Letter(std::to_string(l), Letter::Classification::LITERAL, 0),
-      num_(l),
-      type_(Type::LONG) {}
+    : Letter("", Letter::Classification::LITERAL, 0),
+      type_(Type::LONG),
+      number_(Number::fromLong(l)),
+      value_(l) {}
 Literals::Literals(char c)
     : Letter(std::string(1, c), Letter::Classification::LITERAL, 0),
-      variable_(c),
-      type_(Type::VARIABLE) {}
+      type_(Type::VARIABLE),
+      variable_(c) {}
+
+Literals::Literals(const Number& number)
+    : Letter("", Letter::Classification::LITERAL, 0),
+      type_(typeOf(number)),
+      number_(number),
+      value_(number.getValue()) {}
+
+Literals::Literals(const BigRational& big)
+    : Letter("", Letter::Classification::LITERAL, 0),
+      type_(big.isInteger() ? Type::LONG : Type::FRACTION) {
+  if (big.fitsInt64()) {
+    number_ = Number::fraction(big.numerator().toInt64(),
+                               big.denominator().toInt64());
+  } else {
+    number_ = Number::big();
+    big_ = std::make_shared<const BigRational>(big);
+  }
+  value_ = big.getValue();
+}
 
-static std::unique_ptr<Constant> createConstant(Literals::Type type,
-                                                const Literals& x = 1,
-                                                const Literals& pow = 1) {
-  switch (type) {
-    case Literals::Type::PI:  // valid values
-      return std::unique_ptr<Constant>(new picolator::math::PI(x, pow));
-    case Literals::Type::E:
-      return std::unique_ptr<Constant>(new picolator::math::E(x, pow));
-    default:  // not a const ignore
-      return nullptr;
+Literals::Literals(const Polynomial& poly)
+    : Letter("", Letter::Classification::LITERAL, 0) {
+  if (poly.terms().size() > 1) {
+    type_ = Type::POLYNOMIAL;
+    number_ = Number::big();
+    poly_ = std::make_shared<const Polynomial>(poly);
+  } else {
+    number_ = poly.terms().empty() ? Number::fromLong(0) : poly.terms()[0];
+    type_ = typeOf(number_);
+  }
+  value_ = poly.getValue();
+}
+
+Literals::Literals(const Complex& z)
+    : Letter("", Letter::Classification::LITERAL, 0),
+      type_(Type::COMPLEX),
+      number_(z.re),
+      value_(z.re.getValue()) {
+  if (z.isReal()) {
+    type_ = typeOf(z.re);
+  } else {
+    imag_ = z.im;
   }
 }
 
 Literals::Literals(Type type)
     : Letter(typeToString(type), Letter::Classification::LITERAL, 0),
-      type_(type),
-      constant_(createConstant(type, Literals(1L), Literals(1L))) {
+      type_(type) {
+  if (type == Type::PI || type == Type::E) {
+    number_ = Number::monomial(1, 1, type == Type::PI, type == Type::E);
+    value_ = number_.getValue();
+  } else if (type == Type::COMPLEX) {
+    imag_ = Number::fromLong(1);
+  }
 }  // todo add error checking
 
 Literals::Literals(Type type, const Literals& x, const Literals& pow)
-    : Letter(typeToString(type), Letter::Classification::LITERAL, 0),
-      type_(type),
-      constant_(createConstant(type, x, pow)) {}
+    : Literals(x * (Literals(type) ^ pow)) {}
 
 Literals::Literals(const Literals& numerator, const Literals& denominator)
-    : Letter(numerator.getSymbol() + "/" + denominator.getSymbol(),
-             Letter::Classification::LITERAL, 0),
-      num_(std::move(Fraction(numerator, denominator))),
-      type_(Type::FRACTION) {}
-
-Literals::Literals(const Literals& rhs)
-    : Letter(rhs.getSymbol(), rhs.getClassification(), 0),
-      type_(rhs.type_),
-      variable_(rhs.variable_),
-      constant_(
-          createConstant(rhs.type_, rhs.constant_->x_, rhs.constant_->pow_)) {
-  switch (getType()) {
-    case Type::DOUBLE:
-      num_ = rhs.getDouble();
-      break;
-    case Type::LONG:
-      num_ = rhs.getLong();
-      break;
-    case Type::FRACTION: {
-      Fraction frac(rhs.getFraction());
-      num_.emplace<Fraction>(std::move(frac));
-      break;
-    }
-    default:
-      break;
-  }
-}
-
-Literals Literals::operator=(const Literals& rhs) {
-  // Copies for Letter
-  symbol_ = rhs.symbol_;
-  classification_ = rhs.classification_;
-  priority_ = rhs.priority_;
-
-  // Copies for LiteralS
-  type_ = rhs.type_;
-  variable_ = rhs.variable_;
-  constant_ = createConstant(rhs.type_, rhs.constant_->x_, rhs.constant_->pow_);
-  // copy the data rom variant if needed
-  switch (rhs.getType()) {
-    case Type::DOUBLE:
-      num_ = rhs.getDouble();
-      break;
-    case Type::LONG:
-      num_ = rhs.getLong();
-      break;
-    case Type::FRACTION: {
-      Fraction frac(rhs.getFraction());
-      num_.emplace<Fraction>(std::move(frac));
-      break;
-    }
-    default:
-      break;
-  }
-
-  return *this;
-}
+    : Literals(numerator / denominator) {}
 
-double Literals::getValue() const {
-  switch (getType()) {
-    case Type::DOUBLE:
-      return getDouble();
-    case Type::LONG:
-      return getLong();
-    case Type::FRACTION:
-      return getNumerator().getValue() / getDenominator().getValue();
-    case Type::PI:
-      return constant_->x_.getValue() *
-             pow(PI::value, constant_->pow_.getValue());
-    case Type::E:
-      return constant_->x_.getValue() *
-             pow(E::value, constant_->pow_.getValue());
-    default:
-      throw NotImplementedError(__func__);
-  }
+std::string Literals::getSymbol() const {
+  return symbol_.empty() ? toString() : symbol_;
 }
 
 std::string Literals::toString() const {
-  switch (getType()) {
-    case Type::LONG:
-      return std::to_string(getLong());
-    case Type::FRACTION:
-      return getNumerator().toString() + "/" + getDenominator().toString();
-    case Type::E:
-    case Type::PI: {
-      auto x = constant_->x_.toString();
-      auto p = constant_->pow_.toString();
-      return (x != "1" ? x : "") + getSymbol() +
-             (p != "1" ? "^" + constant_->pow_.toString() : "");
-    }
-    default:
-      return std::to_string(getValue());
-  }
+  if (big_) return big_->toString();
+  if (poly_) return poly_->toString();
+  if (type_ == Type::COMPLEX) return toComplex().toString();
+  return number_.toString();
 }
 
-long Literals::getLong() const {
-  if (getType() != Type::LONG) {
-    throw TypeError(__func__, "int");
+BigRational Literals::toBigRational() const {
+  if (big_) return *big_;
+  if (type_ == Type::COMPLEX) {
+    raise(Error::typeError(__func__, "Cplx"));
+    return BigRational(0);
   }
-  return std::get<long>(getLiteral().num_);
-}
-
-const Literals::Fraction& Literals::getFraction() const {
-  if (getType() != Type::FRACTION) {
-    throw TypeError(__func__, "Frac");
+  if (number_.isDecimal()) {
+    return BigRational(number_.num, BigInt::pow(10, -number_.exp));
   }
-  return std::get<Fraction>(getLiteral().num_);
-}
-
-Literals& Literals::getNumerator() const {
-  if (getType() != Type::FRACTION) {
-    throw TypeError(__func__, "Frac");
+  if (!number_.isRational()) {
+    raise(Error::typeError(__func__, "Frac"));
+    return BigRational(0);
   }
-  return *std::get<Fraction>(getLiteral().num_).numerator;
+  return BigRational(number_.num, number_.den);
 }
 
-Literals& Literals::getDenominator() const {
-  if (getType() != Type::FRACTION) {
-    throw TypeError(__func__, "Frac");
-  }
-  return *std::get<Fraction>(getLiteral().num_).denominator;
+Polynomial Literals::toPolynomial() const {
+  if (poly_) return *poly_;
+  return Polynomial(number_);
 }
 
-double Literals::getDouble() const {
-  if (getType() != Type::DOUBLE) {
-    throw TypeError(__func__, "Frac");
-  }
-  return std::get<double>(getLiteral().num_);
+Complex Literals::toComplex() const {
+  if (big_ || poly_) return {Number::fromDouble(value_), Number()};
+  return {number_, imag_};
 }
 
-Constant& Literals::getConstant() const {
-  if (getType() != Type::E && getType() != Type::PI) {
-    throw TypeError(__func__, "Frac");
-  }
-  return *getLiteral().constant_;
-}
+// Numbers are always kept reduced so there is nothing left to do
+Literals Literals::reduce() const& { return *this; }
 
-Literals& Literals::getAnswer() {
-  static Literals ans(0);
-  return ans;
-}
+Literals Literals::reduce() && { return std::move(*this); }
 
-Literals& Literals::getVariable(uint8_t var) {
-  static Literals variables[6] = {0, 0, 0, 0, 0, 0};
-  if (var > 'F' || var < 'A') {
-    throw picolator::math::DomainError("Var doesn't exist");
-  }
-  return variables[static_cast<int>(var - 'A')];
-}
+using PolynomialOp = std::optional<Polynomial> (*)(const Polynomial&,
+                                                   const Polynomial&);
 
-Literals& Literals::getLiteral() {
-  switch (type_) {
-    case Type::ANS:
-      return getAnswer();
-    case Type::VARIABLE:
-      return getVariable(variable_);
-    default:
-      return *this;
+/**
+ * @brief Runs op on the Numbers and only if the result doesn't fit redoes it
+ * with BigRational or Polynomial, or with doubles if neither works.
+ */
+template <typename Op>
+static Literals solve(const Literals& lhs, const Literals& rhs, Op op,
+                      PolynomialOp poly_op) {
+  if (lhs.isComplex() || rhs.isComplex()) {
+    return Literals(op(lhs.toComplex(), rhs.toComplex()));
   }
-}
-const Literals& Literals::getLiteral() const {
-  switch (type_) {
-    case Type::ANS:
-      return getAnswer();
-    case Type::VARIABLE:
-      return getVariable(variable_);
-    default:
-      return *this;
+  Number res = op(lhs.getNumber(), rhs.getNumber());
+  if (res.kind != Number::Kind::BIG) {
+    return Literals(res);
+  }
+  if (lhs.isExact() && rhs.isExact()) {
+    return Literals(op(lhs.toBigRational(), rhs.toBigRational()));
+  }
+  if (lhs.isSymbolic() && rhs.isSymbolic()) {
+    auto poly = poly_op(lhs.toPolynomial(), rhs.toPolynomial());
+    if (poly) return Literals(*poly);
   }
+  return Literals(Number::fromDouble(op(lhs.getValue(), rhs.getValue())));
 }
 
-Literals Literals::reduce() const {
-  if (getType() == Type::FRACTION) {
-    const auto& numerator = getNumerator();
-    const auto& denominator = getDenominator();
-
-    // Check to make sure that the numerator and denominators aren't doubles
-    if (numerator.getType() == Type::DOUBLE ||
-        denominator.getType() == Type::DOUBLE) {
-      return numerator.getValue() / denominator.getValue();
-    }
-
-    int num_value = 0;
-    int den_value = 0;
-
-    if (numerator == denominator) {
-      return 1;
-    }
-    if (numerator.getValue() == 0) {
-      return 0;
-    }
-    // get Numerator value
-    if (numerator.getType() == Type::LONG) {
-      num_value = numerator.getLong();
-    } else if (numerator.isConstant()) {
-      const auto& con = numerator.getConstant();
-      num_value = con.x_.getLong();
-    } else {
-      throw TypeError(__func__, "Long/Const");
-    }
-
-    // get denominator value
-    if (denominator.getType() == Type::LONG) {
-      den_value = denominator.getLong();
-    } else if (denominator.isConstant()) {
-      const auto& con = denominator.getConstant();
-      den_value = con.x_.getLong();
-    } else {
-      throw TypeError(__func__, "Long/Const");
-    }
-
-    // Uses euclidean gcd to reduce
-    int tmp_a;
-    while (den_value != 0) {
-      tmp_a = num_value;
-      num_value = den_value;
-      den_value = tmp_a % den_value;
-    }
-
-    Literals new_num(numerator), new_den(denominator);
-    if (numerator.isConstant()) {
-      new_num = Literals(numerator.getType(),
-                         numerator.getConstant().x_.getLong() / num_value,
-                         numerator.getConstant().pow_);
-    } else {
-      new_num = numerator.getLong() / num_value;
-    }
-
-    if (denominator.isConstant()) {
-      new_den = Literals(new_den.getType(),
-                         new_den.getConstant().x_.getLong() / num_value,
-                         new_den.getConstant().pow_);
-    } else {
-      new_den = new_den.getLong() / num_value;
-    }
+Literals Literals::operator+(const Literals& rhs) const {
+  return solve(
+      *this, rhs, [](const auto& a, const auto& b) { return a + b; },
+      Polynomial::add);
+}
 
-    // divide out constants
-    if (numerator.isConstant() &&
-        numerator.getType() == denominator.getType()) {
-      if (numerator.getConstant().pow_ == denominator.getConstant().pow_) {
-        // they cancel
-        new_num = numerator.getConstant().x_;
-        new_den = new_den.getConstant().x_;
-      } else if (numerator.getConstant().pow_.getLong() >
-                 denominator.getConstant().pow_.getLong()) {
-        // bottom cancels
-        new_num = Literals(new_num.getType(), new_num.getConstant().x_,
-                           new_num.getConstant().pow_.getLong() -
-                               new_den.getConstant().pow_.getLong());
-        new_den = new_den.getConstant().x_;
-      } else {
-        // top cancels
-        new_num = new_num.getConstant().x_;
-        new_den = Literals(new_den.getType(), new_den.getConstant().x_,
-                           new_den.getConstant().pow_.getLong() -
-                               new_num.getConstant().pow_.getLong());
-      }
-    }
+Literals Literals::operator*(const Literals& rhs) const {
+  return solve(
+      *this, rhs, [](const auto& a, const auto& b) { return a * b; },
+      Polynomial::mul);
+}
 
-    if (new_den == Literals(1)) return new_num;
-    return Literals(new_num, new_den);
+Literals Literals::operator/(const Literals& rhs) const {
+  return solve(
+      *this, rhs, [](const auto& a, const auto& b) { return a / b; },
+      Polynomial::div);
+}
 
-  } else {
-    return *this;
-  }
+// Same as the first step of solve, but without building a new Literals
+template <typename Op>
+bool Literals::updateNumber(const Literals& rhs, Op op) {
+  if (isComplex() || rhs.isComplex()) return false;
+  Number res = op(number_, rhs.number_);
+  if (res.kind == Number::Kind::BIG) return false;
+
+  symbol_.clear();
+  type_ = typeOf(res);
+  number_ = res;
+  big_.reset();
+  poly_.reset();
+  imag_ = Number();
+  variable_ = ' ';
+  value_ = number_.getValue();
+  return true;
 }
 
-Literals Literals::operator+(const Literals& rhs) const {
-  if (rhs.getType() == getType()) {
-    switch (getType()) {
-      case Type::LONG:
-        return Literals(rhs.getLong() + getLong());
-      case Type::FRACTION: {
-        const Fraction& left = std::get<Fraction>(num_);
-        const Fraction& right = std::get<Fraction>(rhs.num_);
-        if (*left.denominator == *right.denominator) {
-          return Literals(*left.numerator + *right.numerator,
-                          *right.denominator);
-        } else {
-          return Literals(*left.numerator * *right.denominator +
-                              *right.numerator * *left.denominator,
-                          *left.denominator * *right.denominator);
-        }
-      }
-      case Type::PI:
-      case Type::E:
-        if (rhs.constant_->pow_ == constant_->pow_) {
-          return Literals(getType(), rhs.constant_->x_ + constant_->x_,
-                          constant_->pow_);
-        }
-    }
-  } else if (rhs.getType() == Type::FRACTION && getType() == Type::LONG) {
-    const Fraction& frac = std::get<Fraction>(rhs.num_);
-    return Literals(*frac.denominator * std::get<long>(num_) + *frac.numerator,
-                    *frac.denominator);
-  } else if (getType() == Type::FRACTION && rhs.getType() == Type::LONG) {
-    const Fraction& frac = std::get<Fraction>(num_);
-    return Literals(
-        *frac.denominator * std::get<long>(rhs.num_) + *frac.numerator,
-        *frac.denominator);
+Literals& Literals::operator+=(const Literals& rhs) {
+  if (!updateNumber(
+          rhs, [](const Number& a, const Number& b) { return a + b; })) {
+    *this = *this + rhs;
   }
-  return Literals(rhs.getValue() + getValue());
+  return *this;
 }
 
-Literals Literals::operator*(const Literals& rhs) const {
-  if (rhs.getType() == getType()) {
-    switch (getType()) {
-      case Type::LONG:
-        return Literals(rhs.getLong() * getLong());
-      case Type::FRACTION: {
-        const Fraction& left = std::get<Fraction>(num_);
-        const Fraction& right = std::get<Fraction>(rhs.num_);
-
-        return Literals(*left.numerator * *right.numerator,
-                        *left.denominator * *right.denominator);
-      }
-      case Type::PI:
-      case Type::E:
-        return Literals(getType(), rhs.constant_->x_ * constant_->x_,
-                        rhs.constant_->pow_ + constant_->pow_);
-    }
-  } else if (rhs.getType() == Type::FRACTION &&
-             (getType() == Type::LONG || isConstant())) {
-    const Fraction& frac = rhs.getFraction();
-    return Literals(*this * getNumerator(), getDenominator());
-  } else if (getType() == Type::FRACTION &&
-             (rhs.getType() == Type::LONG || rhs.isConstant())) {
-    const Fraction& frac = std::get<Fraction>(num_);
-    return Literals(rhs * getNumerator(), getDenominator());
-  } else if (getType() == Type::LONG && (rhs.isConstant())) {
-    return Literals(rhs.getType(), rhs.getConstant().x_ * *this,
-                    rhs.getConstant().pow_);
-  } else if (isConstant() && (rhs.getType() == Type::LONG)) {
-    return Literals(getType(), getConstant().x_ * rhs, getConstant().pow_);
+Literals& Literals::operator*=(const Literals& rhs) {
+  if (!updateNumber(
+          rhs, [](const Number& a, const Number& b) { return a * b; })) {
+    *this = *this * rhs;
   }
-  return Literals(rhs.getValue() * getValue());
+  return *this;
 }
 
-Literals Literals::operator/(
-    const Literals& rhs) const {  // TODO clean up this function
-  if (rhs.getValue() < std::numeric_limits<double>::epsilon()) {
-    throw picolator::math::DivideByZero();
-  }
-  // return fraction
-  if (rhs.getType() == getType() && getType() == Type::LONG) {
-    if (*this % rhs == 0) {
-      return getLong() / rhs.getLong();
-    }
-    return Literals(*this, rhs).reduce();
-  } else if (getType() == Type::LONG && rhs.isConstant() ||
-             isConstant() && rhs.getType() == Type::LONG ||
-             isConstant() && rhs.isConstant()) {
-    return Literals(*this, rhs).reduce();
+Literals& Literals::operator/=(const Literals& rhs) {
+  if (!updateNumber(
+          rhs, [](const Number& a, const Number& b) { return a / b; })) {
+    *this = *this / rhs;
   }
-  return getValue() / rhs.getValue();
+  return *this;
 }
 
 Literals Literals::operator%(const Literals& rhs) const {
-  if (rhs.getType() != Type::LONG || getType() != Type::LONG) {
-    throw picolator::math::TypeError("%", "Int");
+  if (isComplex() || rhs.isComplex()) {
+    raise(Error::typeError("%", "Int"));
+    return Literals(0);
+  }
+  Number res = getNumber() % rhs.getNumber();
+  if (res.kind != Number::Kind::BIG) {
+    return Literals(res);
   }
-  return getLong() % rhs.getLong();
+  if (!isExact() || !rhs.isExact()) {
+    raise(Error::typeError("%", "Int"));
+    return Literals(0);
+  }
+  BigRational lhs_big = toBigRational(), rhs_big = rhs.toBigRational();
+  if (!lhs_big.isInteger() || !rhs_big.isInteger()) {
+    raise(Error::typeError("%", "Int"));
+    return Literals(0);
+  }
+  return Literals(BigRational(lhs_big.numerator() % rhs_big.numerator()));
 }
 
 bool Literals::operator==(const Literals& rhs) const {
-  // return fraction
+  if (isComplex() || rhs.isComplex()) {
+    return toComplex() == rhs.toComplex();
+  }
+  Number::Kind big = Number::Kind::BIG;
+  if ((getNumber().kind == big || rhs.getNumber().kind == big) &&
+      isExact() && rhs.isExact()) {
+    BigRational lhs_big = toBigRational(), rhs_big = rhs.toBigRational();
+    return lhs_big.numerator() == rhs_big.numerator() &&
+           lhs_big.denominator() == rhs_big.denominator();
+  }
   return (std::fabs(rhs.getValue() - getValue()) <=
           std::numeric_limits<double>::epsilon() * 2);
 }
 
 Literals Literals::operator-() const {
-  switch (getType()) {
-    case Type::DOUBLE:
-      return Literals(-getDouble());
-    case Type::LONG:
-      return Literals(-getLong());
-    case Type::FRACTION:
-      return Literals(-(getNumerator()), getDenominator());
-    case Type::PI:
-    case Type::E:
-      return Literals(getType(), -(getConstant().x_), getConstant().pow_);
-    default:
-      // TODO throw err
-      throw NotImplementedError(__func__);
+  if (isComplex()) {
+    return Literals(-toComplex());
+  }
+  Number res = -getNumber();
+  if (res.kind != Number::Kind::BIG) {
+    return Literals(res);
   }
+  if (isExact()) {
+    return Literals(BigRational(0) - toBigRational());
+  }
+  auto poly = toPolynomial().negate();
+  if (poly) return Literals(*poly);
+  return Literals(Number::fromDouble(-getValue()));
 }
 
 Literals Literals::operator^(const Literals& rhs) const {
-  if (rhs.getType() == getType()) {
-    switch (getType()) {
-      case Type::LONG:
-        return Literals(pow(rhs.getLong(), getLong()));
+  // (-8)^(1/3) has no real answer so it gets the principal complex one
+  bool negative_root = getValue() < 0 && rhs.getType() != Type::LONG;
+  if (isComplex() || rhs.isComplex() || negative_root) {
+    return Literals(Complex::pow(toComplex(), rhs.toComplex()));
+  }
+  Number res = getNumber() ^ rhs.getNumber();
+  if (res.kind != Number::Kind::BIG) {
+    return Literals(res);
+  }
+
+  bool integer_exp = rhs.getType() == Type::LONG && !rhs.big_;
+  int64_t exp = rhs.getNumber().num;
+
+  // Exact powers as long as the answer stays a sane size
+  if (isExact() && integer_exp) {
+    BigRational base = toBigRational();
+    double bits = std::max(base.numerator().bitLength(),
+                           base.denominator().bitLength()) *
+                  std::fabs(static_cast<double>(exp));
+    if (bits <= MAX_EXACT_POW_BITS) {
+      return Literals(BigRational::pow(base, exp));
     }
   }
-  if (isConstant()) {
-    if (rhs.getType() == Type::LONG) {
-      return Literals(getType(), getConstant().x_, getConstant().pow_ + rhs);
+
+  // (1+pi)^2 by multiplying it out
+  if (isSymbolic() && integer_exp && exp > 0 &&
+      exp <= static_cast<int64_t>(Polynomial::MAX_TERMS)) {
+    std::optional<Polynomial> poly = toPolynomial();
+    Polynomial base = *poly;
+    for (int64_t i = 1; i < exp && poly; i++) {
+      poly = Polynomial::mul(*poly, base);
     }
+    if (poly) return Literals(*poly);
   }
-  return Literals(pow(getValue(), rhs.getValue()));
-}
\ No newline at end of file
+  return Literals(Number::fromDouble(pow(getValue(), rhs.getValue())));
+}
@@ -15,15 +15,15 @@
 #include <limits>
 #include <memory>
 #include <string>
-#include <variant>
 
+#include "big_number.h"
+#include "complex.h"
 #include "letter.h"
+#include "number.h"
+#include "polynomial.h"
 
 namespace picolator::math {
 
-// Forward declaration for Literals
-class Constant;
-
 class Literals : public Letter {
  public:
   enum class Type {
@@ -35,39 +35,34 @@ class Literals : public Letter {
     VARIABLE,
     ANS,
     SQRT_NUM,  // not sure if i'll use this
+    MONOMIAL,    // k * pi^a * e^b with both powers set
+    POLYNOMIAL,  // sum of monomials ie 2 + pi
+    DECIMAL,     // typed in decimal like 0.1, kept as mantissa * 10^exp
+    COMPLEX,     // re + im*i, the token version is i
   };
 
-  struct Fraction {
-    std::unique_ptr<Literals> numerator;
-    std::unique_ptr<Literals> denominator;
-
-    Fraction(const Literals& num, const Literals& den) {
-      numerator = std::make_unique<Literals>(num);
-      denominator = std::make_unique<Literals>(den);
-    }
-    Fraction(const Fraction& rhs) {
-      numerator = std::make_unique<Literals>(*rhs.numerator);
-      denominator = std::make_unique<Literals>(*rhs.denominator);
-    }
-  };
-
-  static const Literals* ans_;
-
  private:
   Type type_;
-  std::variant<Fraction, double, long> num_ = 0L;
+  // Value of a DOUBLE, LONG, FRACTION, PI or E, unused for VARIABLE and ANS.
+  // Those are only placeholders, Program loads their value from an
+  // EvalEnvironment
+  Number number_;
+  // Set instead of number_ once a LONG or FRACTION overflows int64
+  std::shared_ptr<const BigRational> big_;
+  // Set instead of number_ for sums of different powers of pi and e
+  std::shared_ptr<const Polynomial> poly_;
+  // Imaginary part of a COMPLEX, number_ holds the real part
+  Number imag_;
   char variable_ = ' ';
-  std::unique_ptr<Constant> constant_ = {};
-
-  long getLong() const;
-  double getDouble() const;
-  Literals& getNumerator() const;
-  Literals& getDenominator() const;
-  Constant& getConstant() const;
-  const Fraction& getFraction() const;
-  inline bool isConstant() const {
-    return (getType() == Type::E || getType() == Type::PI);
-  }
+  // getValue() is called a lot and pow() is slow without an FPU so it is
+  // worked out once
+  double value_ = 0;
+
+  // Does op on the Numbers and stores the result in this literal. False and
+  // left alone if either side is complex or the result needs a BigRational
+  // or Polynomial
+  template <typename Op>
+  bool updateNumber(const Literals& rhs, Op op);
 
  public:
   /**
@@ -107,35 +102,83 @@ class Literals : public Letter {
    */
   Literals(const Literals& numerator, const Literals& denominator);
 
-  // Const Constructors
-  Literals(Type type);
-  Literals(Type type, const Literals& x, const Literals& pow);
-  Literals(const Literals&);
+  /**
+   * @brief Wraps a computed Number
+   *
+   * @param number
+   */
+  explicit Literals(const Number& number);
 
-  // Returns a double value of the Literals
-  double getValue() const;
-  inline const Type& getType() const { return getLiteral().type_; }
-  // finds the reduction of the current literal and returns it.
-  Literals reduce() const;
+  /**
+   * @brief Wraps an exact LONG or FRACTION, goes back to a plain Number if
+   * it fits in int64
+   *
+   * @param big
+   */
+  explicit Literals(const BigRational& big);
 
   /**
-   * @brief Checks if this literals is a wrapper for
-   *        a real literal and returns the correct value
-   *        (ie Variable and Answer are just placeholder
-   *         and dont contain the actual value
-   *        )
+   * @brief Wraps a sum of monomials, goes back to a plain Number if it only
+   * has one term
    *
-   * @return Literals& Ref to actual literal
+   * @param poly
    */
-  const Literals& getLiteral() const;
-  Literals& getLiteral();
+  explicit Literals(const Polynomial& poly);
 
-  // SingletonAnswer
-  static Literals& getAnswer();
+  /**
+   * @brief Wraps a complex number, goes back to a plain Number if the
+   * imaginary part is 0
+   *
+   * @param z
+   */
+  explicit Literals(const Complex& z);
 
-  // Singleton variables
-  static Literals& getVariable(uint8_t var);
+  // Const Constructors
+  Literals(Type type);
+  Literals(Type type, const Literals& x, const Literals& pow);
 
+  // Copies share the BigRational, moves never allocate
+  Literals(const Literals&) = default;
+  Literals(Literals&&) noexcept = default;
+  Literals& operator=(const Literals&) = default;
+  Literals& operator=(Literals&&) noexcept = default;
+
+  // Returns a double value of the Literals, the real part for COMPLEX
+  inline double getValue() const { return value_; }
+  inline const Type& getType() const { return type_; }
+  // Same as getType, reads better when checking for VARIABLE and ANS
+  inline const Type& getTokenType() const { return type_; }
+  inline char getVariableName() const { return variable_; }
+  // Numeric value, BIG when the value only fits in a BigRational
+  inline const Number& getNumber() const { return number_; }
+  // True for LONG, FRACTION and DECIMAL, including values too big for Number
+  inline bool isExact() const {
+    return big_ || ((number_.isRational() || number_.isDecimal()) &&
+                    type_ != Type::COMPLEX);
+  }
+  // Exact value of a LONG, FRACTION or DECIMAL
+  BigRational toBigRational() const;
+  // True for anything that is exact but not a BigRational, ie 2, pi or 1+e
+  inline bool isSymbolic() const {
+    return poly_ || (number_.isMonomial() && type_ != Type::COMPLEX);
+  }
+  Polynomial toPolynomial() const;
+  inline bool isComplex() const { return getType() == Type::COMPLEX; }
+  // Any literal as re + im*i, BigRationals and Polynomials become doubles
+  Complex toComplex() const;
+  // Exactly 0, unlike getValue() this is false for pure imaginary numbers
+  inline bool isZero() const { return getValue() == 0 && !isComplex(); }
+  // finds the reduction of the current literal and returns it.
+  Literals reduce() const&;
+  // Same as above but reuses this literal when it is already a value
+  Literals reduce() &&;
+
+  // Variables are A to F
+  static constexpr uint8_t VARIABLE_COUNT = 6;
+
+  // Computed values don't build their symbol until it is drawn since
+  // to_string(double) is really slow on the pico
+  std::string getSymbol() const override;
   std::string toString() const;
 
   // I need this because I am crazy
@@ -147,29 +190,9 @@ class Literals : public Letter {
   bool operator==(const Literals& rhs) const;
   Literals operator-() const;
 
-  // copy operator
-  Literals operator=(const Literals& rhs);
-};
-
-class Constant {
- public:
-  // Represents an x(pi) ie 2(pi) or (3pi)
-  Literals x_;
-  // Represents an pi^pow_ ie pi^2 or pi^3
-  Literals pow_;
-
-  Constant(const Literals& x, const Literals& pow) : x_(x), pow_(pow) {}
-};
-
-class PI : public Constant {
- public:
-  static constexpr double value = 3.141592653589793;
-  PI(const Literals& x, const Literals& pow) : Constant(x, pow) {}
-};
-
-class E : public Constant {
- public:
-  static constexpr double value = 2.718281828459045;
-  E(const Literals& x, const Literals& pow) : Constant(x, pow) {}
+  // In place versions for accumulating results, rhs may be *this
+  Literals& operator+=(const Literals& rhs);
+  Literals& operator*=(const Literals& rhs);
+  Literals& operator/=(const Literals& rhs);
 };
 }  // namespace picolator::math
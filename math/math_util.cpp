@@ -36,28 +36,40 @@ Literals specialSineValues(double res) {
 }
 
 Literals pcos(const Literals& radian) {
+  if (radian.isComplex()) return Literals(Complex::cos(radian.toComplex()));
   return specialSineValues(cos(radian.getValue()));
 }
 
 Literals psin(const Literals& radian) {
+  if (radian.isComplex()) return Literals(Complex::sin(radian.toComplex()));
   return specialSineValues(sin(radian.getValue()));
 }
 
 Literals ptan(const Literals& radian) {
+  if (radian.isComplex()) return Literals(Complex::tan(radian.toComplex()));
   // Check if its
   // pi/2
   return specialSineValues(tan(radian.getValue()));
 }
 
 Literals parccos(const Literals& x) {
+  // Outside -1..1 the answer is complex
+  if (x.isComplex() || std::fabs(x.getValue()) > 1) {
+    return Literals(Complex::acos(x.toComplex()));
+  }
   return specialSineValues(acos(x.getValue()));
 }
 
 Literals parcsin(const Literals& x) {
+  // Outside -1..1 the answer is complex
+  if (x.isComplex() || std::fabs(x.getValue()) > 1) {
+    return Literals(Complex::asin(x.toComplex()));
+  }
   return specialSineValues(asin(x.getValue()));
 }
 
 Literals parctan(const Literals& x) {
+  if (x.isComplex()) return Literals(Complex::atan(x.toComplex()));
   // Check if its
   // pi/2
   return specialSineValues(atan(x.getValue()));
@@ -0,0 +1,523 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "number.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+#include "math_util.h"
+
+namespace picolator::math {
+
+// 10^i for every power that fits in int64
+static constexpr int64_t POW10[] = {1,
+                                    10,
+                                    100,
+                                    1000,
+                                    10000,
+                                    100000,
+                                    1000000,
+                                    10000000,
+                                    100000000,
+                                    1000000000,
+                                    10000000000,
+                                    100000000000,
+                                    1000000000000,
+                                    10000000000000,
+                                    100000000000000,
+                                    1000000000000000,
+                                    10000000000000000,
+                                    100000000000000000,
+                                    1000000000000000000};
+static constexpr int MAX_POW10 = sizeof(POW10) / sizeof(POW10[0]) - 1;
+
+// Doubles hold powers of ten exactly up to 1e22
+static constexpr double POW10_DOUBLE[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+Number Number::fromLong(int64_t l) {
+  Number n;
+  n.kind = Kind::LONG;
+  n.num = l;
+  return n;
+}
+
+Number Number::fromDouble(double d) {
+  Number n;
+  n.kind = Kind::DOUBLE;
+  n.d = d;
+  return n;
+}
+
+Number Number::big() {
+  Number n;
+  n.kind = Kind::BIG;
+  return n;
+}
+
+Number Number::fraction(int64_t num, int64_t den) {
+  if (den == 0) {
+    raise(Error::divideByZero());
+    return Number();
+  }
+  if (num == std::numeric_limits<int64_t>::min() ||
+      den == std::numeric_limits<int64_t>::min()) {
+    return big();
+  }
+  if (den < 0) {
+    num = -num;
+    den = -den;
+  }
+
+  // gcd(0, den) is den so 0/x becomes 0/1
+  int64_t gcd = std::gcd(num, den);
+  Number n;
+  n.num = num / gcd;
+  n.den = den / gcd;
+  n.kind = (n.den == 1) ? Kind::LONG : Kind::FRACTION;
+  return n;
+}
+
+Number Number::monomial(int64_t num, int64_t den, int8_t pi_pow,
+                        int8_t e_pow) {
+  Number n = fraction(num, den);
+  if ((pi_pow != 0 || e_pow != 0) && n.kind != Kind::BIG && n.num != 0) {
+    n.kind = Kind::CONSTANT;
+    n.pi_pow = pi_pow;
+    n.e_pow = e_pow;
+  }
+  return n;
+}
+
+Number Number::decimal(int64_t mantissa, int exp) {
+  if (mantissa == 0) {
+    return fromLong(0);
+  }
+  while (mantissa % 10 == 0 && exp < 0) {
+    mantissa /= 10;
+    exp++;
+  }
+  if (exp >= 0) {
+    int64_t res;
+    if (exp > MAX_POW10 ||
+        __builtin_mul_overflow(mantissa, POW10[exp], &res)) {
+      return big();
+    }
+    return fromLong(res);
+  }
+  if (exp < std::numeric_limits<int16_t>::min()) {
+    return big();
+  }
+  Number n;
+  n.kind = Kind::DECIMAL;
+  n.num = mantissa;
+  n.exp = exp;
+  return n;
+}
+
+Number Number::parseDecimal(std::string_view digits) {
+  int64_t mantissa = 0;
+  int exp = 0;
+  bool after_point = false;
+  for (char c : digits) {
+    if (c == '.') {
+      // Like stod anything past a second point is ignored
+      if (after_point) break;
+      after_point = true;
+      continue;
+    }
+    if (__builtin_mul_overflow(mantissa, 10, &mantissa) ||
+        __builtin_add_overflow(mantissa, c - '0', &mantissa)) {
+      return big();
+    }
+    if (after_point) exp--;
+  }
+  return decimal(mantissa, exp);
+}
+
+double Number::getValue() const {
+  switch (kind) {
+    case Kind::LONG:
+      return num;
+    case Kind::DOUBLE:
+      return d;
+    case Kind::FRACTION:
+      return static_cast<double>(num) / den;
+    case Kind::CONSTANT: {
+      double value = static_cast<double>(num) / den;
+      if (pi_pow) value *= std::pow(PI::value, pi_pow);
+      if (e_pow) value *= std::pow(E::value, e_pow);
+      return value;
+    }
+    case Kind::DECIMAL:
+      // Dividing by an exact power of ten rounds once, 0.3 stays 0.3
+      if (-exp < static_cast<int>(std::size(POW10_DOUBLE))) {
+        return static_cast<double>(num) / POW10_DOUBLE[-exp];
+      }
+      return num * std::pow(10.0, exp);
+    case Kind::BIG:
+      break;
+  }
+  return std::numeric_limits<double>::quiet_NaN();
+}
+
+// pi^2 or e, empty for a power of 0
+static std::string constantString(const char* symbol, int pow) {
+  if (pow == 0) return "";
+  pow = (pow < 0) ? -pow : pow;
+  return (pow == 1) ? symbol : symbol + ("^" + std::to_string(pow));
+}
+
+std::string Number::toString() const {
+  switch (kind) {
+    case Kind::LONG:
+      return std::to_string(num);
+    case Kind::DOUBLE:
+      return std::to_string(d);
+    case Kind::FRACTION:
+      return std::to_string(num) + "/" + std::to_string(den);
+    case Kind::CONSTANT: {
+      // Positive powers go on top and negative ones on the bottom,
+      // 3pi^2/4e or 3/4pi^2
+      std::string top = constantString("\xF7", pi_pow > 0 ? pi_pow : 0) +
+                        constantString("e", e_pow > 0 ? e_pow : 0);
+      std::string bottom = constantString("\xF7", pi_pow < 0 ? pi_pow : 0) +
+                           constantString("e", e_pow < 0 ? e_pow : 0);
+      std::string res;
+      if (top.empty() || (num != 1 && num != -1)) {
+        res = std::to_string(num);
+      } else if (num == -1) {
+        res = "-";
+      }
+      res += top;
+      if (den != 1 || !bottom.empty()) {
+        res += "/" + ((den != 1) ? std::to_string(den) : "") + bottom;
+      }
+      return res;
+    }
+    case Kind::DECIMAL: {
+      // -125 * 10^-2 = -1.25
+      uint64_t mantissa = (num < 0) ? 0 - static_cast<uint64_t>(num) : num;
+      std::string digits = std::to_string(mantissa);
+      size_t point = -exp;
+      if (digits.size() <= point) {
+        digits.insert(0, point - digits.size() + 1, '0');
+      }
+      digits.insert(digits.size() - point, 1, '.');
+      return (num < 0) ? "-" + digits : digits;
+    }
+    case Kind::BIG:
+      break;
+  }
+  return "BIG";
+}
+
+// Rational math on the num/den of a LONG, FRACTION or the coefficient of a
+// CONSTANT. Returns BIG if anything overflows
+static Number addRational(const Number& lhs, const Number& rhs) {
+  int64_t lhs_num, rhs_num, num, den;
+  if (__builtin_mul_overflow(lhs.num, rhs.den, &lhs_num) ||
+      __builtin_mul_overflow(rhs.num, lhs.den, &rhs_num) ||
+      __builtin_add_overflow(lhs_num, rhs_num, &num) ||
+      __builtin_mul_overflow(lhs.den, rhs.den, &den)) {
+    return Number::big();
+  }
+  return Number::fraction(num, den);
+}
+
+static Number mulRational(const Number& lhs, const Number& rhs) {
+  int64_t num, den;
+  if (lhs.kind == Number::Kind::BIG || rhs.kind == Number::Kind::BIG ||
+      __builtin_mul_overflow(lhs.num, rhs.num, &num) ||
+      __builtin_mul_overflow(lhs.den, rhs.den, &den)) {
+    return Number::big();
+  }
+  return Number::fraction(num, den);
+}
+
+static Number divRational(const Number& lhs, const Number& rhs) {
+  int64_t num, den;
+  if (__builtin_mul_overflow(lhs.num, rhs.den, &num) ||
+      __builtin_mul_overflow(lhs.den, rhs.num, &den)) {
+    return Number::big();
+  }
+  return Number::fraction(num, den);
+}
+
+// base^exp using squaring, base should be rational
+static Number powRational(Number base, uint64_t exp) {
+  Number res = Number::fromLong(1);
+  while (exp) {
+    if (exp & 1) res = mulRational(res, base);
+    exp >>= 1;
+    if (exp) base = mulRational(base, base);
+  }
+  return res;
+}
+
+static inline bool isBig(const Number& lhs, const Number& rhs) {
+  return lhs.kind == Number::Kind::BIG || rhs.kind == Number::Kind::BIG;
+}
+
+// coefficient * pi^pi_pow * e^e_pow, BIG if the coefficient overflowed or a
+// power doesn't fit in int8
+static Number monomialOrBig(const Number& coefficient, int64_t pi_pow,
+                            int64_t e_pow) {
+  constexpr int64_t min = std::numeric_limits<int8_t>::min();
+  constexpr int64_t max = std::numeric_limits<int8_t>::max();
+  if (coefficient.kind == Number::Kind::BIG || pi_pow < min ||
+      pi_pow > max || e_pow < min || e_pow > max) {
+    return Number::big();
+  }
+  return Number::monomial(coefficient.num, coefficient.den, pi_pow, e_pow);
+}
+
+// Decimal math works on the int64 mantissas of a DECIMAL and a DECIMAL or
+// LONG. Anything else, or a result that overflows, gives BIG and is redone
+// with asRational.
+static inline bool isDecimalOp(const Number& lhs, const Number& rhs) {
+  return (lhs.isDecimal() || rhs.isDecimal()) &&
+         (lhs.isDecimal() || lhs.kind == Number::Kind::LONG) &&
+         (rhs.isDecimal() || rhs.kind == Number::Kind::LONG);
+}
+
+// Gives lhs and rhs mantissas with the same exponent, false on overflow
+static bool alignDecimal(const Number& lhs, const Number& rhs,
+                         int64_t& lhs_num, int64_t& rhs_num, int& exp) {
+  int lhs_exp = lhs.isDecimal() ? lhs.exp : 0;
+  int rhs_exp = rhs.isDecimal() ? rhs.exp : 0;
+  exp = std::min(lhs_exp, rhs_exp);
+  return lhs_exp - exp <= MAX_POW10 && rhs_exp - exp <= MAX_POW10 &&
+         !__builtin_mul_overflow(lhs.num, POW10[lhs_exp - exp], &lhs_num) &&
+         !__builtin_mul_overflow(rhs.num, POW10[rhs_exp - exp], &rhs_num);
+}
+
+static Number addDecimal(const Number& lhs, const Number& rhs) {
+  int64_t lhs_num, rhs_num, num;
+  int exp;
+  if (!isDecimalOp(lhs, rhs) ||
+      !alignDecimal(lhs, rhs, lhs_num, rhs_num, exp) ||
+      __builtin_add_overflow(lhs_num, rhs_num, &num)) {
+    return Number::big();
+  }
+  return Number::decimal(num, exp);
+}
+
+static Number mulDecimal(const Number& lhs, const Number& rhs) {
+  int64_t num;
+  if (!isDecimalOp(lhs, rhs) ||
+      __builtin_mul_overflow(lhs.num, rhs.num, &num)) {
+    return Number::big();
+  }
+  return Number::decimal(num, (lhs.isDecimal() ? lhs.exp : 0) +
+                                  (rhs.isDecimal() ? rhs.exp : 0));
+}
+
+// 1.5 / 0.3 = 15/3 = 5. Stays a decimal if the reduced denominator divides
+// a power of ten, 1/3 is a FRACTION
+static Number divDecimal(const Number& lhs, const Number& rhs) {
+  int64_t lhs_num, rhs_num;
+  int exp;
+  if (!isDecimalOp(lhs, rhs) ||
+      !alignDecimal(lhs, rhs, lhs_num, rhs_num, exp)) {
+    return Number::big();
+  }
+  Number res = Number::fraction(lhs_num, rhs_num);
+  if (res.kind != Number::Kind::FRACTION) {
+    return res;
+  }
+  for (int k = 1; k <= MAX_POW10; k++) {
+    if (POW10[k] % res.den == 0) {
+      int64_t num;
+      if (__builtin_mul_overflow(res.num, POW10[k] / res.den, &num)) break;
+      return Number::decimal(num, -k);
+    }
+  }
+  return res;
+}
+
+// num/10^k as a FRACTION or LONG, other kinds are returned as is
+static Number asRational(const Number& n) {
+  if (!n.isDecimal()) {
+    return n;
+  }
+  if (-n.exp > MAX_POW10) {
+    return Number::big();
+  }
+  return Number::fraction(n.num, POW10[-n.exp]);
+}
+
+Number operator+(const Number& lhs, const Number& rhs) {
+  if (lhs.kind == Number::Kind::LONG && rhs.kind == Number::Kind::LONG) {
+    int64_t res;
+    if (__builtin_add_overflow(lhs.num, rhs.num, &res)) return Number::big();
+    return Number::fromLong(res);
+  }
+  if (lhs.isDecimal() || rhs.isDecimal()) {
+    Number res = addDecimal(lhs, rhs);
+    if (res.kind != Number::Kind::BIG) return res;
+    return asRational(lhs) + asRational(rhs);
+  }
+  if (isBig(lhs, rhs)) {
+    return Number::big();
+  }
+  if (lhs.isRational() && rhs.isRational()) {
+    return addRational(lhs, rhs);
+  }
+  // 2pi + 3pi = 5pi
+  if (lhs.samePowers(rhs)) {
+    return monomialOrBig(addRational(lhs, rhs), lhs.pi_pow, lhs.e_pow);
+  }
+  // 2 + pi needs a Polynomial
+  if (lhs.isMonomial() && rhs.isMonomial()) {
+    return Number::big();
+  }
+  return Number::fromDouble(lhs.getValue() + rhs.getValue());
+}
+
+Number operator-(const Number& num) {
+  Number res = num;
+  if (res.kind == Number::Kind::DOUBLE) {
+    res.d = -res.d;
+  } else if (res.kind == Number::Kind::BIG ||
+             res.num == std::numeric_limits<int64_t>::min()) {
+    return Number::big();
+  } else {
+    res.num = -res.num;
+  }
+  return res;
+}
+
+Number operator*(const Number& lhs, const Number& rhs) {
+  if (lhs.kind == Number::Kind::LONG && rhs.kind == Number::Kind::LONG) {
+    int64_t res;
+    if (__builtin_mul_overflow(lhs.num, rhs.num, &res)) return Number::big();
+    return Number::fromLong(res);
+  }
+  if (lhs.isDecimal() || rhs.isDecimal()) {
+    Number res = mulDecimal(lhs, rhs);
+    if (res.kind != Number::Kind::BIG) return res;
+    return asRational(lhs) * asRational(rhs);
+  }
+  if (isBig(lhs, rhs)) {
+    return Number::big();
+  }
+  if (lhs.isRational() && rhs.isRational()) {
+    return mulRational(lhs, rhs);
+  }
+  if (lhs.isMonomial() && rhs.isMonomial()) {
+    return monomialOrBig(mulRational(lhs, rhs), lhs.pi_pow + rhs.pi_pow,
+                         lhs.e_pow + rhs.e_pow);
+  }
+  return Number::fromDouble(lhs.getValue() * rhs.getValue());
+}
+
+Number operator/(const Number& lhs, const Number& rhs) {
+  if (isBig(lhs, rhs)) {
+    return Number::big();
+  }
+  if (rhs.getValue() == 0) {
+    raise(Error::divideByZero());
+    return Number();
+  }
+  if (lhs.isDecimal() || rhs.isDecimal()) {
+    Number res = divDecimal(lhs, rhs);
+    if (res.kind != Number::Kind::BIG) return res;
+    return asRational(lhs) / asRational(rhs);
+  }
+  if (lhs.isRational() && rhs.isRational()) {
+    return divRational(lhs, rhs);
+  }
+  if (lhs.isMonomial() && rhs.isMonomial()) {
+    return monomialOrBig(divRational(lhs, rhs), lhs.pi_pow - rhs.pi_pow,
+                         lhs.e_pow - rhs.e_pow);
+  }
+  return Number::fromDouble(lhs.getValue() / rhs.getValue());
+}
+
+Number operator%(const Number& lhs, const Number& rhs) {
+  if (isBig(lhs, rhs)) {
+    return Number::big();
+  }
+  if (lhs.kind != Number::Kind::LONG || rhs.kind != Number::Kind::LONG) {
+    // 1.5 % 1 is still an error but 1.0 already became a LONG
+    raise(Error::typeError("%", "Int"));
+    return Number();
+  }
+  if (rhs.num == 0) {
+    raise(Error::divideByZero());
+    return Number();
+  }
+  // INT64_MIN % -1 traps
+  if (rhs.num == -1) {
+    return Number::fromLong(0);
+  }
+  return Number::fromLong(lhs.num % rhs.num);
+}
+
+Number operator^(const Number& lhs, const Number& rhs) {
+  if (isBig(lhs, rhs)) {
+    return Number::big();
+  }
+  // 1.5^2 = 2.25, negative powers go through the fraction
+  if (lhs.isDecimal() && rhs.kind == Number::Kind::LONG && rhs.num >= 0) {
+    Number mantissa = powRational(Number::fromLong(lhs.num), rhs.num);
+    int64_t exp;
+    if (mantissa.kind != Number::Kind::BIG &&
+        !__builtin_mul_overflow(int64_t{lhs.exp}, rhs.num, &exp) &&
+        exp >= std::numeric_limits<int16_t>::min()) {
+      return Number::decimal(mantissa.num, exp);
+    }
+  }
+  if (lhs.isDecimal() || rhs.isDecimal()) {
+    return asRational(lhs) ^ asRational(rhs);
+  }
+  if (rhs.kind == Number::Kind::LONG && lhs.isMonomial()) {
+    uint64_t exp =
+        (rhs.num < 0) ? 0 - static_cast<uint64_t>(rhs.num) : rhs.num;
+    Number coefficient = powRational(lhs, exp);
+    if (coefficient.kind == Number::Kind::BIG) {
+      return coefficient;
+    }
+    if (rhs.num < 0) {
+      coefficient = Number::fraction(coefficient.den, coefficient.num);
+    }
+    if (lhs.isRational()) {
+      return coefficient;
+    }
+
+    // (2pi^3)^2 = 4pi^6 as long as the powers still fit
+    int64_t pi_pow, e_pow;
+    if (!__builtin_mul_overflow(int64_t{lhs.pi_pow}, rhs.num, &pi_pow) &&
+        !__builtin_mul_overflow(int64_t{lhs.e_pow}, rhs.num, &e_pow)) {
+      Number res = monomialOrBig(coefficient, pi_pow, e_pow);
+      if (res.kind != Number::Kind::BIG) return res;
+    }
+  }
+  return Number::fromDouble(std::pow(lhs.getValue(), rhs.getValue()));
+}
+
+bool operator==(const Number& lhs, const Number& rhs) {
+  int64_t lhs_num, rhs_num;
+  int exp;
+  if (isDecimalOp(lhs, rhs) &&
+      alignDecimal(lhs, rhs, lhs_num, rhs_num, exp)) {
+    return lhs_num == rhs_num;
+  }
+  return (std::fabs(rhs.getValue() - lhs.getValue()) <=
+          std::numeric_limits<double>::epsilon() * 2);
+}
+
+}  // namespace picolator::math
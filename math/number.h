@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace picolator::math {
+
+class PI {
+ public:
+  static constexpr double value = 3.141592653589793;
+};
+
+class E {
+ public:
+  static constexpr double value = 2.718281828459045;
+};
+
+/**
+ * @brief Plain value type that does all the math behind Literals.
+ * It never touches the heap so it can be copied around freely.
+ *
+ * LONG     num
+ * DOUBLE   d
+ * FRACTION num/den, always reduced with a positive den
+ * CONSTANT (num/den) * pi^pi_pow * e^e_pow, at least one power isn't 0
+ * DECIMAL  num * 10^exp, what typed in decimals become so 0.1 stays exact.
+ *          Never has trailing zeros in num
+ * BIG      the exact result doesn't fit in a Number, either int64
+ *          overflowed or constants with different powers got added. Whoever
+ *          owns the Number has to redo the op with BigRational or
+ *          Polynomial (see Literals)
+ *
+ * LONG, FRACTION and CONSTANT are all monomials, rationals just have both
+ * powers at 0.
+ */
+struct Number {
+  enum class Kind : uint8_t { LONG, DOUBLE, FRACTION, CONSTANT, BIG, DECIMAL };
+
+  Kind kind = Kind::LONG;
+  // Powers of pi and e for CONSTANT
+  int8_t pi_pow = 0;
+  int8_t e_pow = 0;
+  // Power of ten for DECIMAL
+  int16_t exp = 0;
+  union {
+    int64_t num = 0;
+    double d;
+  };
+  int64_t den = 1;
+
+  static Number fromLong(int64_t l);
+  static Number fromDouble(double d);
+  static Number big();
+  // Creates a reduced fraction, becomes a LONG if den divides num.
+  // INT64_MIN can't be negated so it gives BIG
+  static Number fraction(int64_t num, int64_t den);
+  // Creates (num/den) * pi^pi_pow * e^e_pow, becomes a fraction if both
+  // powers are 0
+  static Number monomial(int64_t num, int64_t den, int8_t pi_pow,
+                         int8_t e_pow);
+  // Creates mantissa * 10^exp, becomes a LONG if it is a whole number
+  static Number decimal(int64_t mantissa, int exp);
+  /**
+   * @brief Parses typed digits like "12.50". Becomes BIG if there are too
+   * many digits to fit in the mantissa, BigRational::parseDecimal reads those
+   *
+   * @param digits only 0-9 and at most one '.'
+   */
+  static Number parseDecimal(std::string_view digits);
+
+  inline bool isRational() const {
+    return kind == Kind::LONG || kind == Kind::FRACTION;
+  }
+  inline bool isConstant() const { return kind == Kind::CONSTANT; }
+  inline bool isDecimal() const { return kind == Kind::DECIMAL; }
+  inline bool isMonomial() const { return isRational() || isConstant(); }
+  // True if both are monomials that only differ by their coefficient
+  inline bool samePowers(const Number& rhs) const {
+    return isMonomial() && rhs.isMonomial() && pi_pow == rhs.pi_pow &&
+           e_pow == rhs.e_pow;
+  }
+
+  double getValue() const;
+  std::string toString() const;
+};
+
+static_assert(std::is_trivially_copyable_v<Number>);
+static_assert(sizeof(Number) <= 24);
+
+// Any op that overflows or has a BIG operand returns BIG
+Number operator+(const Number& lhs, const Number& rhs);
+Number operator-(const Number& num);
+Number operator*(const Number& lhs, const Number& rhs);
+Number operator/(const Number& lhs, const Number& rhs);
+Number operator%(const Number& lhs, const Number& rhs);
+// lhs to the power of rhs, stays exact for integer powers
+Number operator^(const Number& lhs, const Number& rhs);
+bool operator==(const Number& lhs, const Number& rhs);
+
+}  // namespace picolator::math
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "polynomial.h"
+
+#include <algorithm>
+
+#include "math_util.h"
+
+using picolator::math::Error;
+using picolator::math::Number;
+using picolator::math::Polynomial;
+
+// Order terms by their powers, rational terms have both powers at 0
+static bool termLess(const Number& lhs, const Number& rhs) {
+  if (lhs.pi_pow != rhs.pi_pow) return lhs.pi_pow > rhs.pi_pow;
+  return lhs.e_pow > rhs.e_pow;
+}
+
+Polynomial::Polynomial(const Number& term) {
+  if (!term.isMonomial()) {
+    raise(Error::typeError(__func__, "Const"));
+    return;
+  }
+  if (term.num != 0) terms_.push_back(term);
+}
+
+bool Polynomial::addTerm(const Number& term) {
+  if (term.num == 0) return true;
+
+  auto it = std::lower_bound(terms_.begin(), terms_.end(), term, termLess);
+  if (it != terms_.end() && it->samePowers(term)) {
+    Number sum = *it + term;
+    if (sum.kind == Number::Kind::BIG) return false;
+    if (sum.num == 0) {
+      terms_.erase(it);
+    } else {
+      *it = sum;
+    }
+    return true;
+  }
+  if (terms_.size() == MAX_TERMS) return false;
+  terms_.insert(it, term);
+  return true;
+}
+
+double Polynomial::getValue() const {
+  double value = 0;
+  for (const auto& term : terms_) value += term.getValue();
+  return value;
+}
+
+std::string Polynomial::toString() const {
+  if (terms_.empty()) return "0";
+
+  std::string res;
+  for (const auto& term : terms_) {
+    std::string str = term.toString();
+    if (!res.empty() && str[0] != '-') res += "+";
+    res += str;
+  }
+  return res;
+}
+
+std::optional<Polynomial> Polynomial::negate() const {
+  Polynomial res;
+  for (const auto& term : terms_) {
+    Number neg = -term;
+    if (neg.kind == Number::Kind::BIG) return std::nullopt;
+    res.terms_.push_back(neg);
+  }
+  return res;
+}
+
+std::optional<Polynomial> Polynomial::add(const Polynomial& lhs,
+                                          const Polynomial& rhs) {
+  Polynomial res = lhs;
+  for (const auto& term : rhs.terms_) {
+    if (!res.addTerm(term)) return std::nullopt;
+  }
+  return res;
+}
+
+std::optional<Polynomial> Polynomial::mul(const Polynomial& lhs,
+                                          const Polynomial& rhs) {
+  Polynomial res;
+  for (const auto& lhs_term : lhs.terms_) {
+    for (const auto& rhs_term : rhs.terms_) {
+      Number product = lhs_term * rhs_term;
+      if (product.kind == Number::Kind::BIG || !res.addTerm(product)) {
+        return std::nullopt;
+      }
+    }
+  }
+  return res;
+}
+
+std::optional<Polynomial> Polynomial::div(const Polynomial& lhs,
+                                          const Polynomial& rhs) {
+  if (rhs.terms_.empty()) {
+    raise(Error::divideByZero());
+    return std::nullopt;
+  }
+  if (rhs.terms_.size() != 1) return std::nullopt;
+
+  Polynomial res;
+  for (const auto& term : lhs.terms_) {
+    Number quotient = term / rhs.terms_[0];
+    if (quotient.kind == Number::Kind::BIG) return std::nullopt;
+    res.terms_.push_back(quotient);
+  }
+  return res;
+}
@@ -0,0 +1,58 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "number.h"
+
+namespace picolator::math {
+
+/**
+ * @brief Exact sum of monomials over pi and e, ie 2 + 3pi - e/2.
+ *
+ * Terms are kept sorted by their powers with at most one term per pair of
+ * powers and no zero terms. Every op returns nullopt if a coefficient
+ * overflows or the result would need more then MAX_TERMS terms, the caller
+ * should fall back to doubles then.
+ */
+class Polynomial {
+ public:
+  static constexpr size_t MAX_TERMS = 8;
+
+ private:
+  std::vector<Number> terms_;
+
+  // Adds term to the sum, false if it overflowed
+  bool addTerm(const Number& term);
+
+ public:
+  Polynomial() = default;
+  // term has to be a monomial
+  explicit Polynomial(const Number& term);
+
+  inline const std::vector<Number>& terms() const { return terms_; }
+
+  double getValue() const;
+  std::string toString() const;
+
+  std::optional<Polynomial> negate() const;
+  static std::optional<Polynomial> add(const Polynomial& lhs,
+                                       const Polynomial& rhs);
+  static std::optional<Polynomial> mul(const Polynomial& lhs,
+                                       const Polynomial& rhs);
+  // Only works when rhs is a single term
+  static std::optional<Polynomial> div(const Polynomial& lhs,
+                                       const Polynomial& rhs);
+};
+
+}  // namespace picolator::math
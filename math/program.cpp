@@ -0,0 +1,298 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "program.h"
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "math_util.h"
+#include "real_math.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::Error;
+using picolator::math::EvalEnvironment;
+using picolator::math::Fixed;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::RealMath;
+using picolator::math::UnaryOperator;
+
+void Program::emit(OpCode op, uint16_t arg, int stack_change) {
+  code_.emplace_back(Instruction{op, arg});
+  cur_stack_ += stack_change;
+  if (cur_stack_ > max_stack_) max_stack_ = cur_stack_;
+}
+
+void Program::pushLiteral(const Literals& literal) {
+  if (literals_.size() > std::numeric_limits<uint16_t>::max()) {
+    raise(Error::syntax("Too Long", code_.size()));
+    return;
+  }
+  literals_.emplace_back(literal);
+  emit(OpCode::PUSH_LITERAL, literals_.size() - 1, 1);
+}
+
+void Program::loadVariable(char variable) {
+  emit(OpCode::LOAD_SLOT, EvalEnvironment::variableSlot(variable), 1);
+}
+
+void Program::loadAns() {
+  emit(OpCode::LOAD_SLOT, EvalEnvironment::ANS_SLOT, 1);
+}
+
+void Program::binary(BinaryOperator::Type op) {
+  emit(OpCode::BINARY, static_cast<uint16_t>(op), -1);
+}
+
+void Program::unary(UnaryOperator::Type op) {
+  emit(OpCode::UNARY, static_cast<uint16_t>(op), 0);
+}
+
+uint16_t Program::storeTemp() {
+  emit(OpCode::STORE_TEMP, temps_, 0);
+  return temps_++;
+}
+
+void Program::loadTemp(uint16_t slot) { emit(OpCode::LOAD_TEMP, slot, 1); }
+
+Literals Program::run(const EvalEnvironment& env) const {
+  if (code_.empty()) {
+    raise(Error::syntax("", 0));
+    return Literals(0);
+  }
+
+  std::vector<Literals> stack;
+  stack.reserve(max_stack_);
+  // Slots are always stored in order so temps[arg] is added by its store
+  std::vector<Literals> temps;
+  temps.reserve(temps_);
+
+  for (const auto& ins : code_) {
+    switch (ins.op) {
+      case OpCode::PUSH_LITERAL:
+        stack.emplace_back(literals_[ins.arg]);
+        break;
+      case OpCode::LOAD_SLOT:
+        stack.emplace_back(env.slot(ins.arg));
+        break;
+      case OpCode::BINARY:
+        // The result replaces lhs and rhs is dropped
+        BinaryOperator::solveInPlace(
+            static_cast<BinaryOperator::Type>(ins.arg),
+            stack[stack.size() - 2], stack.back());
+        stack.pop_back();
+        break;
+      case OpCode::UNARY:
+        stack.back() = UnaryOperator::solve(
+            static_cast<UnaryOperator::Type>(ins.arg), stack.back());
+        break;
+      case OpCode::STORE_TEMP:
+        temps.emplace_back(stack.back());
+        break;
+      case OpCode::LOAD_TEMP:
+        stack.emplace_back(temps[ins.arg]);
+        break;
+    }
+    // Without exceptions the ops just return 0 on an error, stop there
+    if (hasError()) break;
+    if (env.cancelled()) {
+      raise(Error::cancelled());
+      break;
+    }
+  }
+  return std::move(stack.back());
+}
+
+template <typename Real>
+static bool isWhole(Real x) {
+  double d = RealMath<Real>::toDouble(x);
+  return std::floor(d) == d;
+}
+
+template <typename Real>
+static Real solveBinary(BinaryOperator::Type op, Real lhs, Real rhs) {
+  using M = RealMath<Real>;
+  switch (op) {
+    case BinaryOperator::Type::ADDITION:
+      return lhs + rhs;
+    case BinaryOperator::Type::SUBTRACTION:
+      return lhs - rhs;
+    case BinaryOperator::Type::MULTIPLICATION:
+      return lhs * rhs;
+    case BinaryOperator::Type::DIVISION:
+      if (rhs == Real(0)) {
+        raise(Error::divideByZero());
+        return Real(0);
+      }
+      return lhs / rhs;
+    case BinaryOperator::Type::EXPONENT:
+      if (lhs == Real(0) && rhs == Real(0)) {
+        raise(Error::domain("exp"));
+        return Real(0);
+      }
+      // Only complex answers, EXACT would give one
+      if (lhs < Real(0) && !isWhole(rhs)) {
+        raise(Error::domain("exp"));
+        return Real(0);
+      }
+      return M::pow(lhs, rhs);
+    case BinaryOperator::Type::N_TH_ROOT:
+      if (lhs == Real(0)) {
+        raise(Error::domain("n_sqrt()"));
+        return Real(0);
+      }
+      // Odd roots of negatives stay real like Literals, even ones are complex
+      if (rhs < Real(0)) {
+        if (!isWhole(lhs) || std::fmod(M::toDouble(lhs), 2) == 0) {
+          raise(Error::domain("n_sqrt()"));
+          return Real(0);
+        }
+        return -M::pow(-rhs, Real(1) / lhs);
+      }
+      // This is meant to be backwards
+      return M::pow(rhs, Real(1) / lhs);
+    case BinaryOperator::Type::MODULUS:
+      if (rhs == Real(0)) {
+        raise(Error::divideByZero());
+        return Real(0);
+      }
+      return M::fmod(lhs, rhs);
+  }
+  raise(Error::notImplemented(__func__));
+  return Real(0);
+}
+
+template <typename Real>
+static Real solveUnary(UnaryOperator::Type op, Real input) {
+  using M = RealMath<Real>;
+  switch (op) {
+    case UnaryOperator::Type::MINUS:
+      return -input;
+    case UnaryOperator::Type::SIN:
+      return M::sin(input);
+    case UnaryOperator::Type::COS:
+      return M::cos(input);
+    case UnaryOperator::Type::TAN:
+      return M::tan(input);
+    case UnaryOperator::Type::ARCSIN:
+      return M::asin(input);
+    case UnaryOperator::Type::ARCCOS:
+      return M::acos(input);
+    case UnaryOperator::Type::ARCTAN:
+      return M::atan(input);
+    case UnaryOperator::Type::SQUARE_ROOT:
+      if (input < Real(0)) {
+        raise(Error::domain("sqrt"));
+        return Real(0);
+      }
+      return M::sqrt(input);
+    case UnaryOperator::Type::LN:
+      if (input <= Real(0)) {
+        raise(Error::domain("ln"));
+        return Real(0);
+      }
+      return M::log(input);
+    default:
+      raise(Error::notImplemented(__func__));
+      return Real(0);
+  }
+}
+
+// The real backends have nowhere to put an imaginary part, dropping it would
+// give a wrong answer instead of an error
+template <typename Real>
+static Real loadReal(const Literals& literal) {
+  if (literal.isComplex()) {
+    raise(Error::typeError("Real", "Cplx"));
+    return Real(0);
+  }
+  return RealMath<Real>::fromDouble(literal.getValue());
+}
+
+template <typename Real>
+Real Program::runAs(const EvalEnvironment& env) const {
+  if (code_.empty()) {
+    raise(Error::syntax("", 0));
+    return Real(0);
+  }
+
+  std::vector<Real> stack;
+  stack.reserve(max_stack_);
+  std::vector<Real> temps;
+  temps.reserve(temps_);
+
+  for (const auto& ins : code_) {
+    switch (ins.op) {
+      case OpCode::PUSH_LITERAL:
+        stack.push_back(loadReal<Real>(literals_[ins.arg]));
+        break;
+      case OpCode::LOAD_SLOT:
+        stack.push_back(loadReal<Real>(env.slot(ins.arg)));
+        break;
+      case OpCode::BINARY: {
+        Real rhs = stack.back();
+        stack.pop_back();
+        stack.back() = solveBinary(static_cast<BinaryOperator::Type>(ins.arg),
+                                   stack.back(), rhs);
+        break;
+      }
+      case OpCode::UNARY:
+        stack.back() = solveUnary(static_cast<UnaryOperator::Type>(ins.arg),
+                                  stack.back());
+        break;
+      case OpCode::STORE_TEMP:
+        temps.push_back(stack.back());
+        break;
+      case OpCode::LOAD_TEMP:
+        stack.push_back(temps[ins.arg]);
+        break;
+    }
+    // Anything the checks above missed, ie inf - inf, is still not an answer
+    if (RealMath<Real>::isNan(stack.back())) raise(Error::domain("NaN"));
+    if (hasError()) break;
+    if (env.cancelled()) {
+      raise(Error::cancelled());
+      break;
+    }
+  }
+  return stack.back();
+}
+
+template double Program::runAs<double>(const EvalEnvironment&) const;
+template float Program::runAs<float>(const EvalEnvironment&) const;
+template Fixed Program::runAs<Fixed>(const EvalEnvironment&) const;
+
+Literals Program::run(Mode mode, const EvalEnvironment& env) const {
+  switch (mode) {
+    case Mode::DOUBLE:
+      return Literals(runAs<double>(env));
+    case Mode::FLOAT:
+      return Literals(RealMath<float>::toDouble(runAs<float>(env)));
+    case Mode::FIXED:
+      return Literals(RealMath<Fixed>::toDouble(runAs<Fixed>(env)));
+    default:
+      return run(env);
+  }
+}
+
+const char* picolator::math::modeName(Program::Mode mode) {
+  switch (mode) {
+    case Program::Mode::DOUBLE:
+      return "DOUBLE";
+    case Program::Mode::FLOAT:
+      return "FLOAT";
+    case Program::Mode::FIXED:
+      return "FIXED";
+    default:
+      return "EXACT";
+  }
+}
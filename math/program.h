@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "binary_operator.h"
+#include "eval_environment.h"
+#include "fixed.h"
+#include "literals.h"
+#include "unary_operator.h"
+
+namespace picolator::math {
+
+/**
+ * @brief A solved ExprTree lowered into a flat list of postfix instructions
+ * for a small stack machine. The program holds no results so it can be run
+ * as many times as needed, ie once per x value when graphing.
+ */
+class Program {
+ public:
+  enum class OpCode : uint8_t {
+    PUSH_LITERAL,   // push literals_[arg]
+    LOAD_SLOT,      // push EvalEnvironment slot arg (ANS or a variable)
+    BINARY,         // pop rhs and lhs, push lhs op rhs (arg is the op type)
+    UNARY,          // pop input, push op input (arg is the op type)
+    STORE_TEMP,     // copy the top of the stack into temp slot arg
+    LOAD_TEMP       // push temp slot arg
+  };
+
+  // What run(Mode) evaluates with. EXACT is the normal Literals math, the
+  // rest trade precision for speed when graphing or making tables
+  enum class Mode : uint8_t { EXACT, DOUBLE, FLOAT, FIXED, COUNT };
+
+  struct Instruction {
+    OpCode op;
+    uint16_t arg;
+  };
+
+ private:
+  std::vector<Instruction> code_ = {};
+  std::vector<Literals> literals_ = {};
+
+  // Deepest the stack gets so run() only allocates it once
+  size_t max_stack_ = 0;
+  size_t cur_stack_ = 0;
+
+  // Number of temp slots used for values that are needed more then once
+  uint16_t temps_ = 0;
+
+  void emit(OpCode op, uint16_t arg, int stack_change);
+
+ public:
+  void pushLiteral(const Literals& literal);
+  // Binds to the variable's slot now, an unknown name is a compile error
+  void loadVariable(char variable);
+  void loadAns();
+  void binary(BinaryOperator::Type op);
+  void unary(UnaryOperator::Type op);
+
+  // Saves the top of the stack and returns the slot it was saved in
+  uint16_t storeTemp();
+  void loadTemp(uint16_t slot);
+
+  const std::vector<Instruction>& getCode() const { return code_; }
+  bool empty() const { return code_.empty(); }
+
+  /**
+   * @brief Runs the program. Nothing outside of env is read so programs can
+   * run at the same time as long as nobody writes to env
+   *
+   * @param env values of the variables and ANS
+   * @return Literals the unreduced result
+   */
+  Literals run(const EvalEnvironment& env = EvalEnvironment::empty()) const;
+
+  /**
+   * @brief Runs the program with plain Real math, variables and literals are
+   * converted to Real when they are loaded. A complex value raises a type
+   * error since Real has no imaginary part
+   *
+   * @tparam Real double, float or Fixed
+   */
+  template <typename Real>
+  Real runAs(const EvalEnvironment& env = EvalEnvironment::empty()) const;
+
+  // run() for EXACT, otherwise runAs with the matching type
+  Literals run(Mode mode,
+               const EvalEnvironment& env = EvalEnvironment::empty()) const;
+};
+
+extern template double Program::runAs<double>(const EvalEnvironment&) const;
+extern template float Program::runAs<float>(const EvalEnvironment&) const;
+extern template Fixed Program::runAs<Fixed>(const EvalEnvironment&) const;
+
+// Shown on the lcd when the mode changes
+const char* modeName(Program::Mode mode);
+}  // namespace picolator::math
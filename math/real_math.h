@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cmath>
+
+#include "fixed.h"
+#include "math_util.h"
+
+namespace picolator::math {
+
+/**
+ * @brief The math functions Program::runAs needs for each real type. The
+ * double and float ones don't check their inputs, runAs raises the domain
+ * errors before calling them and on any NaN they still return.
+ */
+template <typename Real>
+struct RealMath;
+
+template <>
+struct RealMath<double> {
+  static constexpr const char* name = "double";
+  static double fromDouble(double d) { return d; }
+  static double toDouble(double d) { return d; }
+  static bool isNan(double d) { return std::isnan(d); }
+  static double sin(double x) { return std::sin(x); }
+  static double cos(double x) { return std::cos(x); }
+  static double tan(double x) { return std::tan(x); }
+  static double asin(double x) { return std::asin(x); }
+  static double acos(double x) { return std::acos(x); }
+  static double atan(double x) { return std::atan(x); }
+  static double sqrt(double x) { return std::sqrt(x); }
+  static double log(double x) { return std::log(x); }
+  static double pow(double x, double y) { return std::pow(x, y); }
+  static double fmod(double x, double y) { return std::fmod(x, y); }
+};
+
+// sinf and friends are single precision all the way down so they are a lot
+// cheaper in soft float
+template <>
+struct RealMath<float> {
+  static constexpr const char* name = "float";
+  static float fromDouble(double d) { return static_cast<float>(d); }
+  static double toDouble(float f) { return f; }
+  static bool isNan(float f) { return std::isnan(f); }
+  static float sin(float x) { return sinf(x); }
+  static float cos(float x) { return cosf(x); }
+  static float tan(float x) { return tanf(x); }
+  static float asin(float x) { return asinf(x); }
+  static float acos(float x) { return acosf(x); }
+  static float atan(float x) { return atanf(x); }
+  static float sqrt(float x) { return sqrtf(x); }
+  static float log(float x) { return logf(x); }
+  static float pow(float x, float y) { return powf(x, y); }
+  static float fmod(float x, float y) { return fmodf(x, y); }
+};
+
+template <>
+struct RealMath<Fixed> {
+  static constexpr const char* name = "Q32.32";
+  static Fixed fromDouble(double d) { return Fixed(d); }
+  static double toDouble(Fixed f) { return static_cast<double>(f); }
+  // Saturates instead
+  static bool isNan(Fixed) { return false; }
+  static Fixed sin(Fixed x) { return picolator::math::sin(x); }
+  static Fixed cos(Fixed x) { return picolator::math::cos(x); }
+  static Fixed tan(Fixed x) { return picolator::math::tan(x); }
+  static Fixed asin(Fixed x) { return picolator::math::asin(x); }
+  static Fixed acos(Fixed x) { return picolator::math::acos(x); }
+  static Fixed atan(Fixed x) { return picolator::math::atan(x); }
+  static Fixed sqrt(Fixed x) { return picolator::math::sqrt(x); }
+  static Fixed log(Fixed x) { return picolator::math::log(x); }
+  static Fixed pow(Fixed x, Fixed y) { return picolator::math::pow(x, y); }
+  static Fixed fmod(Fixed x, Fixed y) { return picolator::math::fmod(x, y); }
+};
+
+}  // namespace picolator::math
@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "token.h"
+
+#include <array>
+#include <string>
+#include <utility>
+
+#include "literals_piece.h"
+#include "math_util.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::Bracket;
+using picolator::math::Error;
+using picolator::math::Letter;
+using picolator::math::Literals;
+using picolator::math::LiteralsPiece;
+using picolator::math::TokenId;
+using picolator::math::TokenInfo;
+using picolator::math::UnaryOperator;
+
+static std::shared_ptr<Letter> createLetter(const TokenInfo& info) {
+  switch (info.classification) {
+    case Letter::Classification::LITERAL_PIECE:
+      return std::make_shared<LiteralsPiece>(info.symbol[0]);
+    case Letter::Classification::BINARY:
+      return std::make_shared<BinaryOperator>(
+          std::string(info.symbol),
+          static_cast<BinaryOperator::Type>(info.type));
+    case Letter::Classification::UNARY:
+      return std::make_shared<UnaryOperator>(
+          std::string(info.symbol),
+          static_cast<UnaryOperator::Type>(info.type));
+    case Letter::Classification::LITERAL:
+      return std::make_shared<Literals>(
+          static_cast<Literals::Type>(info.type));
+    case Letter::Classification::BRACKET:
+      return std::make_shared<Bracket>(static_cast<Bracket::Type>(info.type));
+    default:
+      picolator::math::raise(Error::notImplemented(__func__));
+      return nullptr;
+  }
+}
+
+// Each letter is a function local static so it is still only built the first
+// time it is used, and two threads using it for the first time at once is
+// safe (the compiler guards the initialization)
+template <TokenId id>
+static const std::shared_ptr<Letter>& cachedToken() {
+  static const std::shared_ptr<Letter> letter = createLetter(tokenInfo(id));
+  return letter;
+}
+
+template <char name>
+static const std::shared_ptr<Letter>& cachedVariable() {
+  static const std::shared_ptr<Letter> letter =
+      std::make_shared<Literals>(name);
+  return letter;
+}
+
+using LetterGetter = const std::shared_ptr<Letter>& (*)();
+
+template <size_t... ids>
+static constexpr std::array<LetterGetter, sizeof...(ids)> tokenGetters(
+    std::index_sequence<ids...>) {
+  return {&cachedToken<static_cast<TokenId>(ids)>...};
+}
+
+template <size_t... idx>
+static constexpr std::array<LetterGetter, sizeof...(idx)> variableGetters(
+    std::index_sequence<idx...>) {
+  return {&cachedVariable<static_cast<char>('A' + idx)>...};
+}
+
+// Never filled, handed back for ids that don't have a letter
+static const std::shared_ptr<Letter> no_letter;
+
+const std::shared_ptr<Letter>& picolator::math::tokenLetter(TokenId id) {
+  static constexpr auto getters = tokenGetters(
+      std::make_index_sequence<static_cast<size_t>(TokenId::COUNT)>());
+
+  if (id == TokenId::NONE || id >= TokenId::COUNT) {
+    picolator::math::raise(Error::notImplemented(__func__));
+    return no_letter;
+  }
+  return getters[static_cast<size_t>(id)]();
+}
+
+const std::shared_ptr<Letter>& picolator::math::variableLetter(char name) {
+  static constexpr auto getters =
+      variableGetters(std::make_index_sequence<Literals::VARIABLE_COUNT>());
+
+  if (name < 'A' || name >= 'A' + Literals::VARIABLE_COUNT) {
+    picolator::math::raise(Error::domain("Var doesn't exist"));
+    return no_letter;
+  }
+  return getters[name - 'A']();
+}
@@ -0,0 +1,178 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "binary_operator.h"
+#include "bracket.h"
+#include "letter.h"
+#include "literals.h"
+#include "unary_operator.h"
+
+namespace picolator::math {
+
+// Every letter that can be typed on the keypad
+enum class TokenId : uint8_t {
+  NONE,
+  DIGIT_0,
+  DIGIT_1,
+  DIGIT_2,
+  DIGIT_3,
+  DIGIT_4,
+  DIGIT_5,
+  DIGIT_6,
+  DIGIT_7,
+  DIGIT_8,
+  DIGIT_9,
+  DECIMAL,
+  // Binary ops
+  ADD,
+  SUB,
+  MUL,
+  DIV,
+  MOD,
+  EXP,
+  N_TH_ROOT,
+  // Unary ops
+  MINUS,
+  SIN,
+  COS,
+  TAN,
+  ASIN,
+  ACOS,
+  ATAN,
+  LN,
+  SQRT,
+  // Literals
+  PI,
+  E,
+  ANS,
+  I,
+  // Brackets
+  OPEN,
+  CLOSED,
+  COUNT
+};
+
+/**
+ * @brief Everything needed to build the Letter for a token. Lives in flash,
+ * type is the BinaryOperator, UnaryOperator, Literals or Bracket type that
+ * matches the classification
+ */
+struct TokenInfo {
+  TokenId id;
+  std::string_view symbol;
+  Letter::Classification classification;
+  uint8_t type;
+};
+
+namespace token_table {
+using C = Letter::Classification;
+
+constexpr TokenInfo piece(TokenId id, std::string_view symbol) {
+  return {id, symbol, C::LITERAL_PIECE, 0};
+}
+constexpr TokenInfo binary(TokenId id, std::string_view symbol,
+                           BinaryOperator::Type type) {
+  return {id, symbol, C::BINARY, static_cast<uint8_t>(type)};
+}
+constexpr TokenInfo unary(TokenId id, std::string_view symbol,
+                          UnaryOperator::Type type) {
+  return {id, symbol, C::UNARY, static_cast<uint8_t>(type)};
+}
+constexpr TokenInfo literal(TokenId id, std::string_view symbol,
+                            Literals::Type type) {
+  return {id, symbol, C::LITERAL, static_cast<uint8_t>(type)};
+}
+constexpr TokenInfo bracket(TokenId id, std::string_view symbol,
+                            Bracket::Type type) {
+  return {id, symbol, C::BRACKET, static_cast<uint8_t>(type)};
+}
+}  // namespace token_table
+
+// Indexed by TokenId
+constexpr TokenInfo TOKENS[] = {
+    {TokenId::NONE, "", Letter::Classification::FUNCTION, 0},
+    token_table::piece(TokenId::DIGIT_0, "0"),
+    token_table::piece(TokenId::DIGIT_1, "1"),
+    token_table::piece(TokenId::DIGIT_2, "2"),
+    token_table::piece(TokenId::DIGIT_3, "3"),
+    token_table::piece(TokenId::DIGIT_4, "4"),
+    token_table::piece(TokenId::DIGIT_5, "5"),
+    token_table::piece(TokenId::DIGIT_6, "6"),
+    token_table::piece(TokenId::DIGIT_7, "7"),
+    token_table::piece(TokenId::DIGIT_8, "8"),
+    token_table::piece(TokenId::DIGIT_9, "9"),
+    token_table::piece(TokenId::DECIMAL, "."),
+    token_table::binary(TokenId::ADD, "+", BinaryOperator::Type::ADDITION),
+    token_table::binary(TokenId::SUB, "-", BinaryOperator::Type::SUBTRACTION),
+    token_table::binary(TokenId::MUL, "*",
+                        BinaryOperator::Type::MULTIPLICATION),
+    token_table::binary(TokenId::DIV, "/", BinaryOperator::Type::DIVISION),
+    token_table::binary(TokenId::MOD, "%", BinaryOperator::Type::MODULUS),
+    token_table::binary(TokenId::EXP, "^", BinaryOperator::Type::EXPONENT),
+    token_table::binary(TokenId::N_TH_ROOT, "^\xE8",
+                        BinaryOperator::Type::N_TH_ROOT),
+    token_table::unary(TokenId::MINUS, "-", UnaryOperator::Type::MINUS),
+    token_table::unary(TokenId::SIN, "sin", UnaryOperator::Type::SIN),
+    token_table::unary(TokenId::COS, "cos", UnaryOperator::Type::COS),
+    token_table::unary(TokenId::TAN, "tan", UnaryOperator::Type::TAN),
+    token_table::unary(TokenId::ASIN, "asin", UnaryOperator::Type::ARCSIN),
+    token_table::unary(TokenId::ACOS, "acos", UnaryOperator::Type::ARCCOS),
+    token_table::unary(TokenId::ATAN, "atan", UnaryOperator::Type::ARCTAN),
+    token_table::unary(TokenId::LN, "ln", UnaryOperator::Type::LN),
+    token_table::unary(TokenId::SQRT, "\xE8",
+                       UnaryOperator::Type::SQUARE_ROOT),
+    token_table::literal(TokenId::PI, "\xF7", Literals::Type::PI),
+    token_table::literal(TokenId::E, "e", Literals::Type::E),
+    token_table::literal(TokenId::ANS, "ANS", Literals::Type::ANS),
+    token_table::literal(TokenId::I, "i", Literals::Type::COMPLEX),
+    token_table::bracket(TokenId::OPEN, "(", Bracket::Type::OPEN),
+    token_table::bracket(TokenId::CLOSED, ")", Bracket::Type::CLOSED),
+};
+
+constexpr bool tokensInOrder() {
+  for (size_t i = 0; i < static_cast<size_t>(TokenId::COUNT); i++) {
+    if (static_cast<size_t>(TOKENS[i].id) != i) return false;
+  }
+  return true;
+}
+static_assert(sizeof(TOKENS) / sizeof(TokenInfo) ==
+              static_cast<size_t>(TokenId::COUNT));
+static_assert(tokensInOrder(), "TOKENS has to be in TokenId order");
+
+constexpr const TokenInfo& tokenInfo(TokenId id) {
+  return TOKENS[static_cast<size_t>(id)];
+}
+
+/**
+ * @brief Returns the Letter for a token. It is only built the first time the
+ * token is used and is shared by every equation after that, so the keypad
+ * doesn't cost any RAM until it gets pressed. Safe to call from more then one
+ * thread.
+ *
+ * @param id Any token except NONE and COUNT, those raise NOT_IMPLEMENTED
+ * and give null
+ * @return const std::shared_ptr<Letter>&
+ */
+const std::shared_ptr<Letter>& tokenLetter(TokenId id);
+
+/**
+ * @brief tokenLetter for the variables, built the first time each one is used
+ *
+ * @param name 'A' to 'F', anything else raises a domain error and gives null
+ * @return const std::shared_ptr<Letter>&
+ */
+const std::shared_ptr<Letter>& variableLetter(char name);
+
+}  // namespace picolator::math
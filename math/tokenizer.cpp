@@ -0,0 +1,149 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include "tokenizer.h"
+
+#include <memory>
+#include <string>
+
+#include "binary_operator.h"
+#include "bracket.h"
+#include "equation.h"
+#include "literals.h"
+#include "literals_piece.h"
+#include "token.h"
+#include "unary_operator.h"
+
+using picolator::math::BigRational;
+using picolator::math::BinaryOperator;
+using picolator::math::Bracket;
+using picolator::math::Equation;
+using picolator::math::Letter;
+using picolator::math::Literals;
+using picolator::math::LiteralsPiece;
+using picolator::math::Number;
+using picolator::math::TokenId;
+using picolator::math::Tokenizer;
+using picolator::math::tokenLetter;
+using picolator::math::UnaryOperator;
+
+void Tokenizer::addDigit(char c) {
+  if (state_.ignore_rest) return;
+  if (c == '.') {
+    state_.ignore_rest = state_.has_decimal;
+    state_.has_decimal = true;
+    return;
+  }
+  if (state_.overflowed) return;
+
+  int64_t mantissa = 0;
+  if (__builtin_mul_overflow(state_.mantissa, 10, &mantissa) ||
+      __builtin_add_overflow(mantissa, c - '0', &mantissa)) {
+    state_.overflowed = true;
+    return;
+  }
+  state_.mantissa = mantissa;
+  if (state_.has_decimal) state_.exp--;
+}
+
+template <typename Letters>
+void Tokenizer::flushLiteral(const Letters& letters) {
+  Number number = state_.overflowed
+                      ? Number::big()
+                      : Number::decimal(state_.mantissa, state_.exp);
+  if (number.kind != Number::Kind::BIG) {
+    tokens_.push_back(std::make_shared<Literals>(number));
+  } else {
+    // Too many digits for the mantissa, only now is the text needed
+    std::string text(state_.literal_length, '0');
+    for (size_t i = 0; i < state_.literal_length; i++) {
+      const auto& piece = reinterpret_cast<const LiteralsPiece&>(
+          *letters[state_.literal_start + i]);
+      text[i] = static_cast<char>(piece.value_);
+    }
+    tokens_.push_back(
+        std::make_shared<Literals>(BigRational::parseDecimal(text)));
+  }
+
+  state_ = State();
+  state_.after_operand = true;
+}
+
+template <typename Letters>
+void Tokenizer::addLetter(const Letters& letters, size_t idx) {
+  const auto& l = letters[idx];
+
+  if (l->getClassification() == Letter::Classification::LITERAL_PIECE) {
+    if (state_.literal_length == 0) {
+      if (state_.after_operand) tokens_.push_back(tokenLetter(TokenId::MUL));
+      state_.literal_start = idx;
+    }
+    state_.literal_length++;
+    addDigit(static_cast<char>(
+        reinterpret_cast<const LiteralsPiece&>(*l).value_));
+    return;
+  }
+
+  if (state_.literal_length != 0) {
+    flushLiteral(letters);
+  }
+
+  bool is_bracket = l->getClassification() == Letter::Classification::BRACKET;
+  bool is_open = is_bracket && reinterpret_cast<const Bracket&>(*l).getType() ==
+                                   Bracket::Type::OPEN;
+  if (state_.after_operand &&
+      (is_open || l->getClassification() == Letter::Classification::LITERAL)) {
+    // add a mult symbol
+    tokens_.push_back(tokenLetter(TokenId::MUL));
+  }
+  state_.after_operand =
+      (is_bracket && !is_open) ||
+      l->getClassification() == Letter::Classification::LITERAL;
+
+  if (l->getClassification() == Letter::Classification::BINARY &&
+      reinterpret_cast<const BinaryOperator&>(*l).getType() ==
+          BinaryOperator::Type::SUBTRACTION) {
+    tokens_.push_back(tokenLetter(TokenId::ADD));
+    tokens_.push_back(tokenLetter(TokenId::MINUS));
+  } else {
+    tokens_.push_back(l);
+  }
+}
+
+void Tokenizer::add(const ExprVec& letters, size_t idx) {
+  addLetter(letters, idx);
+}
+
+void Tokenizer::add(const Equation& letters, size_t idx) {
+  addLetter(letters, idx);
+}
+
+void Tokenizer::finish(const ExprVec& letters) {
+  if (state_.literal_length != 0) {
+    flushLiteral(letters);
+  }
+}
+
+void Tokenizer::finish(const Equation& letters) {
+  if (state_.literal_length != 0) {
+    flushLiteral(letters);
+  }
+}
+
+Tokenizer::State Tokenizer::getState() const {
+  State state = state_;
+  state.tokens = tokens_.size();
+  return state;
+}
+
+void Tokenizer::restore(const State& state) {
+  tokens_.resize(state.tokens);
+  state_ = state;
+}
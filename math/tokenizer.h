@@ -0,0 +1,92 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "letter.h"
+
+namespace picolator::math {
+
+class Equation;
+
+/**
+ * @brief Turns the letters typed in on the keypad into tokens the ExprTree can
+ * parse. Joins LiteralsPieces into Literals, adds the implied * in 2(3) or 2pi
+ * and splits subtraction into + and a unary minus.
+ *
+ * Letters are added one at a time and the state between letters can be saved
+ * and restored so an edit only needs to re-tokenize what comes after it.
+ * Numbers are read a digit at a time, nothing is allocated except the tokens.
+ */
+class Tokenizer {
+ public:
+  using LetterPtr = std::shared_ptr<Letter>;
+  using ExprVec = std::vector<LetterPtr>;
+
+  // Everything needed to go back to the point before a letter was added
+  struct State {
+    size_t tokens = 0;
+    // index of the first LiteralsPiece of the number being read
+    size_t literal_start = 0;
+    size_t literal_length = 0;
+    // The number being read is mantissa * 10^exp, built a digit at a time so
+    // there is nothing left to parse when it ends
+    int64_t mantissa = 0;
+    int32_t exp = 0;
+    // Too many digits for mantissa, the number is read again as a BigRational
+    bool overflowed = false;
+    bool has_decimal = false;
+    // A second point was typed, like stod everything after it is ignored
+    bool ignore_rest = false;
+    // The last token was a number, literal or close bracket so a * goes
+    // before a number, literal or open bracket right after it
+    bool after_operand = false;
+  };
+
+ private:
+  ExprVec tokens_ = {};
+  State state_ = {};
+
+  // Adds one typed digit or point to the number being read
+  void addDigit(char c);
+
+  // Turns the LiteralsPieces being read into a Literals token. Letters is an
+  // ExprVec or an Equation
+  template <typename Letters>
+  void flushLiteral(const Letters& letters);
+
+  template <typename Letters>
+  void addLetter(const Letters& letters, size_t idx);
+
+ public:
+  /**
+   * @brief Tokenizes letters[idx]. Every letter before idx must have already
+   * been added
+   */
+  void add(const ExprVec& letters, size_t idx);
+  void add(const Equation& letters, size_t idx);
+
+  // Adds any number that is still being read, call after the last letter
+  void finish(const ExprVec& letters);
+  void finish(const Equation& letters);
+
+  State getState() const;
+
+  // Goes back to a state from getState(), the letters before the state must
+  // not have changed
+  void restore(const State& state);
+
+  const ExprVec& getTokens() const { return tokens_; }
+};
+}  // namespace picolator::math
@@ -15,11 +15,13 @@
 #include "literals.h"
 #include "math_util.h"
 
+using picolator::math::Complex;
+using picolator::math::Error;
 using picolator::math::Literals;
 using picolator::math::UnaryOperator;
 
-Literals UnaryOperator::solve(const Literals& input) {
-  switch (op_) {
+Literals UnaryOperator::solve(const Type& op, const Literals& input) {
+  switch (op) {
     case Type::MINUS:
       return -input;
     case Type::SIN:
@@ -35,10 +37,18 @@ Literals UnaryOperator::solve(const Literals& input) {
     case Type::ARCTAN:
       return picolator::math::parctan(input);
     case Type::SQUARE_ROOT:
-      if (input.getValue() < 0) throw DomainError("sqrt");
+      if (input.isComplex() || input.getValue() < 0) {
+        return Literals(Complex::sqrt(input.toComplex()));
+      }
       return sqrt(input.getValue());
     case Type::LN:
-      if (input.getValue() <= 0) throw DomainError("ln");
+      if (input.isZero()) {
+        raise(Error::domain("ln"));
+        return 0;
+      }
+      if (input.isComplex() || input.getValue() < 0) {
+        return Literals(Complex::log(input.toComplex()));
+      }
       return log(input.getValue());
     default:
       return 0;
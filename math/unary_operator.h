@@ -35,7 +35,8 @@ class UnaryOperator : public Letter {
   UnaryOperator(std::string symbol, const Type op)
       : Letter(symbol, Letter::Classification::UNARY, 2), op_(op) {}
 
-  const Type& getOp() { return op_; }
-  Literals solve(const Literals& input);
+  const Type& getOp() const { return op_; }
+  Literals solve(const Literals& input) const { return solve(op_, input); }
+  static Literals solve(const Type& op, const Literals& input);
 };
 }  // namespace picolator::math
@@ -0,0 +1,35 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <cstddef>
+
+namespace picolator::test {
+
+// Total number of calls to the global operator new since the program started
+size_t allocationCount();
+
+/**
+ * @brief Counts how many heap allocations happen while it is alive
+ *
+ * AllocCounter counter;
+ * tree.getValue();
+ * ASSERT_EQ(3, counter.count());
+ */
+class AllocCounter {
+ private:
+  size_t start_;
+
+ public:
+  AllocCounter() : start_(allocationCount()) {}
+
+  size_t count() const { return allocationCount() - start_; }
+};
+}  // namespace picolator::test
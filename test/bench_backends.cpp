@@ -0,0 +1,116 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "math/binary_operator.h"
+#include "math/bracket.h"
+#include "math/expr_tree.h"
+#include "math/fixed.h"
+#include "math/literals.h"
+#include "math/program.h"
+#include "math/real_math.h"
+#include "math/unary_operator.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::Bracket;
+using picolator::math::EvalEnvironment;
+using picolator::math::ExprTree;
+using picolator::math::Fixed;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::RealMath;
+using picolator::math::UnaryOperator;
+using LP = ExprTree::LetterPtr;
+
+static constexpr int kPoints = 2000;
+
+// f(A) the way a graph would be drawn
+static ExprTree buildTree(UnaryOperator::Type fn, const char* symbol) {
+  // fn(A)*A+A^2/3
+  return ExprTree(
+      {LP(new UnaryOperator(symbol, fn)), LP(new Bracket(Bracket::Type::OPEN)),
+       LP(new Literals('A')), LP(new Bracket(Bracket::Type::CLOSED)),
+       LP(new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION)),
+       LP(new Literals('A')),
+       LP(new BinaryOperator("+", BinaryOperator::Type::ADDITION)),
+       LP(new Literals('A')),
+       LP(new BinaryOperator("^", BinaryOperator::Type::EXPONENT)),
+       LP(new Literals(2)),
+       LP(new BinaryOperator("/", BinaryOperator::Type::DIVISION)),
+       LP(new Literals(3))});
+}
+
+/**
+ * @brief Runs the program over x from lo to hi and prints the time per run
+ * and the worst error against the double backend
+ */
+template <typename Real>
+static void report(const char* fn, const Program& program, double lo,
+                   double hi) {
+  double max_abs = 0, max_rel = 0, ns = 0;
+  EvalEnvironment env;
+  for (int i = 0; i < kPoints; i++) {
+    double x = lo + (hi - lo) * i / (kPoints - 1);
+    env.variable('A') = Literals(x);
+    double expected = program.runAs<double>(env);
+
+    auto start = std::chrono::steady_clock::now();
+    Real res = program.runAs<Real>(env);
+    auto end = std::chrono::steady_clock::now();
+    ns += std::chrono::duration<double, std::nano>(end - start).count();
+
+    double err = std::fabs(RealMath<Real>::toDouble(res) - expected);
+    max_abs = std::max(max_abs, err);
+    if (std::fabs(expected) > 1e-3) {
+      max_rel = std::max(max_rel, err / std::fabs(expected));
+    }
+  }
+  printf("%-6s %-7s %8.1f ns/run  max abs %.2e  max rel %.2e\n", fn,
+         RealMath<Real>::name, ns / kPoints, max_abs, max_rel);
+}
+
+TEST(BackendBench, Accuracy) {
+  struct Case {
+    UnaryOperator::Type fn;
+    const char* symbol;
+    double lo, hi;
+  };
+  const Case cases[] = {
+      {UnaryOperator::Type::SIN, "sin", -10, 10},
+      {UnaryOperator::Type::ARCTAN, "atan", -10, 10},
+      {UnaryOperator::Type::SQUARE_ROOT, "sqrt", 0, 100},
+      {UnaryOperator::Type::LN, "ln", 0.01, 100},
+  };
+  for (const auto& c : cases) {
+    ExprTree tree = buildTree(c.fn, c.symbol);
+    report<double>(c.symbol, tree.getProgram(), c.lo, c.hi);
+    report<float>(c.symbol, tree.getProgram(), c.lo, c.hi);
+    report<Fixed>(c.symbol, tree.getProgram(), c.lo, c.hi);
+  }
+
+  // The exact path for comparison
+  ExprTree tree = buildTree(UnaryOperator::Type::SIN, "sin");
+  EvalEnvironment env;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kPoints; i++) {
+    env.variable('A') = Literals(-10 + 20.0 * i / (kPoints - 1));
+    tree.getProgram().run(env);
+  }
+  auto end = std::chrono::steady_clock::now();
+  printf("%-6s %-7s %8.1f ns/run\n", "sin", "exact",
+         std::chrono::duration<double, std::nano>(end - start).count() /
+             kPoints);
+}
@@ -0,0 +1,63 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+// Built into picolator_bench and picolator_bench_noexcept, run both to
+// compare the error path with and without exceptions
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include "math/error.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+#include "math/token.h"
+
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::TokenId;
+using picolator::math::tokenLetter;
+
+static constexpr int kRuns = 20000;
+
+// Average ns for ExprTree::evaluate on the equation, checks it fails or
+// works like expected
+static double timeEvaluate(const ExprTree::ExprVec& equation,
+                           bool should_fail) {
+  auto start = std::chrono::steady_clock::now();
+  int failed = 0;
+  for (int i = 0; i < kRuns; i++) {
+    failed += !ExprTree::evaluate(equation).ok();
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(failed, should_fail ? kRuns : 0);
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         kRuns;
+}
+
+TEST(ErrorBench, Evaluate) {
+  // A*2/3+1 is a normal solve, the others fail in the parser and while
+  // running
+  ExprTree::ExprVec good = {ExprTree::LetterPtr(new Literals('A'))};
+  for (TokenId id : {TokenId::MUL, TokenId::DIGIT_2, TokenId::DIV,
+                     TokenId::DIGIT_3, TokenId::ADD, TokenId::DIGIT_1}) {
+    good.push_back(tokenLetter(id));
+  }
+  ExprTree::ExprVec syntax = good;
+  syntax.push_back(tokenLetter(TokenId::ADD));
+  ExprTree::ExprVec domain = good;
+  domain.push_back(tokenLetter(TokenId::DIV));
+  domain.push_back(tokenLetter(TokenId::DIGIT_0));
+
+  printf("exceptions %s\n", PICOLATOR_EXCEPTIONS ? "on" : "off");
+  printf("%-8s %8.1f ns/run\n", "ok", timeEvaluate(good, false));
+  printf("%-8s %8.1f ns/run\n", "syntax", timeEvaluate(syntax, true));
+  printf("%-8s %8.1f ns/run\n", "domain", timeEvaluate(domain, true));
+}
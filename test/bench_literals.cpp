@@ -0,0 +1,246 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#include "alloc_counter.h"
+#include "math/binary_operator.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+#include "math/number.h"
+#include "math/unary_operator.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::Number;
+using picolator::math::UnaryOperator;
+using picolator::test::AllocCounter;
+
+static constexpr int kIterations = 100000;
+
+/**
+ * @brief Runs op iterations times and prints the time and heap
+ * allocations per call
+ *
+ * @return allocations per call
+ */
+template <typename Op>
+static double bench(const char* name, Op op, int iterations = kIterations) {
+  AllocCounter counter;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    op(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double ns =
+      std::chrono::duration<double, std::nano>(end - start).count() /
+      iterations;
+  double allocs = static_cast<double>(counter.count()) / iterations;
+  printf("%-28s %8.1f ns/op %6.2f allocs/op\n", name, ns, allocs);
+  return allocs;
+}
+
+TEST(LiteralsBench, Number_Ops) {
+  volatile double sink = 0;
+  Number two = Number::fromLong(2);
+  Number half = Number::fromDouble(0.5);
+  Number third = Number::fraction(1, 3);
+
+  ASSERT_EQ(0, bench("Number LONG +", [&](int i) {
+              sink = (Number::fromLong(i) + two).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number LONG *", [&](int i) {
+              sink = (Number::fromLong(i) * two).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DOUBLE +", [&](int i) {
+              sink = (Number::fromDouble(i) + half).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DOUBLE /", [&](int i) {
+              sink = (Number::fromDouble(i) / half).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number FRACTION +", [&](int i) {
+              sink = (Number::fraction(i, 7) + third).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number FRACTION /", [&](int i) {
+              sink = (Number::fraction(i, 7) / third).getValue();
+            }));
+}
+
+// Literals still carries the Letter symbol, values short enough for the
+// small string buffer shouldn't touch the heap either
+TEST(LiteralsBench, Literals_Ops) {
+  volatile double sink = 0;
+  Literals two(2);
+  Literals third(1, 3);
+  Literals a(7), b(3, 4);
+
+  ASSERT_EQ(0, bench("Literals LONG +", [&](int) {
+              sink = (a + two).getValue();
+            }));
+  ASSERT_EQ(0, bench("Literals FRACTION *", [&](int) {
+              sink = (b * third).getValue();
+            }));
+  ASSERT_EQ(0, bench("Literals FRACTION reduce", [&](int) {
+              sink = Literals(2, 6).reduce().getValue();
+            }));
+  bench("Literals copy", [&](int) {
+    Literals copy(b);
+    sink = copy.getValue();
+  });
+}
+
+// Overflowing ops pay for the BigRational, everything else should match
+// the Number_Ops numbers
+TEST(LiteralsBench, Big_Ops) {
+  volatile double sink = 0;
+  Literals big = Literals(2) ^ Literals(80);
+  Literals max(std::numeric_limits<long>::max());
+
+  bench("Literals LONG * overflow", [&](int) {
+    sink = (max * Literals(3)).getValue();
+  });
+  bench("Literals BIG +", [&](int) { sink = (big + big).getValue(); });
+  bench("Literals BIG / demote", [&](int) {
+    sink = (big / big).getValue();
+  });
+
+  // 4096 bit operands go through Karatsuba
+  picolator::math::BigInt a = picolator::math::BigInt::pow(3, 2600);
+  bench(
+      "BigInt 4096 bit *", [&](int) { sink = (a * a).limbs(); },
+      kIterations / 100);
+}
+
+// getValue on constants is cached instead of calling pow every time
+TEST(LiteralsBench, Constant_Ops) {
+  volatile double sink = 0;
+  Literals pi(Literals::Type::PI), e(Literals::Type::E);
+  Literals pi_e = pi * e;
+  Literals poly = Literals(1) + pi + e;
+
+  bench("Literals pi * e", [&](int) { sink = (pi * e).getValue(); });
+  bench("Literals pi*e getValue", [&](int) {
+    sink = pi_e.getValue();
+  });
+  bench("Number pi*e getValue", [&](int) {
+    sink = pi_e.getNumber().getValue();
+  });
+  bench("Literals 1+pi+e + pi", [&](int) {
+    sink = (poly + pi).getValue();
+  });
+}
+
+// Typed decimals against the double path they used to take
+TEST(LiteralsBench, Decimal_Ops) {
+  volatile double sink = 0;
+  Number price = Number::parseDecimal("19.99");
+  Number rate = Number::parseDecimal("0.13");
+  Number price_d = Number::fromDouble(19.99);
+  Number rate_d = Number::fromDouble(0.13);
+
+  ASSERT_EQ(0, bench("Number DECIMAL +", [&](int i) {
+              sink = (Number::decimal(i, -2) + price).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DOUBLE + (decimal)", [&](int i) {
+              sink = (Number::fromDouble(i / 100.0) + price_d).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DECIMAL *", [&](int i) {
+              sink = (Number::decimal(i, -2) * rate).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DOUBLE * (decimal)", [&](int i) {
+              sink = (Number::fromDouble(i / 100.0) * rate_d).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DECIMAL /", [&](int i) {
+              sink = (Number::decimal(i, -2) / rate).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DOUBLE / (decimal)", [&](int i) {
+              sink = (Number::fromDouble(i / 100.0) / rate_d).getValue();
+            }));
+  ASSERT_EQ(0, bench("Number DECIMAL ==", [&](int i) {
+              sink = Number::decimal(i, -2) == price;
+            }));
+  ASSERT_EQ(0, bench("Number parseDecimal", [&](int) {
+              sink = Number::parseDecimal("12345.678").getValue();
+            }));
+}
+
+// Symbols are only built when drawn, the getSymbol runs are what every
+// computed Literals used to pay
+TEST(LiteralsBench, Lazy_Symbol) {
+  volatile double sink = 0;
+  Literals x(1.0001), y(0.5);
+
+  ASSERT_EQ(0, bench("Literals DOUBLE *", [&](int) {
+              sink = (x * y).getValue();
+            }));
+  bench("Literals DOUBLE * + symbol", [&](int) {
+    Literals res = x * y;
+    sink = res.getSymbol().size();
+  });
+
+  // A*1.5+A*1.5+... with A a double, 16 ops per run
+  ExprTree::ExprVec equation;
+  for (int i = 0; i < 8; i++) {
+    if (i != 0) {
+      equation.emplace_back(
+          new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+    }
+    equation.emplace_back(new Literals('A'));
+    equation.emplace_back(
+        new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION));
+    equation.emplace_back(new Literals(1.5 + i));
+  }
+  ExprTree tree(equation);
+  picolator::math::EvalEnvironment env;
+  env.variable('A') = Literals(0.25);
+  const auto& program = tree.getProgram();
+
+  bench("Program 16 DOUBLE ops", [&](int) {
+    sink = program.run(env).getValue();
+  });
+  bench("Program 16 DOUBLE ops + symbol", [&](int) {
+    Literals res = program.run(env);
+    sink = res.getSymbol().size();
+  });
+}
+
+// Real expressions only pay one type check for complex support, the
+// Literals_Ops numbers shouldn't move
+TEST(LiteralsBench, Complex_Ops) {
+  volatile double sink = 0;
+  Literals imag(Literals::Type::COMPLEX);
+  Literals a = Literals(1) + Literals(2) * imag, b = Literals(3, 4) + imag;
+  Literals x(7), y(3, 4);
+
+  ASSERT_EQ(0, bench("Literals real FRACTION +", [&](int) {
+              sink = (x + y).getValue();
+            }));
+  ASSERT_EQ(0, bench("Literals COMPLEX +", [&](int) {
+              sink = (a + b).getValue();
+            }));
+  ASSERT_EQ(0, bench("Literals COMPLEX *", [&](int) {
+              sink = (a * b).getValue();
+            }));
+  ASSERT_EQ(0, bench("Literals COMPLEX /", [&](int) {
+              sink = (a / b).getValue();
+            }));
+  ASSERT_EQ(0, bench("Literals sqrt(-2)", [&](int) {
+              sink = UnaryOperator::solve(UnaryOperator::Type::SQUARE_ROOT,
+                                          Literals(-2))
+                         .getValue();
+            }));
+}
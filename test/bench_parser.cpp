@@ -0,0 +1,141 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "math/binary_operator.h"
+#include "math/equation.h"
+#include "math/expr_tree.h"
+#include "math/incremental_parser.h"
+#include "math/literals.h"
+#include "math/unary_operator.h"
+#include "parser_inputs.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::Equation;
+using picolator::math::ExprTree;
+using picolator::math::IncrementalParser;
+using picolator::math::Literals;
+using picolator::math::TokenId;
+using picolator::math::UnaryOperator;
+using picolator::test::nestedBrackets;
+using LP = ExprTree::LetterPtr;
+
+// "1^1^...^1" which is right associative so every ^ waits on the stack
+static ExprTree::ExprVec exponentChain(int depth) {
+  LP one(new Literals(1));
+  LP exp(new BinaryOperator("^", BinaryOperator::Type::EXPONENT));
+  ExprTree::ExprVec letters;
+  for (int i = 0; i < depth; i++) {
+    letters.emplace_back(one);
+    letters.emplace_back(exp);
+  }
+  letters.emplace_back(one);
+  return letters;
+}
+
+// "sin sin ... sin 0"
+static ExprTree::ExprVec unaryChain(int depth) {
+  ExprTree::ExprVec letters(
+      depth, LP(new UnaryOperator("sin", UnaryOperator::Type::SIN)));
+  letters.emplace_back(LP(new Literals(0)));
+  return letters;
+}
+
+// Builds "1+1+...+1" with tokens letters and returns the fastest of a few
+// parses in nanoseconds
+static int64_t timeParse(size_t tokens) {
+  LP one(new Literals(1));
+  LP add(new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+  ExprTree::ExprVec letters;
+  letters.emplace_back(one);
+  while (letters.size() + 2 <= tokens) {
+    letters.emplace_back(add);
+    letters.emplace_back(one);
+  }
+
+  int64_t best = INT64_MAX;
+  for (int i = 0; i < 5; i++) {
+    auto start = std::chrono::steady_clock::now();
+    ExprTree tree(letters);
+    auto end = std::chrono::steady_clock::now();
+    best = std::min<int64_t>(
+        best,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+  }
+  return best;
+}
+
+static void report(const char* name, const ExprTree::ExprVec& letters,
+                   int depth, double expected) {
+  auto start = std::chrono::steady_clock::now();
+  ExprTree tree(letters, depth + 1);
+  auto parsed = std::chrono::steady_clock::now();
+  double value = tree.getValue()->getValue();
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(value, expected);
+
+  // Building includes constant folding so most of the math happens there
+  printf("%-8s depth %6d  build %10.1f us  solve %10.1f us\n", name, depth,
+         std::chrono::duration<double, std::micro>(parsed - start).count(),
+         std::chrono::duration<double, std::micro>(end - parsed).count());
+}
+
+TEST(ParserBench, Deep_Nesting) {
+  for (int depth : {10, 100, 1000, 10000}) {
+    report("brackets", nestedBrackets(depth), depth, depth + 1);
+    report("exponent", exponentChain(depth), depth, 1);
+    report("unary", unaryChain(depth), depth, 0);
+  }
+}
+
+// 8 times the tokens should take ~8 times as long, quadratic would be ~64
+TEST(ParserBench, Parse_Time_Linear) {
+  int64_t small = timeParse(2001);
+  int64_t large = timeParse(16001);
+  printf("parse 2001 tokens %10lld ns  16001 tokens %10lld ns  x%.1f\n",
+         static_cast<long long>(small), static_cast<long long>(large),
+         static_cast<double>(large) / small);
+}
+
+// Types out "1+2+...+9+1+2..." one key at a time and times the preview per
+// key press, which should never hold a key up noticeably
+TEST(ParserBench, Preview_Typing) {
+  const size_t keys = 401;
+  IncrementalParser parser;
+  Equation equation;
+
+  int64_t worst = 0;
+  int64_t total = 0;
+  for (size_t i = 0; i < keys; i++) {
+    equation.push_back((i % 2) ? TokenId::ADD
+                               : static_cast<TokenId>(
+                                     static_cast<int>(TokenId::DIGIT_1) +
+                                     (i / 2) % 9));
+
+    auto start = std::chrono::steady_clock::now();
+    parser.update(equation);
+    auto end = std::chrono::steady_clock::now();
+    int64_t time =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    worst = std::max(worst, time);
+    total += time;
+  }
+  printf("preview %zu keys  average %6lld us  worst %6lld us\n", keys,
+         static_cast<long long>(total / keys), static_cast<long long>(worst));
+}
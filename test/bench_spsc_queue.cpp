@@ -0,0 +1,78 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <larrys_pico/key_event.h>
+#include <larrys_pico/spsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+
+// What it would be replacing, a deque behind a mutex
+class LockedQueue {
+ private:
+  std::mutex mutex_;
+  std::deque<KeyEvent> items_;
+
+ public:
+  bool push(const KeyEvent& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.size() >= 31) return false;
+    items_.push_back(item);
+    return true;
+  }
+  bool pop(KeyEvent& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.empty()) return false;
+    item = items_.front();
+    items_.pop_front();
+    return true;
+  }
+};
+
+// On the pico both ends run on core 0 (the scan timer interrupt and the main
+// loop) so this pushes a burst of events and drains them on one thread, what
+// is left is the cost of the queue itself
+template <typename Queue>
+static void report(const char* name) {
+  const uint32_t bursts = 200000;
+  const uint32_t burst = 16;
+  Queue queue;
+
+  auto start = std::chrono::steady_clock::now();
+  uint32_t popped = 0;
+  uint32_t last = 0;
+  for (uint32_t b = 0; b < bursts; b++) {
+    for (uint32_t i = 0; i < burst; i++) {
+      uint32_t time = b * burst + i;
+      queue.push({time, static_cast<uint8_t>(i % 5),
+                  static_cast<uint8_t>(i % 9), (i & 1) == 0, false});
+    }
+    KeyEvent event;
+    while (queue.pop(event)) {
+      last = event.time_ms;
+      popped++;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(popped, bursts * burst);
+  EXPECT_EQ(last, bursts * burst - 1);
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  printf("%-8s %8.1f M events/s  %6.2f ns/event\n", name,
+         popped / seconds / 1e6, seconds * 1e9 / popped);
+}
+
+TEST(SpscQueueBench, Throughput) {
+  report<SpscQueue<KeyEvent, 32>>("spsc");
+  report<LockedQueue>("mutex");
+}
@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include <larrys_pico/lcd_transport.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace picolator::test {
+
+/**
+ * @brief Models the I2C bus and the HD44780 behind the PCF8574, it keeps
+ * what the display would show and how long the bus was busy
+ */
+class FakeLcdBus : public LcdBus {
+ private:
+  uint8_t pins_ = 0;
+  bool four_bit_ = false;
+  bool high_nibble_ = true;
+  uint8_t byte_ = 0;
+  bool cgram_ = false;
+  uint8_t address_ = 0;
+
+  void latch(uint8_t nibble, bool character) {
+    if (!four_bit_) {
+      // 8 bit mode, the unwired low pins read 0
+      if ((nibble << 4 & 0xF0) == 0x20) four_bit_ = true;
+      return;
+    }
+    if (high_nibble_) {
+      byte_ = nibble << 4;
+      high_nibble_ = false;
+      return;
+    }
+    byte_ |= nibble;
+    high_nibble_ = true;
+    lcd_bytes++;
+    character ? store(byte_) : run(byte_);
+  }
+
+  void store(uint8_t c) {
+    if (!cgram_) {
+      int line = address_ >= 0x40;
+      int position = address_ & 0x3F;
+      if (position < 16) screen[line][position] = static_cast<char>(c);
+    }
+    address_++;
+  }
+
+  void run(uint8_t command) {
+    if (command == 0x01) {
+      for (auto& line : screen) line = std::string(16, ' ');
+      address_ = 0;
+      cgram_ = false;
+    } else if (command & 0x80) {
+      address_ = command & 0x7F;
+      cgram_ = false;
+    } else if (command & 0x40) {
+      cgram_ = true;
+    }
+  }
+
+ public:
+  static constexpr double BAUD = LCD_I2C_BAUD;
+
+  std::string screen[2] = {std::string(16, ' '), std::string(16, ' ')};
+  size_t writes = 0;
+  size_t bytes = 0;
+  size_t lcd_bytes = 0;
+  double bus_us = 0;
+  double delay_us = 0;
+
+  void write(const uint8_t* data, size_t size) override {
+    // 9 clocks a byte (8 bits and the ack) plus the address byte every write
+    writes++;
+    bytes += size + 1;
+    bus_us += (size + 1) * 9 * 1e6 / BAUD;
+    for (size_t i = 0; i < size; i++) {
+      bool enable_fell = (pins_ & 0x04) && !(data[i] & 0x04);
+      if (enable_fell) latch(pins_ >> 4, pins_ & 0x01);
+      pins_ = data[i];
+    }
+  }
+  void delayUs(uint32_t us) override { delay_us += us; }
+
+  void reset() {
+    writes = bytes = lcd_bytes = 0;
+    bus_us = delay_us = 0;
+  }
+  double totalUs() const { return bus_us + delay_us; }
+};
+
+}  // namespace picolator::test
@@ -0,0 +1,36 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#pragma once
+#include "math/binary_operator.h"
+#include "math/bracket.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+
+namespace picolator::test {
+
+// Builds "((...(1)+1)+1...)+1" with depth brackets, it solves to depth + 1
+inline math::ExprTree::ExprVec nestedBrackets(int depth) {
+  using math::ExprTree;
+  ExprTree::LetterPtr one(new math::Literals(1));
+  ExprTree::LetterPtr add(new math::BinaryOperator(
+      "+", math::BinaryOperator::Type::ADDITION));
+  ExprTree::LetterPtr open(new math::Bracket(math::Bracket::Type::OPEN));
+  ExprTree::LetterPtr closed(new math::Bracket(math::Bracket::Type::CLOSED));
+  ExprTree::ExprVec letters(depth, open);
+  letters.emplace_back(one);
+  for (int i = 0; i < depth; i++) {
+    letters.emplace_back(closed);
+    letters.emplace_back(add);
+    letters.emplace_back(one);
+  }
+  return letters;
+}
+}  // namespace picolator::test
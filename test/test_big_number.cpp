@@ -0,0 +1,115 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "math/big_number.h"
+#include "math/literals.h"
+
+using picolator::math::BigInt;
+using picolator::math::BigRational;
+using picolator::math::Literals;
+
+TEST(BigNumberTest, BigInt_Basics) {
+  ASSERT_EQ(BigInt(0).toString(), "0");
+  ASSERT_EQ(BigInt(-42).toString(), "-42");
+  ASSERT_EQ(BigInt(std::numeric_limits<int64_t>::min()).toString(),
+            "-9223372036854775808");
+  ASSERT_EQ(BigInt::pow(2, 100).toString(), "1267650600228229401496703205376");
+  ASSERT_EQ(BigInt::pow(10, 18).toString(), "1000000000000000000");
+
+  BigInt big = BigInt::pow(2, 100);
+  ASSERT_EQ((big - big + 5).toInt64(), 5);
+  ASSERT_EQ((big / BigInt::pow(2, 98)).toInt64(), 4);
+  ASSERT_EQ(((big + 3) % 7).toInt64(), 5);
+  ASSERT_EQ((BigInt(-7) / 2).toInt64(), -3);
+  ASSERT_EQ((BigInt(-7) % 2).toInt64(), -1);
+  ASSERT_ANY_THROW(big / 0);
+
+  ASSERT_TRUE(BigInt(std::numeric_limits<int64_t>::max()).fitsInt64());
+  ASSERT_FALSE(BigInt(std::numeric_limits<int64_t>::min()).fitsInt64());
+}
+
+// Large enough for Karatsuba, checked against long division
+TEST(BigNumberTest, BigInt_Large_Multiplication) {
+  BigInt a = BigInt::pow(3, 3000) + 12345;
+  BigInt b = BigInt::pow(7, 2500) - 1;
+  ASSERT_GT(a.limbs(), 64);
+  ASSERT_GT(b.limbs(), 64);
+
+  BigInt product = a * b;
+  ASSERT_EQ(product / a, b);
+  ASSERT_EQ(product / b, a);
+  ASSERT_TRUE((product % a).isZero());
+  ASSERT_EQ(((a + 1) * (a - 1)), a * a - 1);
+  ASSERT_EQ(BigInt::gcd(a * 6, b * 6) % 6, BigInt(0));
+}
+
+TEST(BigNumberTest, BigRational) {
+  BigRational half(BigInt::pow(2, 99), BigInt::pow(2, 100));
+  ASSERT_EQ(half.toString(), "1/2");
+  ASSERT_TRUE(half.fitsInt64());
+  ASSERT_EQ((half + half).toString(), "1");
+  ASSERT_EQ(BigRational(3, -6).toString(), "-1/2");
+  ASSERT_EQ(BigRational::pow(BigRational(2, 3), -3).toString(), "27/8");
+
+  BigRational huge(BigInt::pow(10, 40) + 1, BigInt::pow(10, 39));
+  ASSERT_NEAR(huge.getValue(), 10, 1e-12);
+}
+
+// LONG overflow promotes instead of wrapping
+TEST(BigNumberTest, Literals_Promotion) {
+  ASSERT_EQ((Literals(50000) * Literals(50000)).toString(), "2500000000");
+
+  Literals max(std::numeric_limits<long>::max());
+  Literals sum = max + Literals(1);
+  ASSERT_EQ(sum.getType(), Literals::Type::LONG);
+  ASSERT_EQ(sum.toString(), "9223372036854775808");
+
+  // And goes back once it fits again
+  Literals back = sum + Literals(-1);
+  ASSERT_EQ(back.getNumber().kind, picolator::math::Number::Kind::LONG);
+  ASSERT_EQ(back, max);
+
+  ASSERT_EQ((Literals(2) ^ Literals(100)).toString(),
+            "1267650600228229401496703205376");
+  ASSERT_EQ((Literals(2) ^ Literals(-70)).toString(),
+            "1/1180591620717411303424");
+}
+
+TEST(BigNumberTest, Literals_Factorial) {
+  Literals factorial(1);
+  for (int i = 2; i <= 30; i++) {
+    factorial = factorial * Literals(i);
+  }
+  ASSERT_EQ(factorial.toString(), "265252859812191058636308480000000");
+  for (int i = 30; i >= 2; i--) {
+    factorial = factorial / Literals(i);
+  }
+  ASSERT_EQ(factorial.toString(), "1");
+}
+
+// H(60) has a denominator past int64
+TEST(BigNumberTest, Literals_Fraction_Chain) {
+  Literals harmonic(0);
+  for (int i = 1; i <= 60; i++) {
+    harmonic = harmonic + Literals(1, i);
+  }
+  ASSERT_EQ(harmonic.getType(), Literals::Type::FRACTION);
+  ASSERT_NEAR(harmonic.getValue(), 4.67987041, 1e-8);
+
+  for (int i = 60; i >= 1; i--) {
+    harmonic = harmonic + (-Literals(1, i));
+  }
+  ASSERT_EQ(harmonic.toString(), "0");
+}
@@ -0,0 +1,117 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "alloc_counter.h"
+#include "math/binary_operator.h"
+#include "math/complex.h"
+#include "math/literals.h"
+#include "math/math_util.h"
+#include "math/unary_operator.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::Complex;
+using picolator::math::Literals;
+using picolator::math::Number;
+using picolator::math::UnaryOperator;
+
+static const double kPi = picolator::math::PI::value;
+
+TEST(ComplexTest, Arithmetic) {
+  Literals i(Literals::Type::COMPLEX);
+  ASSERT_EQ(i.toString(), "i");
+
+  // Goes back to a real number once the imaginary part cancels
+  Literals minus_one = i * i;
+  ASSERT_EQ(minus_one.getType(), Literals::Type::LONG);
+  ASSERT_EQ(minus_one.toString(), "-1");
+
+  Literals a = Literals(1) + Literals(2) * i;
+  Literals b = Literals(3) + (-i);
+  ASSERT_EQ(a.getType(), Literals::Type::COMPLEX);
+  ASSERT_EQ(a.toString(), "1+2i");
+  ASSERT_EQ(b.toString(), "3-i");
+  ASSERT_EQ((a * b).toString(), "5+5i");
+  ASSERT_EQ((a / b).toString(), "1/10+7/10i");
+  ASSERT_EQ(((Literals(1) + i) / (Literals(1) + (-i))).toString(), "i");
+  ASSERT_EQ((Literals(1, 2) + i).toString(), "1/2+i");
+  ASSERT_EQ(((Literals(1) + i) ^ Literals(2)).toString(), "2i");
+  ASSERT_EQ(a, Literals(1) + i + i);
+
+  ASSERT_THROW(i % Literals(2), picolator::math::TypeError);
+  ASSERT_THROW(a / (i + (-i)), picolator::math::DivideByZero);
+  // Dividing by a pure imaginary number isn't dividing by 0
+  ASSERT_EQ(BinaryOperator::solve(BinaryOperator::Type::DIVISION, a, i)
+                .toString(),
+            "2-i");
+}
+
+TEST(ComplexTest, Functions) {
+  Literals i(Literals::Type::COMPLEX);
+
+  Literals root = UnaryOperator::solve(UnaryOperator::Type::SQUARE_ROOT,
+                                       Literals(-4));
+  ASSERT_TRUE(root.isComplex());
+  ASSERT_EQ(root.toComplex().re.getValue(), 0);
+  ASSERT_EQ(root.toComplex().im.getValue(), 2);
+
+  Literals ln = UnaryOperator::solve(UnaryOperator::Type::LN, Literals(-1));
+  ASSERT_DOUBLE_EQ(ln.toComplex().im.getValue(), kPi);
+  ASSERT_THROW(UnaryOperator::solve(UnaryOperator::Type::LN, Literals(0)),
+               picolator::math::DomainError);
+
+  // e^(i*pi) + 1 = 0
+  Literals euler = Literals(Literals::Type::E) ^ (i * Literals::Type::PI);
+  ASSERT_FALSE(euler.isComplex());
+  ASSERT_DOUBLE_EQ(euler.getValue(), -1);
+
+  // Principal root for fractional powers, real root for odd n_th roots
+  Literals cube = Literals(-8) ^ Literals(1, 3);
+  ASSERT_NEAR(cube.toComplex().re.getValue(), 1, 1e-12);
+  ASSERT_NEAR(cube.toComplex().im.getValue(), std::sqrt(3), 1e-12);
+  Literals real_cube = BinaryOperator::solve(BinaryOperator::Type::N_TH_ROOT,
+                                             Literals(3), Literals(-8));
+  ASSERT_DOUBLE_EQ(real_cube.getValue(), -2);
+  ASSERT_TRUE(BinaryOperator::solve(BinaryOperator::Type::N_TH_ROOT,
+                                    Literals(2), Literals(-9))
+                  .isComplex());
+
+  Literals sin_i = picolator::math::psin(i);
+  ASSERT_DOUBLE_EQ(sin_i.toComplex().im.getValue(), std::sinh(1));
+  ASSERT_TRUE(picolator::math::parcsin(Literals(2)).isComplex());
+
+  Complex polar = Complex::polar(2, kPi / 2);
+  ASSERT_EQ(polar.re.getValue(), 0);
+  ASSERT_DOUBLE_EQ(polar.im.getValue(), 2);
+  ASSERT_DOUBLE_EQ(polar.abs(), 2);
+  ASSERT_DOUBLE_EQ(polar.arg(), kPi / 2);
+}
+
+TEST(ComplexTest, No_Allocations) {
+  Literals i(Literals::Type::COMPLEX);
+  Literals a = Literals(1) + Literals(2) * i, b = Literals(3, 4) + i;
+
+  picolator::test::AllocCounter counter;
+  Literals res = (a * b + a) / b;
+  res = res ^ Literals(3);
+  res = picolator::math::pcos(res);
+  ASSERT_EQ(counter.count(), 0);
+}
+
+TEST(ComplexTest, Overflow) {
+  // Parts that overflow int64 drop to doubles instead of a BigRational
+  Complex big = {Number::fromLong(1L << 62), Number::fromLong(1L << 62)};
+  Complex square = big * big;
+  ASSERT_EQ(square.re.getValue(), 0);
+  ASSERT_DOUBLE_EQ(square.im.getValue(), std::ldexp(1, 125));
+}
@@ -0,0 +1,126 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "math/equation.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+#include "math/token.h"
+
+using picolator::math::Equation;
+using picolator::math::ErrorCode;
+using picolator::math::EvalEnvironment;
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::TokenId;
+
+TEST(EquationTest, Tokens) {
+  // A+2*(B-A)
+  Equation equation;
+  equation.insertVariable(0, 'A');
+  for (TokenId id : {TokenId::ADD, TokenId::DIGIT_2, TokenId::MUL,
+                     TokenId::OPEN}) {
+    equation.push_back(id);
+  }
+  equation.insertVariable(equation.size(), 'B');
+  equation.push_back(TokenId::SUB);
+  equation.insertVariable(equation.size(), 'A');
+  equation.push_back(TokenId::CLOSED);
+
+  ASSERT_EQ(equation.size(), 9);
+  ASSERT_EQ(equation.token(1), TokenId::ADD);
+  ASSERT_EQ(equation.token(0), TokenId::NONE);
+  ASSERT_EQ(equation.symbol(5), "B");
+  ASSERT_EQ(equation.symbol(8), ")");
+  // Letters are shared with every other equation
+  ASSERT_EQ(equation[1], picolator::math::tokenLetter(TokenId::ADD));
+  ASSERT_EQ(equation[0], equation[7]);
+  ASSERT_EQ(equation[0], picolator::math::variableLetter('A'));
+
+  EvalEnvironment env;
+  env.variable('A') = Literals(3);
+  env.variable('B') = Literals(5);
+  auto result = ExprTree::evaluate(equation, Program::Mode::EXACT, env);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result.value()->getValue(), 7);
+
+  // Edits keep the variable table lined up
+  equation.erase(0);
+  equation.erase(0);
+  equation.set(0, TokenId::DIGIT_4);
+  ASSERT_EQ(ExprTree(equation).getValue(env)->getValue(), 8);
+  ASSERT_EQ(equation.symbol(5), "A");
+}
+
+TEST(EquationTest, Copy) {
+  Equation equation;
+  equation.insertVariable(0, 'C');
+  equation.push_back(TokenId::MUL);
+  equation.push_back(TokenId::PI);
+
+  Equation copy;
+  for (size_t i = 0; i < equation.size(); i++) copy.append(equation, i);
+  for (size_t i = 0; i < equation.size(); i++) {
+    ASSERT_EQ(copy[i], equation[i]);
+  }
+
+  ASSERT_THROW(equation.insertVariable(0, 'Z'), picolator::math::DomainError);
+  ASSERT_EQ(ExprTree::evaluate(Equation({TokenId::ADD})).error().code,
+            ErrorCode::SYNTAX_ERROR);
+}
+
+// Memory for a 1+2+3+... equation and a history of them, compared to storing a
+// LetterPtr per key
+TEST(EquationTest, Bytes_Per_Token) {
+  const size_t keys = 64;
+  const size_t history = 16;
+
+  Equation equation;
+  ExprTree::ExprVec letters;
+  for (size_t i = 0; i < keys; i++) {
+    TokenId id = (i % 2) ? TokenId::ADD
+                         : static_cast<TokenId>(
+                               static_cast<int>(TokenId::DIGIT_1) + i % 9);
+    equation.push_back(id);
+    letters.push_back(picolator::math::tokenLetter(id));
+  }
+  equation.insertVariable(equation.size(), 'A');
+  letters.push_back(picolator::math::variableLetter('A'));
+
+  std::vector<Equation> equations(history, equation);
+  std::vector<ExprTree::ExprVec> vecs(history, letters);
+  size_t equation_bytes = sizeof(equations);
+  for (const auto& e : equations) equation_bytes += e.bytes();
+  size_t vec_bytes = sizeof(vecs);
+  for (const auto& v : vecs) {
+    vec_bytes += sizeof(v) + v.capacity() * sizeof(ExprTree::LetterPtr);
+  }
+
+  size_t tokens = history * (keys + 1);
+  printf("history of %zu equations, %zu keys each\n", history, keys + 1);
+  printf("  Equation %6zu bytes, %.2f bytes/token\n", equation_bytes,
+         static_cast<double>(equation_bytes) / tokens);
+  printf("  ExprVec  %6zu bytes, %.2f bytes/token\n", vec_bytes,
+         static_cast<double>(vec_bytes) / tokens);
+  ASSERT_LT(equation_bytes * 4, vec_bytes);
+
+  // Recalling from the history is a copy of the bytes, no refcounts
+  picolator::test::AllocCounter counter;
+  Equation recalled = equations.back();
+  ASSERT_LE(counter.count(), 2);
+  ASSERT_EQ(ExprTree(recalled).getValue()->getValue(),
+            ExprTree(letters).getValue()->getValue());
+}
@@ -0,0 +1,252 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+// Built with and without exceptions so it can't use ASSERT_THROW
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <initializer_list>
+
+#include "math/error.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+#include "math/program.h"
+#include "math/token.h"
+
+using picolator::math::Error;
+using picolator::math::ErrorCode;
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::Result;
+using picolator::math::TokenId;
+using picolator::math::modeName;
+
+static ExprTree::ExprVec equation(std::initializer_list<TokenId> ids) {
+  ExprTree::ExprVec letters;
+  for (TokenId id : ids) {
+    letters.push_back(picolator::math::tokenLetter(id));
+  }
+  return letters;
+}
+
+static Error evaluateError(std::initializer_list<TokenId> ids,
+                           Program::Mode mode = Program::Mode::EXACT) {
+  return ExprTree::evaluate(equation(ids), mode).error();
+}
+
+TEST(ErrorTest, Result) {
+  Result<int> good(3);
+  ASSERT_TRUE(good.ok());
+  ASSERT_EQ(*good, 3);
+  ASSERT_EQ(good.error().code, ErrorCode::NONE);
+
+  Result<int> bad(Error::domain("sqrt"));
+  ASSERT_FALSE(bad);
+  ASSERT_EQ(bad.error().code, ErrorCode::DOMAIN_ERROR);
+  ASSERT_STREQ(bad.error().what, "sqrt");
+}
+
+TEST(ErrorTest, Messages) {
+  char msg[picolator::math::ERROR_MSG_SIZE];
+  formatError(Error::domain("sqrt"), msg, sizeof(msg));
+  ASSERT_STREQ(msg, "sqrt Domain error");
+  formatError(Error::divideByZero(), msg, sizeof(msg));
+  ASSERT_STREQ(msg, "/ By 0");
+  formatError(Error::syntax("Empty Bracket", 3), msg, sizeof(msg));
+  ASSERT_STREQ(msg, "Syntax E Empty Bracket");
+  formatError(Error::typeError("%", "Int"), msg, sizeof(msg));
+  ASSERT_STREQ(msg, "Type E %-Int");
+  formatError(Error::notImplemented("solve"), msg, sizeof(msg));
+  ASSERT_STREQ(msg, "NIMP solve");
+
+  // Messages are cut off instead of overflowing
+  char small[8];
+  formatError(Error::domain("Var doesn't exist"), small, sizeof(small));
+  ASSERT_EQ(strlen(small), sizeof(small) - 1);
+}
+
+TEST(ErrorTest, Evaluate_Codes) {
+  // Same code for / and % and from every backend
+  Error error;
+  for (Program::Mode mode : {Program::Mode::EXACT, Program::Mode::DOUBLE,
+                             Program::Mode::FLOAT, Program::Mode::FIXED}) {
+    error = evaluateError({TokenId::DIGIT_1, TokenId::DIV, TokenId::DIGIT_0},
+                          mode);
+    ASSERT_EQ(error.code, ErrorCode::DIVIDE_BY_ZERO);
+    ASSERT_STREQ(error.what, "/");
+
+    error = evaluateError({TokenId::DIGIT_5, TokenId::MOD, TokenId::DIGIT_0},
+                          mode);
+    ASSERT_EQ(error.code, ErrorCode::DIVIDE_BY_ZERO);
+  }
+
+  error = evaluateError({TokenId::DIGIT_1, TokenId::DECIMAL, TokenId::DIGIT_5,
+                         TokenId::MOD, TokenId::DIGIT_1});
+  ASSERT_EQ(error.code, ErrorCode::TYPE_ERROR);
+  ASSERT_STREQ(error.type, "Int");
+
+  error = evaluateError({TokenId::LN, TokenId::DIGIT_0});
+  ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR);
+  ASSERT_STREQ(error.what, "ln");
+
+  // Same error from the other backends
+  error = evaluateError({TokenId::LN, TokenId::DIGIT_0}, Program::Mode::FIXED);
+  ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR);
+  error = evaluateError({TokenId::LN, TokenId::DIGIT_0}, Program::Mode::FLOAT);
+  ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR);
+}
+
+TEST(ErrorTest, Complex_In_Real_Modes) {
+  // 2+3i and sqrt(0-4) only have complex answers
+  std::initializer_list<TokenId> complex = {TokenId::DIGIT_2, TokenId::ADD,
+                                            TokenId::DIGIT_3, TokenId::I};
+  std::initializer_list<TokenId> root = {TokenId::SQRT,    TokenId::OPEN,
+                                         TokenId::DIGIT_0, TokenId::SUB,
+                                         TokenId::DIGIT_4, TokenId::CLOSED};
+  ASSERT_TRUE(ExprTree::evaluate(equation(complex)).ok());
+
+  picolator::math::EvalEnvironment env;
+  env.ans() = *ExprTree::evaluate(equation(complex)).value();
+  for (Program::Mode mode : {Program::Mode::DOUBLE, Program::Mode::FLOAT,
+                             Program::Mode::FIXED}) {
+    Error error = evaluateError(complex, mode);
+    ASSERT_EQ(error.code, ErrorCode::TYPE_ERROR);
+    ASSERT_STREQ(error.type, "Cplx");
+
+    // Not folded to 2i first, the real sqrt sees the -4
+    error = evaluateError(root, mode);
+    ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR);
+    ASSERT_STREQ(error.what, "sqrt");
+
+    // A complex ANS can't be loaded either
+    error = ExprTree::evaluate(equation({TokenId::ANS}), mode, env).error();
+    ASSERT_EQ(error.code, ErrorCode::TYPE_ERROR);
+  }
+}
+
+TEST(ErrorTest, Real_Domain) {
+  // (0-8) so it isn't parsed as a minus on the 8 only
+  std::initializer_list<TokenId> cube_root = {
+      TokenId::DIGIT_3, TokenId::N_TH_ROOT, TokenId::OPEN,  TokenId::DIGIT_0,
+      TokenId::SUB,     TokenId::DIGIT_8,   TokenId::CLOSED};
+  std::initializer_list<TokenId> square_root = {
+      TokenId::DIGIT_2, TokenId::N_TH_ROOT, TokenId::OPEN,  TokenId::DIGIT_0,
+      TokenId::SUB,     TokenId::DIGIT_8,   TokenId::CLOSED};
+  std::initializer_list<TokenId> half_root = {
+      TokenId::DIGIT_0, TokenId::DECIMAL, TokenId::DIGIT_5,
+      TokenId::N_TH_ROOT, TokenId::OPEN, TokenId::DIGIT_0,
+      TokenId::SUB, TokenId::DIGIT_8, TokenId::CLOSED};
+  std::initializer_list<TokenId> third_power = {
+      TokenId::OPEN,   TokenId::DIGIT_0, TokenId::SUB,     TokenId::DIGIT_8,
+      TokenId::CLOSED, TokenId::EXP,     TokenId::OPEN,    TokenId::DIGIT_1,
+      TokenId::DIV,    TokenId::DIGIT_3, TokenId::CLOSED};
+  std::initializer_list<TokenId> cube = {
+      TokenId::OPEN,   TokenId::DIGIT_0, TokenId::SUB, TokenId::DIGIT_2,
+      TokenId::CLOSED, TokenId::EXP,     TokenId::DIGIT_3};
+
+  for (Program::Mode mode : {Program::Mode::EXACT, Program::Mode::DOUBLE,
+                             Program::Mode::FLOAT, Program::Mode::FIXED}) {
+    auto result = ExprTree::evaluate(equation(cube_root), mode);
+    ASSERT_TRUE(result.ok()) << modeName(mode);
+    ASSERT_NEAR((*result)->getValue(), -2, 1e-6) << modeName(mode);
+
+    result = ExprTree::evaluate(equation(cube), mode);
+    ASSERT_TRUE(result.ok()) << modeName(mode);
+    ASSERT_NEAR((*result)->getValue(), -8, 1e-6) << modeName(mode);
+
+    // EXACT gives the complex answers instead
+    if (mode == Program::Mode::EXACT) continue;
+    Error error = evaluateError(square_root, mode);
+    ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR) << modeName(mode);
+    ASSERT_STREQ(error.what, "n_sqrt()");
+    error = evaluateError(half_root, mode);
+    ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR) << modeName(mode);
+    error = evaluateError(third_power, mode);
+    ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR) << modeName(mode);
+    ASSERT_STREQ(error.what, "exp");
+  }
+
+  // 10^400 is inf as a double or float, inf*0 has no answer at all
+  std::initializer_list<TokenId> inf_times_zero = {
+      TokenId::OPEN,    TokenId::DIGIT_1, TokenId::DIGIT_0, TokenId::EXP,
+      TokenId::DIGIT_4, TokenId::DIGIT_0, TokenId::DIGIT_0, TokenId::CLOSED,
+      TokenId::MUL,     TokenId::DIGIT_0};
+  for (Program::Mode mode : {Program::Mode::DOUBLE, Program::Mode::FLOAT}) {
+    Error error = evaluateError(inf_times_zero, mode);
+    ASSERT_EQ(error.code, ErrorCode::DOMAIN_ERROR) << modeName(mode);
+    ASSERT_STREQ(error.what, "NaN");
+  }
+}
+
+TEST(ErrorTest, Syntax_Index) {
+  // Nothing after the +, the parser is past the end
+  Error error = evaluateError({TokenId::DIGIT_2, TokenId::ADD});
+  ASSERT_EQ(error.code, ErrorCode::SYNTAX_ERROR);
+  ASSERT_EQ(error.idx, 2);
+
+  error = evaluateError({TokenId::MUL, TokenId::DIGIT_2});
+  ASSERT_EQ(error.code, ErrorCode::SYNTAX_ERROR);
+  ASSERT_EQ(error.idx, 0);
+
+  error = evaluateError({TokenId::DIGIT_2, TokenId::SIN, TokenId::DIGIT_2});
+  ASSERT_EQ(error.code, ErrorCode::SYNTAX_ERROR);
+  ASSERT_EQ(error.idx, 1);
+
+  error = evaluateError({TokenId::OPEN, TokenId::CLOSED});
+  ASSERT_EQ(error.code, ErrorCode::SYNTAX_ERROR);
+  ASSERT_STREQ(error.what, "Empty Bracket");
+
+  error = evaluateError({});
+  ASSERT_EQ(error.code, ErrorCode::SYNTAX_ERROR);
+}
+
+TEST(ErrorTest, Recovers) {
+  ASSERT_FALSE(
+      ExprTree::evaluate(equation({TokenId::DIGIT_1, TokenId::DIV,
+                                   TokenId::DIGIT_0})));
+
+  // Nothing is left over from the last error
+  auto result = ExprTree::evaluate(
+      equation({TokenId::DIGIT_1, TokenId::DIV, TokenId::DIGIT_4}));
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result.value()->getValue(), 0.25);
+
+  // Too many digits for a long used to throw out of the tokenizer
+  ExprTree::ExprVec digits;
+  for (int i = 0; i < 25; i++) {
+    digits.push_back(picolator::math::tokenLetter(TokenId::DIGIT_9));
+  }
+  result = ExprTree::evaluate(digits);
+  ASSERT_TRUE(result.ok());
+  ASSERT_DOUBLE_EQ(result.value()->getValue(), 1e25);
+}
+
+TEST(ErrorTest, Folding_Keeps_Error) {
+  // 1/0 can't be folded but the error still shows up when it is run
+  ExprTree::ExprVec letters = {ExprTree::LetterPtr(new Literals('A'))};
+  for (TokenId id : {TokenId::ADD, TokenId::DIGIT_1, TokenId::DIV,
+                     TokenId::DIGIT_0}) {
+    letters.push_back(picolator::math::tokenLetter(id));
+  }
+  auto result = ExprTree::evaluate(letters);
+  ASSERT_FALSE(result);
+  ASSERT_EQ(result.error().code, ErrorCode::DIVIDE_BY_ZERO);
+}
+
+TEST(ErrorTest, Capture) {
+  Error error = picolator::math::capture(
+      [] { picolator::math::raise(Error::divideByZero()); });
+  ASSERT_EQ(error.code, ErrorCode::DIVIDE_BY_ZERO);
+  ASSERT_FALSE(picolator::math::hasError());
+
+  error = picolator::math::capture([] {});
+  ASSERT_FALSE(error);
+}
@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+// Configure with -DPICOLATOR_TSAN=ON to have ThreadSanitizer check the
+// parallel tests for data races
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "math/equation.h"
+#include "math/eval_environment.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+
+using picolator::math::Equation;
+using picolator::math::ErrorCode;
+using picolator::math::EvalEnvironment;
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::TokenId;
+
+// sin(A)*A+ANS/B
+static Equation testEquation() {
+  Equation equation = {TokenId::SIN, TokenId::OPEN};
+  equation.insertVariable(equation.size(), 'A');
+  equation.push_back(TokenId::CLOSED);
+  equation.push_back(TokenId::MUL);
+  equation.insertVariable(equation.size(), 'A');
+  for (TokenId id : {TokenId::ADD, TokenId::ANS, TokenId::DIV}) {
+    equation.push_back(id);
+  }
+  equation.insertVariable(equation.size(), 'B');
+  return equation;
+}
+
+TEST(EvalEnvironmentTest, Slots) {
+  ASSERT_EQ(EvalEnvironment::variableSlot('A'), EvalEnvironment::ANS_SLOT + 1);
+  ASSERT_EQ(EvalEnvironment::variableSlot('F'), EvalEnvironment::SLOTS - 1);
+
+  EvalEnvironment env;
+  env.variable('C') = Literals(4);
+  ASSERT_EQ(env.slot(EvalEnvironment::variableSlot('C')).getValue(), 4);
+  // Copies don't share anything
+  EvalEnvironment copy = env;
+  copy.variable('C') = Literals(5);
+  ASSERT_EQ(env.variable('C').getValue(), 4);
+  ASSERT_EQ(EvalEnvironment::empty().variable('C').getValue(), 0);
+}
+
+TEST(EvalEnvironmentTest, Parallel_Evaluation) {
+  const int threads = 4;
+  const int runs = 100;
+  Equation equation = testEquation();
+  // 1/(A-A) always fails
+  Equation bad = {TokenId::DIGIT_1, TokenId::DIV, TokenId::OPEN};
+  bad.insertVariable(bad.size(), 'A');
+  bad.push_back(TokenId::SUB);
+  bad.insertVariable(bad.size(), 'A');
+  bad.push_back(TokenId::CLOSED);
+
+  // Compiled once and run by every thread with its own environment
+  ExprTree shared(equation);
+
+  std::vector<int> wrong(threads, 0);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      EvalEnvironment env;
+      env.ans() = Literals(t);
+      env.variable('B') = Literals(t + 1);
+      for (int i = 0; i < runs; i++) {
+        env.variable('A') = Literals(i);
+        double expected = std::sin(i) * i + t / (t + 1.0);
+
+        if (std::fabs(shared.getValue(env)->getValue() - expected) > 1e-9) {
+          wrong[t]++;
+        }
+        // Parsing at the same time on every thread
+        auto result = ExprTree::evaluate(equation, Program::Mode::DOUBLE, env);
+        if (!result ||
+            std::fabs(result.value()->getValue() - expected) > 1e-9) {
+          wrong[t]++;
+        }
+        // Errors on one thread don't show up on the others
+        if (t % 2 == 1 &&
+            ExprTree::evaluate(bad, Program::Mode::EXACT, env).error().code !=
+                ErrorCode::DIVIDE_BY_ZERO) {
+          wrong[t]++;
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  for (int t = 0; t < threads; t++) {
+    ASSERT_EQ(wrong[t], 0) << "thread " << t;
+  }
+}
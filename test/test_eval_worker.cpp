@@ -0,0 +1,155 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "eval_worker.h"
+#include "math/equation.h"
+#include "math/eval_environment.h"
+#include "math/literals.h"
+
+using picolator::math::Equation;
+using picolator::math::ErrorCode;
+using picolator::math::EvalEnvironment;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::TokenId;
+
+// Polls like the main loop does until the job is done
+static void waitFor(EvalWorker& worker) {
+  while (worker.poll() != EvalWorker::Status::DONE) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+// A+A+A+... nothing can be folded so every + is an instruction
+static Equation longEquation(size_t terms) {
+  Equation equation;
+  for (size_t i = 0; i < terms; i++) {
+    if (i) equation.push_back(TokenId::ADD);
+    equation.insertVariable(equation.size(), 'A');
+  }
+  return equation;
+}
+
+TEST(EvalWorkerTest, Submit) {
+  EvalWorker worker;
+  worker.start();
+  ASSERT_EQ(worker.poll(), EvalWorker::Status::IDLE);
+
+  // ANS*A+1
+  Equation equation = {TokenId::ANS, TokenId::MUL};
+  equation.insertVariable(equation.size(), 'A');
+  equation.push_back(TokenId::ADD);
+  equation.push_back(TokenId::DIGIT_1);
+  EvalEnvironment env;
+  env.ans() = Literals(6);
+  env.variable('A') = Literals(7);
+
+  ASSERT_TRUE(worker.submit(equation, Program::Mode::EXACT, env));
+  // Core 1 has its own copies
+  equation.clear();
+  env.ans() = Literals(0);
+  waitFor(worker);
+  ASSERT_TRUE(worker.result().ok());
+  ASSERT_EQ(worker.result().value()->getValue(), 43);
+  ASSERT_EQ(worker.equation().size(), 5);
+  ASSERT_EQ(worker.poll(), EvalWorker::Status::IDLE);
+
+  // Errors come back like a result
+  ASSERT_TRUE(worker.submit({TokenId::DIGIT_1, TokenId::DIV, TokenId::DIGIT_0},
+                            Program::Mode::EXACT, env));
+  waitFor(worker);
+  ASSERT_EQ(worker.result().error().code, ErrorCode::DIVIDE_BY_ZERO);
+}
+
+TEST(EvalWorkerTest, Cancel) {
+  EvalWorker worker;
+  worker.start();
+  Equation equation = longEquation(20000);
+  EvalEnvironment env;
+  env.variable('A') = Literals(1);
+
+  ASSERT_TRUE(worker.submit(equation, Program::Mode::EXACT, env));
+  // Only one job at a time, and the caller never blocks on it
+  ASSERT_TRUE(worker.busy());
+  ASSERT_FALSE(worker.submit(equation, Program::Mode::EXACT, env));
+  ASSERT_EQ(worker.poll(), EvalWorker::Status::COMPUTING);
+
+  worker.cancel();
+  waitFor(worker);
+  ASSERT_EQ(worker.result().error().code, ErrorCode::CANCELLED);
+
+  // A cancel doesn't stick to the next job
+  ASSERT_TRUE(worker.submit(longEquation(100), Program::Mode::EXACT, env));
+  waitFor(worker);
+  ASSERT_TRUE(worker.result().ok());
+  ASSERT_EQ(worker.result().value()->getValue(), 100);
+}
+
+TEST(EvalWorkerTest, Cancel_Constant) {
+  EvalWorker worker;
+  worker.start();
+  // 3^9000*3^9001*... has no variables, it is all solved while folding
+  Equation equation;
+  for (int i = 0; i < 50; i++) {
+    if (i) equation.push_back(TokenId::MUL);
+    for (TokenId id : {TokenId::DIGIT_3, TokenId::EXP, TokenId::DIGIT_9,
+                       TokenId::DIGIT_0, TokenId::DIGIT_0}) {
+      equation.push_back(id);
+    }
+    equation.push_back(static_cast<TokenId>(
+        static_cast<int>(TokenId::DIGIT_0) + i % 10));
+  }
+
+  ASSERT_TRUE(worker.submit(equation, Program::Mode::EXACT, EvalEnvironment()));
+  worker.cancel();
+  waitFor(worker);
+  ASSERT_EQ(worker.result().error().code, ErrorCode::CANCELLED);
+}
+
+TEST(EvalWorkerTest, Preview) {
+  EvalWorker worker;
+  worker.start();
+  EvalEnvironment env;
+  env.ans() = Literals(4);
+
+  // ANS+2 then ANS+2+
+  Equation equation = {TokenId::ANS, TokenId::ADD, TokenId::DIGIT_2};
+  ASSERT_TRUE(worker.preview(equation, env));
+  ASSERT_FALSE(worker.preview(equation, env));
+  waitFor(worker);
+  ASSERT_EQ(worker.kind(), EvalWorker::Kind::PREVIEW);
+  ASSERT_EQ(worker.result().value()->getValue(), 6);
+
+  equation.push_back(TokenId::ADD);
+  ASSERT_TRUE(worker.preview(equation, env));
+  waitFor(worker);
+  ASSERT_TRUE(worker.result().ok());
+  ASSERT_EQ(worker.result().value(), nullptr);
+
+  // Previews don't get in the way of the next calculation
+  equation.push_back(TokenId::DIGIT_1);
+  ASSERT_TRUE(worker.submit(equation, Program::Mode::EXACT, env));
+  waitFor(worker);
+  ASSERT_EQ(worker.kind(), EvalWorker::Kind::CALCULATE);
+  ASSERT_EQ(worker.result().value()->getValue(), 7);
+
+  // Or replace a slow preview that is still running
+  env.variable('A') = Literals(1);
+  ASSERT_TRUE(worker.preview(longEquation(20000), env));
+  ASSERT_TRUE(worker.submit(equation, Program::Mode::EXACT, env));
+  waitFor(worker);
+  ASSERT_EQ(worker.kind(), EvalWorker::Kind::CALCULATE);
+  ASSERT_EQ(worker.result().value()->getValue(), 7);
+}
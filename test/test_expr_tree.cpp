@@ -12,6 +12,7 @@
 
 #include <vector>
 
+#include "alloc_counter.h"
 #include "math/binary_operator.h"
 #include "math/bracket.h"
 #include "math/expr_tree.h"
@@ -19,14 +20,17 @@
 #include "math/literals.h"
 #include "math/literals_piece.h"
 #include "math/unary_operator.h"
+#include "parser_inputs.h"
 
 using picolator::math::BinaryOperator;
 using picolator::math::Bracket;
 using picolator::math::ExprTree;
+using picolator::math::Letter;
 using picolator::math::Literals;
 using picolator::math::LiteralsPiece;
 
 using picolator::math::UnaryOperator;
+using picolator::test::nestedBrackets;
 
 namespace picolator::math {
 class ExprTreeTester {
@@ -35,10 +39,31 @@ class ExprTreeTester {
 
   ExprTreeTester(const ExprTree::ExprVec& expr) : isi(expr) {}
 
-  const ExprTree::ExprTreeNodePtr& getRoot() { return isi.root_; }
-  int countLeafs(const ExprTree::ExprTreeNodePtr& start_node) {
-    return isi.countLeafs(start_node);
+  using Node = ExprTree::ExprTreeNode;
+
+  const Node* getNode(ExprTree::NodeIndex idx) {
+    return (idx == ExprTree::NO_NODE) ? nullptr : &isi.nodes_[idx];
+  }
+  ExprTree::NodeIndex getIndex(const Node* node) {
+    return (node) ? node - isi.nodes_.data() : ExprTree::NO_NODE;
+  }
+
+  const Node* getRoot() { return getNode(isi.root_); }
+  const Node* child(const Node* node, int i) {
+    return getNode(node->children[i]);
+  }
+  int countChildren(const Node* node) {
+    return (node->children[0] != ExprTree::NO_NODE) +
+           (node->children[1] != ExprTree::NO_NODE);
+  }
+  const Literals& literal(const Node* node) {
+    return reinterpret_cast<const Literals&>(*node->value);
+  }
+  int countLeafs(const Node* start_node) {
+    return isi.countLeafs(getIndex(start_node));
   }
+  size_t arenaCapacity() { return isi.nodes_.capacity(); }
+  size_t arenaSize() { return isi.nodes_.size(); }
 };
 };  // namespace picolator::math
 
@@ -58,8 +83,9 @@ TEST(ExprTree, MinimizeLong) {
   picolator::math::ExprTreeTester tree(letters);
 
   ASSERT_NE(nullptr, tree.getRoot());
-  ASSERT_NE(nullptr, tree.getRoot()->current_value);
-  ASSERT_EQ(10, tree.getRoot()->current_value->getValue());
+  ASSERT_EQ(Letter::Classification::LITERAL,
+            tree.getRoot()->value->getClassification());
+  ASSERT_EQ(10, tree.literal(tree.getRoot()).getValue());
 }
 
 TEST(ExprTree, MinimizeDouble) {
@@ -72,8 +98,27 @@ TEST(ExprTree, MinimizeDouble) {
   picolator::math::ExprTreeTester tree(letters);
 
   ASSERT_NE(nullptr, tree.getRoot());
-  ASSERT_NE(nullptr, tree.getRoot()->current_value);
-  ASSERT_EQ(10.5, tree.getRoot()->current_value->getValue());
+  ASSERT_EQ(Letter::Classification::LITERAL,
+            tree.getRoot()->value->getClassification());
+  ASSERT_EQ(10.5, tree.literal(tree.getRoot()).getValue());
+}
+
+TEST(ExprTree, Decimal_Sum_Exact) {
+  ExprTree::ExprVec letters;
+  for (char c : std::string("0.1+0.2")) {
+    if (c == '+') {
+      letters.emplace_back(ExprTree::LetterPtr(
+          new BinaryOperator("+", BinaryOperator::Type::ADDITION)));
+    } else {
+      letters.emplace_back(ExprTree::LetterPtr(new LiteralsPiece(c)));
+    }
+  }
+
+  ExprTree tree(letters);
+  auto res = tree.getValue();
+  ASSERT_EQ(res->getType(), Literals::Type::DECIMAL);
+  ASSERT_EQ(res->toString(), "0.3");
+  ASSERT_EQ(res->getValue(), 0.3);
 }
 
 TEST(ExprTree, SingleInt) {
@@ -150,12 +195,12 @@ TEST(ExprTree, Addition_and_Mult) {
   ASSERT_EQ(
       BinaryOperator::Type::ADDITION,
       reinterpret_cast<BinaryOperator&>(*(tree.getRoot()->value)).getType());
-  ASSERT_EQ(2, tree.getRoot()->children.size());
+  ASSERT_EQ(2, tree.countChildren(tree.getRoot()));
   ASSERT_EQ(
       BinaryOperator::Type::MULTIPLICATION,
-      reinterpret_cast<BinaryOperator&>(*(tree.getRoot()->children[1]->value))
+      reinterpret_cast<BinaryOperator&>(*(tree.child(tree.getRoot(), 1)->value))
           .getType());
-  ASSERT_EQ(10, tree.getRoot()->children[0]->current_value->getValue());
+  ASSERT_EQ(10, tree.literal(tree.child(tree.getRoot(), 0)).getValue());
 
   ASSERT_EQ(tree.isi.getValue()->getValue(), 154.0f);
 }
@@ -179,13 +224,13 @@ TEST(ExprTree, Addition_and_Mult_Brackets) {
   ASSERT_EQ(
       BinaryOperator::Type::MULTIPLICATION,
       reinterpret_cast<BinaryOperator&>(*(tree.getRoot()->value)).getType());
-  ASSERT_EQ(2, tree.getRoot()->children.size());
+  ASSERT_EQ(2, tree.countChildren(tree.getRoot()));
   ASSERT_EQ(2,
-            reinterpret_cast<Literals&>(*(tree.getRoot()->children[1]->value))
+            reinterpret_cast<Literals&>(*(tree.child(tree.getRoot(), 1)->value))
                 .getValue());
   ASSERT_EQ(
       BinaryOperator::Type::ADDITION,
-      reinterpret_cast<BinaryOperator&>(*(tree.getRoot()->children[0]->value))
+      reinterpret_cast<BinaryOperator&>(*(tree.child(tree.getRoot(), 0)->value))
           .getType());
   ASSERT_EQ(3, tree.countLeafs(tree.getRoot()));
 
@@ -215,14 +260,20 @@ TEST(ExprTree, Bracket_MULT) {
   ASSERT_EQ(
       BinaryOperator::Type::MULTIPLICATION,
       reinterpret_cast<BinaryOperator&>(*(tree.getRoot()->value)).getType());
-  ASSERT_EQ(2, tree.getRoot()->children.size());
-  ASSERT_EQ(0.5,
-            reinterpret_cast<Literals&>(*(tree.getRoot()->children[0]->value))
+  ASSERT_EQ(2, tree.countChildren(tree.getRoot()));
+  ASSERT_EQ(2,
+            reinterpret_cast<Literals&>(*(tree.child(tree.getRoot(), 1)->value))
                 .getValue());
-  ASSERT_EQ(
-      BinaryOperator::Type::ADDITION,
-      reinterpret_cast<BinaryOperator&>(*(tree.getRoot()->children[0]->value))
-          .getType());
+
+  // left associative so its (0.5 * (10 + 12)) * 2
+  const auto* lhs = tree.child(tree.getRoot(), 0);
+  ASSERT_EQ(BinaryOperator::Type::MULTIPLICATION,
+            reinterpret_cast<BinaryOperator&>(*(lhs->value)).getType());
+  ASSERT_EQ(0.5, reinterpret_cast<Literals&>(*(tree.child(lhs, 0)->value))
+                     .getValue());
+  ASSERT_EQ(BinaryOperator::Type::ADDITION,
+            reinterpret_cast<BinaryOperator&>(*(tree.child(lhs, 1)->value))
+                .getType());
 
   ASSERT_EQ(tree.isi.getValue()->getValue(), 22.0f);
 }
@@ -265,7 +316,8 @@ TEST(ExprTree, cos_pi) {
 }
 
 TEST(ExprTree, variable) {
-  Literals::getVariable('A') = Literals(10);
+  picolator::math::EvalEnvironment env;
+  env.variable('A') = Literals(10);
   ExprTree::ExprVec letters;
   letters.emplace_back(
       ExprTree::LetterPtr(new UnaryOperator("-", UnaryOperator::Type::MINUS)));
@@ -274,7 +326,7 @@ TEST(ExprTree, variable) {
   letters.emplace_back(ExprTree::LetterPtr(new Bracket(Bracket::Type::CLOSED)));
   picolator::math::ExprTreeTester tree(letters);
 
-  ASSERT_EQ(tree.isi.getValue()->getValue(), -10);
+  ASSERT_EQ(tree.isi.getValue(env)->getValue(), -10);
 }
 
 TEST(ExprTree, addition_minus) {
@@ -312,4 +364,125 @@ TEST(ExprTree, addition_minus) {
 //   picolator::math::ExprTreeTester tree(letters);
 
 //   ASSERT_EQ(tree.isi.getValue()->getValue(), -4);
-// }
\ No newline at end of file
+// }
+TEST(ExprTree, Division_Left_Associative) {
+  ExprTree::ExprVec letters;
+  letters.emplace_back(ExprTree::LetterPtr(new Literals(8)));
+  letters.emplace_back(ExprTree::LetterPtr(
+      new BinaryOperator("/", BinaryOperator::Type::DIVISION)));
+  letters.emplace_back(ExprTree::LetterPtr(new Literals(4)));
+  letters.emplace_back(ExprTree::LetterPtr(
+      new BinaryOperator("/", BinaryOperator::Type::DIVISION)));
+  letters.emplace_back(ExprTree::LetterPtr(new Literals(2)));
+
+  picolator::math::ExprTreeTester tree(letters);
+  ASSERT_EQ(tree.isi.getValue()->getValue(), 1);
+}
+
+TEST(ExprTree, Syntax_Errors) {
+  ExprTree::LetterPtr add(
+      new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+  ExprTree::LetterPtr sin(new UnaryOperator("sin", UnaryOperator::Type::SIN));
+  ExprTree::LetterPtr two(new Literals(2));
+
+  // Binary op at the start and end
+  ASSERT_THROW(ExprTree({add, two}), picolator::math::SyntaxError);
+  ASSERT_THROW(ExprTree({two, add}), picolator::math::SyntaxError);
+
+  // Unary op with no input and unary op after a literal
+  ASSERT_THROW(ExprTree({sin}), picolator::math::SyntaxError);
+  ASSERT_THROW(ExprTree({two, sin, two}), picolator::math::SyntaxError);
+}
+
+TEST(ExprTree, Deep_Nesting) {
+  ASSERT_EQ(ExprTree(nestedBrackets(200)).getValue()->getValue(), 201);
+  // Far deeper then the old recursive parser could go on the pico
+  ASSERT_EQ(ExprTree(nestedBrackets(10000), 10001).getValue()->getValue(),
+            10001);
+
+  ASSERT_THROW(ExprTree(nestedBrackets(ExprTree::MAX_DEPTH + 1)),
+               picolator::math::SyntaxError);
+  auto result = ExprTree::evaluate(nestedBrackets(ExprTree::MAX_DEPTH + 1));
+  ASSERT_FALSE(result);
+  ASSERT_STREQ(result.error().what, "Too Deep");
+  ASSERT_EQ(result.error().idx, ExprTree::MAX_DEPTH);
+}
+
+TEST(ExprTree, Unclosed_Brackets) {
+  ExprTree::LetterPtr open(new Bracket(Bracket::Type::OPEN));
+  ExprTree::LetterPtr closed(new Bracket(Bracket::Type::CLOSED));
+  ExprTree::LetterPtr add(
+      new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+  ExprTree::LetterPtr two(new Literals(2));
+
+  // Brackets still open at the end get closed
+  ASSERT_EQ(ExprTree({open, open, two, add, two}).getValue()->getValue(), 4);
+  ExprTree tree({open, two, closed, add, open, two});
+  ASSERT_EQ(tree.getValue()->getValue(), 4);
+
+  ASSERT_THROW(ExprTree({two, closed}), picolator::math::SyntaxError);
+  ASSERT_THROW(ExprTree({open, closed}), picolator::math::SyntaxError);
+  ASSERT_THROW(ExprTree({open}), picolator::math::SyntaxError);
+}
+
+// Builds "1+2+...+terms"
+static ExprTree::ExprVec sumOfTerms(int terms) {
+  ExprTree::LetterPtr add(
+      new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+  ExprTree::ExprVec letters;
+  for (int i = 1; i <= terms; i++) {
+    if (i != 1) letters.emplace_back(add);
+    letters.emplace_back(ExprTree::LetterPtr(new Literals(i)));
+  }
+  return letters;
+}
+
+TEST(ExprTree, Arena_Single_Allocation) {
+  picolator::math::ExprTreeTester tree(sumOfTerms(64));
+
+  // 64 literals and 63 additions all in one block
+  ASSERT_EQ(127, tree.arenaSize());
+  ASSERT_EQ(127, tree.arenaCapacity());
+  ASSERT_EQ(64, tree.countLeafs(tree.getRoot()));
+}
+
+// 1A+2A+...+terms*A, every term uses A so nothing gets folded
+static ExprTree::ExprVec sumOfVariableTerms(int terms) {
+  ExprTree::LetterPtr add(
+      new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+  ExprTree::LetterPtr mul(
+      new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION));
+  ExprTree::LetterPtr a(new Literals('A'));
+  ExprTree::ExprVec letters;
+  for (int i = 1; i <= terms; i++) {
+    if (i != 1) letters.emplace_back(add);
+    letters.emplace_back(ExprTree::LetterPtr(new Literals(i)));
+    letters.emplace_back(mul);
+    letters.emplace_back(a);
+  }
+  return letters;
+}
+
+TEST(ExprTree, Evaluation_Allocations) {
+  picolator::math::EvalEnvironment env;
+  env.variable('A') = Literals(2);
+  picolator::math::ExprTreeTester small_tree(sumOfVariableTerms(8));
+  picolator::math::ExprTreeTester large_tree(sumOfVariableTerms(64));
+  // Every op is still run
+  ASSERT_GE(large_tree.isi.getProgram().getCode().size(), 3 * 64 - 1);
+
+  picolator::test::AllocCounter small_counter;
+  ASSERT_EQ(small_tree.isi.getValue(env)->getValue(), 72);
+  size_t small_allocs = small_counter.count();
+
+  picolator::test::AllocCounter large_counter;
+  ASSERT_EQ(large_tree.isi.getValue(env)->getValue(), 4160);
+  size_t large_allocs = large_counter.count();
+
+  // The value buffer and the returned LiteralPtr, nothing per node
+  ASSERT_LE(small_allocs, 3);
+  ASSERT_EQ(small_allocs, large_allocs);
+
+  // Solving twice gives the same answer
+  ASSERT_EQ(large_tree.isi.getValue(env)->getValue(), 4160);
+}
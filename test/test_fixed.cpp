@@ -0,0 +1,69 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "math/fixed.h"
+#include "math/math_util.h"
+
+using picolator::math::Fixed;
+
+// Fixed is good to about 2^-30 after a few ops
+static constexpr double kTolerance = 1e-8;
+
+static double d(Fixed f) { return static_cast<double>(f); }
+
+TEST(FixedTest, Arithmetic) {
+  Fixed a(1.5), b(-0.25);
+  ASSERT_EQ(d(a + b), 1.25);
+  ASSERT_EQ(d(a - b), 1.75);
+  ASSERT_EQ(d(a * b), -0.375);
+  ASSERT_EQ(d(a / b), -6);
+  ASSERT_EQ(d(-a), -1.5);
+  ASSERT_NEAR(d(Fixed(1) / Fixed(3)), 1.0 / 3, kTolerance);
+  // 0.001 is only good to 2^-32 so the error grows with the other side
+  ASSERT_NEAR(d(Fixed(12345.678) * Fixed(-0.001)), -12.345678, 1e-5);
+  ASSERT_THROW(a / Fixed(), picolator::math::DivideByZero);
+
+  // Saturates instead of wrapping
+  ASSERT_EQ(Fixed(100000) * Fixed(100000), Fixed::max());
+  ASSERT_EQ(Fixed(-100000) * Fixed(100000), Fixed::min());
+  ASSERT_EQ(Fixed::max() + Fixed(1), Fixed::max());
+  ASSERT_EQ(Fixed(1e12), Fixed::max());
+}
+
+TEST(FixedTest, Functions) {
+  for (double x = -10; x <= 10; x += 0.37) {
+    ASSERT_NEAR(d(sin(Fixed(x))), std::sin(x), kTolerance) << x;
+    ASSERT_NEAR(d(cos(Fixed(x))), std::cos(x), kTolerance) << x;
+    ASSERT_NEAR(d(atan(Fixed(x))), std::atan(x), kTolerance) << x;
+    ASSERT_NEAR(d(exp(Fixed(x))), std::exp(x), std::exp(x) * 1e-7 + 1e-9)
+        << x;
+  }
+  for (double x = 0.01; x < 1000; x *= 1.7) {
+    ASSERT_NEAR(d(sqrt(Fixed(x))), std::sqrt(x), kTolerance) << x;
+    ASSERT_NEAR(d(log(Fixed(x))), std::log(x), kTolerance * 10) << x;
+  }
+  ASSERT_NEAR(d(asin(Fixed(0.5))), std::asin(0.5), kTolerance);
+  ASSERT_NEAR(d(acos(Fixed(-0.3))), std::acos(-0.3), kTolerance);
+  ASSERT_EQ(d(pow(Fixed(-2), Fixed(3))), -8);
+  ASSERT_EQ(d(pow(Fixed(2), Fixed(-2))), 0.25);
+  ASSERT_NEAR(d(pow(Fixed(2), Fixed(0.5))), std::sqrt(2), 1e-7);
+  ASSERT_EQ(d(fmod(Fixed(7.5), Fixed(2))), 1.5);
+
+  ASSERT_THROW(sqrt(Fixed(-1)), picolator::math::DomainError);
+  ASSERT_THROW(log(Fixed()), picolator::math::DomainError);
+  ASSERT_THROW(asin(Fixed(2)), picolator::math::DomainError);
+  ASSERT_THROW(pow(Fixed(-2), Fixed(0.5)), picolator::math::DomainError);
+  ASSERT_THROW(fmod(Fixed(5), Fixed()), picolator::math::DivideByZero);
+  ASSERT_EQ(fmod(Fixed::min(), Fixed::fromRaw(-1)), Fixed());
+}
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "math/equation.h"
+#include "math/expr_tree.h"
+#include "math/incremental_parser.h"
+
+using picolator::math::Equation;
+using picolator::math::EvalEnvironment;
+using picolator::math::IncrementalParser;
+using picolator::math::TokenId;
+
+static TokenId digit(char c) {
+  return static_cast<TokenId>(static_cast<int>(TokenId::DIGIT_0) + c - '0');
+}
+
+TEST(IncrementalParserTest, Typing) {
+  IncrementalParser parser;
+  Equation equation;
+
+  equation.push_back(digit('1'));
+  ASSERT_EQ(1, parser.update(equation)->getValue());
+  equation.push_back(digit('2'));
+  ASSERT_EQ(12, parser.update(equation)->getValue());
+  ASSERT_EQ(1, parser.getRetokenized());
+
+  // Can't be solved yet
+  equation.push_back(TokenId::ADD);
+  ASSERT_EQ(nullptr, parser.update(equation));
+
+  equation.push_back(digit('3'));
+  ASSERT_EQ(15, parser.update(equation)->getValue());
+  ASSERT_EQ(1, parser.getRetokenized());
+
+  // Nothing changed
+  ASSERT_EQ(15, parser.update(equation)->getValue());
+  ASSERT_EQ(0, parser.getRetokenized());
+
+  // Backspace
+  equation.erase(equation.size() - 1);
+  ASSERT_EQ(nullptr, parser.update(equation));
+  ASSERT_EQ(0, parser.getRetokenized());
+
+  // Edit in the middle of a number 12+ -> 15+3
+  equation.set(1, digit('5'));
+  equation.push_back(digit('3'));
+  ASSERT_EQ(18, parser.update(equation)->getValue());
+  ASSERT_EQ(3, parser.getRetokenized());
+
+  parser.reset();
+  ASSERT_EQ(18, parser.update(equation)->getValue());
+  ASSERT_EQ(4, parser.getRetokenized());
+}
+
+TEST(IncrementalParserTest, Brackets) {
+  IncrementalParser parser;
+
+  // 2(3+4
+  Equation equation = {digit('2'), TokenId::OPEN, digit('3'), TokenId::ADD,
+                       digit('4')};
+  ASSERT_EQ(14, parser.update(equation)->getValue());
+  equation.push_back(TokenId::CLOSED);
+  equation.push_back(TokenId::MUL);
+  equation.push_back(digit('2'));
+  ASSERT_EQ(28, parser.update(equation)->getValue());
+  ASSERT_EQ(3, parser.getRetokenized());
+}
+
+TEST(IncrementalParserTest, Cancel) {
+  IncrementalParser parser;
+  std::atomic<bool> cancel = true;
+  EvalEnvironment env;
+  env.setCancelFlag(&cancel);
+
+  Equation equation = {digit('2'), TokenId::EXP, digit('9')};
+  ASSERT_EQ(nullptr, parser.update(equation, env));
+
+  // Same equation, it still gets solved this time
+  cancel = false;
+  ASSERT_EQ(512, parser.update(equation, env)->getValue());
+  ASSERT_EQ(0, parser.getRetokenized());
+}
+
+// Types out "1+2+...+9+1+2..." one key at a time, ParserBench.Preview_Typing
+// times the same thing
+TEST(IncrementalParserTest, Long_Equation) {
+  const size_t keys = 401;
+  IncrementalParser parser;
+  Equation equation;
+
+  int sum = 0;
+  for (size_t i = 0; i < keys; i++) {
+    equation.push_back((i % 2) ? TokenId::ADD : digit('1' + (i / 2) % 9));
+    if (i % 2 == 0) sum += 1 + (i / 2) % 9;
+
+    auto value = parser.update(equation);
+    // Only the key that was just pressed gets tokenized
+    ASSERT_EQ(1, parser.getRetokenized());
+    if (i % 2 == 0) {
+      ASSERT_NE(nullptr, value);
+    }
+  }
+  ASSERT_EQ(sum, parser.update(equation)->getValue());
+
+  // Editing the first number only re-tokenizes from there
+  equation.set(0, digit('9'));
+  ASSERT_EQ(sum + 8, parser.update(equation)->getValue());
+  ASSERT_EQ(keys, parser.getRetokenized());
+}
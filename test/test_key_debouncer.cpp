@@ -0,0 +1,148 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <larrys_pico/key_debouncer.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using Debouncer = KeyDebouncer<2, 3>;
+
+// Stands in for the SpscQueue, full once it holds limit events
+struct EventLog {
+  std::vector<KeyEvent> events;
+  size_t limit = SIZE_MAX;
+
+  bool push(const KeyEvent& event) {
+    if (events.size() >= limit) return false;
+    events.push_back(event);
+    return true;
+  }
+};
+
+// Feeds a pin trace for row 0, one character per 1ms sample, '1' is column 0
+// reading pressed and '2' columns 0 and 1
+static void play(Debouncer& debouncer, const std::string& trace,
+                 uint32_t& time_ms, EventLog& log) {
+  for (char c : trace) {
+    uint32_t pressed = (c == '1') ? 0b01 : (c == '2') ? 0b11 : 0;
+    debouncer.update(time_ms++, 0, pressed, log);
+  }
+}
+
+TEST(KeyDebouncerTest, Bounce) {
+  Debouncer debouncer;
+  EventLog log;
+  uint32_t time_ms = 0;
+
+  // Chatters for a few ms each way, one press and one release come out
+  play(debouncer, "0101101111111111", time_ms, log);
+  ASSERT_EQ(log.events.size(), 1);
+  ASSERT_TRUE(log.events[0].pressed);
+  ASSERT_EQ(log.events[0].column, 0);
+  // Stable from t=6, debounced 5ms later
+  ASSERT_EQ(log.events[0].time_ms, 11);
+  ASSERT_TRUE(debouncer.isDown(0, 0));
+
+  play(debouncer, "0010100000000", time_ms, log);
+  ASSERT_EQ(log.events.size(), 2);
+  ASSERT_FALSE(log.events[1].pressed);
+  ASSERT_EQ(log.events[1].time_ms, 21 + 5);
+
+  // Shorter than the debounce time is noise
+  play(debouncer, "0011110000000", time_ms, log);
+  ASSERT_EQ(log.events.size(), 2);
+  ASSERT_FALSE(debouncer.isDown(0, 0));
+}
+
+TEST(KeyDebouncerTest, Rollover) {
+  Debouncer debouncer;
+  EventLog log;
+  uint32_t time_ms = 0;
+
+  // Column 1 goes down while column 0 is still held, then 0 lets go first
+  play(debouncer, "1111111222222221111111", time_ms, log);
+  // A key in another row at the same time
+  for (int i = 0; i < 8; i++) debouncer.update(time_ms++, 1, 0b100, log);
+  play(debouncer, "000000000", time_ms, log);
+
+  ASSERT_EQ(log.events.size(), 5);
+  ASSERT_TRUE(log.events[0].pressed);
+  ASSERT_EQ(log.events[0].column, 0);
+  ASSERT_TRUE(log.events[1].pressed);
+  ASSERT_EQ(log.events[1].column, 1);
+  ASSERT_FALSE(log.events[2].pressed);
+  ASSERT_EQ(log.events[2].column, 1);
+  ASSERT_TRUE(log.events[3].pressed);
+  ASSERT_EQ(log.events[3].row, 1);
+  ASSERT_EQ(log.events[3].column, 2);
+  ASSERT_FALSE(log.events[4].pressed);
+  ASSERT_EQ(log.events[4].column, 0);
+  ASSERT_TRUE(debouncer.isDown(1, 2));
+}
+
+TEST(KeyDebouncerTest, Auto_Repeat) {
+  Debouncer debouncer;
+  debouncer.setRepeat(0, 0, true);
+  EventLog log;
+  uint32_t time_ms = 0;
+
+  // Column 0 repeats, column 1 doesn't
+  play(debouncer, std::string(800, '2') + "00000000", time_ms, log);
+  std::vector<uint32_t> repeats;
+  int presses = 0;
+  for (const KeyEvent& event : log.events) {
+    if (event.repeat) {
+      ASSERT_EQ(event.column, 0);
+      ASSERT_TRUE(event.pressed);
+      repeats.push_back(event.time_ms);
+    } else if (event.pressed) {
+      presses++;
+    }
+  }
+  ASSERT_EQ(presses, 2);
+  ASSERT_EQ(repeats, (std::vector<uint32_t>{505, 605, 705}));
+  ASSERT_FALSE(log.events.back().pressed);
+}
+
+// The ms counter wraps after 49 days
+TEST(KeyDebouncerTest, Time_Rollover) {
+  Debouncer debouncer;
+  debouncer.setRepeat(0, 0, true);
+  EventLog log;
+  uint32_t time_ms = UINT32_MAX - 2;
+
+  play(debouncer, std::string(520, '1') + "000000", time_ms, log);
+  ASSERT_EQ(log.events.size(), 3);
+  ASSERT_EQ(log.events[0].time_ms, 2);  // UINT32_MAX - 2 + 5
+  ASSERT_TRUE(log.events[1].repeat);
+  ASSERT_EQ(log.events[1].time_ms, 502);
+  ASSERT_FALSE(log.events[2].pressed);
+}
+
+// Nothing is lost while the queue is full, it just comes out late
+TEST(KeyDebouncerTest, Full_Queue) {
+  Debouncer debouncer;
+  EventLog log;
+  log.limit = 0;
+  uint32_t time_ms = 0;
+
+  play(debouncer, "11111111111", time_ms, log);
+  ASSERT_TRUE(log.events.empty());
+  ASSERT_FALSE(debouncer.isDown(0, 0));
+
+  log.limit = SIZE_MAX;
+  play(debouncer, "1", time_ms, log);
+  ASSERT_EQ(log.events.size(), 1);
+  ASSERT_TRUE(log.events[0].pressed);
+  ASSERT_EQ(log.events[0].time_ms, 11);
+}
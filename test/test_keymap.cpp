@@ -0,0 +1,92 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <type_traits>
+
+#include "alloc_counter.h"
+#include "keymap.h"
+#include "math/token.h"
+
+using keymap::Action;
+using keymap::keyAt;
+using keymap::KEYMAP;
+using picolator::math::tokenInfo;
+using picolator::math::TokenId;
+using picolator::math::tokenLetter;
+using picolator::math::TOKENS;
+using picolator::test::AllocCounter;
+
+// Both tables are built by the compiler, these would fail to compile if
+// anything in them needed a constructor to run
+static_assert(keyAt(0, 5, 1).token == TokenId::DIGIT_7);
+static_assert(keyAt(1, 8, 3).token == TokenId::ANS);
+// Layer 1 falls back to layer 0
+static_assert(keyAt(1, 5, 2).token == TokenId::DIGIT_8);
+static_assert(keyAt(1, 8, 4).action == Action::CALCULATE);
+static_assert(keyAt(1, 2, 0).action == Action::MODE);
+static_assert(keyAt(1, 4, 0).token == TokenId::I);
+static_assert(tokenInfo(TokenId::SIN).symbol == "sin");
+static_assert(std::is_trivially_destructible_v<keymap::Key>);
+static_assert(keymap::repeats(keyAt(0, 1, 1)));   // MOVE_LEFT
+static_assert(keymap::repeats(keyAt(0, 7, 0)));   // BACKSPACE
+static_assert(!keymap::repeats(keyAt(0, 8, 4)));  // CALCULATE
+static_assert(std::is_trivially_destructible_v<picolator::math::TokenInfo>);
+
+TEST(KeymapTest, Table_Size) {
+  size_t keys = keymap::LAYERS * MATRIX_COL_SIZE * MATRIX_ROW_SIZE;
+  printf("keymap %zu bytes, tokens %zu bytes\n", sizeof(KEYMAP),
+         sizeof(TOKENS));
+
+  // Two bytes a key so more layers are cheap
+  ASSERT_EQ(sizeof(KEYMAP), keys * 2);
+  ASSERT_EQ(sizeof(TOKENS), static_cast<size_t>(TokenId::COUNT) *
+                                sizeof(picolator::math::TokenInfo));
+}
+
+TEST(KeymapTest, Lookup_No_Allocations) {
+  AllocCounter counter;
+  size_t tokens = 0;
+  for (uint8_t layer = 0; layer < keymap::LAYERS; layer++) {
+    for (uint8_t col = 0; col < MATRIX_COL_SIZE; col++) {
+      for (uint8_t row = 0; row < MATRIX_ROW_SIZE; row++) {
+        auto key = keyAt(layer, col, row);
+        ASSERT_NE(key.action, Action::NONE);
+        if (key.action == Action::TOKEN) {
+          tokens += tokenInfo(key.token).symbol.size();
+        }
+      }
+    }
+  }
+  ASSERT_GT(tokens, 0);
+  ASSERT_EQ(counter.count(), 0);
+}
+
+// Letters only get built the first time a key is pressed
+TEST(KeymapTest, Token_Letters) {
+  for (size_t i = 1; i < static_cast<size_t>(TokenId::COUNT); i++) {
+    auto id = static_cast<TokenId>(i);
+    const auto& letter = tokenLetter(id);
+    ASSERT_EQ(letter->getSymbol(), tokenInfo(id).symbol);
+    ASSERT_EQ(letter->getClassification(), tokenInfo(id).classification);
+  }
+
+  AllocCounter counter;
+  for (size_t i = 1; i < static_cast<size_t>(TokenId::COUNT); i++) {
+    auto id = static_cast<TokenId>(i);
+    ASSERT_EQ(tokenLetter(id).get(), tokenLetter(id).get());
+  }
+  ASSERT_EQ(counter.count(), 0);
+
+  ASSERT_ANY_THROW(tokenLetter(TokenId::NONE));
+}
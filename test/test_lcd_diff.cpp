@@ -0,0 +1,115 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <larrys_pico/LCD1602.h>
+#include <larrys_pico/lcd_transport.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "fake_lcd_bus.h"
+
+using picolator::test::FakeLcdBus;
+
+namespace {
+
+// Draws two lines the way the callbacks do and renders them
+class Screen {
+ private:
+  std::string shown_[2] = {std::string(16, ' '), std::string(16, ' ')};
+
+ public:
+  FakeLcdBus bus;
+  LCD1602 lcd{bus};
+  size_t bytes = 0;
+  size_t legacy_bytes = 0;
+
+  Screen() { lcd.clear(); }
+
+  void show(const std::string& line0, const std::string& line1, int cursor) {
+    lcd.clear();
+    lcd.setCursor(0, 0);
+    lcd.put(line0);
+    lcd.setCursor(1, 0);
+    lcd.put(line1);
+    lcd.setCursor(0, cursor);
+    lcd.update();
+
+    bus.reset();
+    while (lcd.render()) {
+    }
+    bytes = bus.bytes;
+
+    // Before, every changed cell was its own cursor command and character
+    // write, then the cursor was set again
+    std::string want[2] = {line0, line1};
+    size_t changed = 0;
+    for (int i = 0; i < 2; i++) {
+      want[i].resize(16, ' ');
+      for (int j = 0; j < 16; j++) changed += want[i][j] != shown_[i][j];
+      shown_[i] = want[i];
+    }
+    legacy_bytes = changed * (2 * LcdTransport::BYTES_PER_BYTE + 1) +
+                   LcdTransport::BYTES_PER_BYTE + 1;
+
+    EXPECT_EQ(bus.screen[0], shown_[0]);
+    EXPECT_EQ(bus.screen[1], shown_[1]);
+  }
+};
+
+}  // namespace
+
+TEST(LcdDiffTest, Typical_Edits) {
+  Screen screen;
+  size_t total = 0;
+  size_t legacy_total = 0;
+  auto edit = [&](const char* name, const std::string& line0,
+                  const std::string& line1, int cursor) {
+    screen.show(line0, line1, cursor);
+    printf("%-16s %4zu bytes, %4zu before\n", name, screen.bytes,
+           screen.legacy_bytes);
+    EXPECT_LE(screen.bytes, screen.legacy_bytes) << name;
+    total += screen.bytes;
+    legacy_total += screen.legacy_bytes;
+  };
+
+  edit("type 1", "1", "=1", 1);
+  edit("type +", "1+", "", 2);
+  edit("type 2", "1+2", "=3", 3);
+  edit("type 5", "1+25", "=26", 4);
+  edit("backspace", "1+2", "=3", 3);
+  edit("insert in front", "31+2", "=33", 1);
+  edit("calculate", "31+2", "\x7E" "33", 0);
+  edit("recall history", "sin(0.5)*12+7", "=12.75322", 13);
+  edit("clear", "", "", 0);
+  printf("%-16s %4zu bytes, %4zu before (%.0f%% saved)\n", "total", total,
+         legacy_total, 100.0 - 100.0 * total / legacy_total);
+  ASSERT_LT(total * 3, legacy_total * 2);
+}
+
+TEST(LcdDiffTest, Runs) {
+  Screen screen;
+  screen.show("12345678901234", "", 14);
+
+  // Typing at the end needs no cursor command, the panel's cursor is
+  // already after the new character
+  screen.show("123456789012345", "", 15);
+  ASSERT_EQ(screen.bus.writes, 1);
+  ASSERT_EQ(screen.bus.lcd_bytes, 2);
+
+  // Cells one apart are rewritten in the same run, further apart they are
+  // separate writes
+  screen.show("a2b456789012345", "", 15);
+  ASSERT_EQ(screen.bus.lcd_bytes, 1 + 3 + 1);
+  screen.show("A2b4C6789012345", "", 15);
+  ASSERT_EQ(screen.bus.writes, 3);
+  ASSERT_EQ(screen.bus.lcd_bytes, 2 + 2 + 1);
+}
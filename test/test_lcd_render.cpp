@@ -0,0 +1,97 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+// Configure with -DPICOLATOR_TSAN=ON to have ThreadSanitizer check the
+// renderer thread for data races
+#include <larrys_pico/LCD1602.h>
+#include <larrys_pico/triple_buffer.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "fake_lcd_bus.h"
+
+using picolator::test::FakeLcdBus;
+
+// Sleeps instead of yield() so the other side gets to run even on one CPU
+static void backOff() {
+  std::this_thread::sleep_for(std::chrono::microseconds(1));
+}
+
+TEST(LcdRenderTest, Triple_Buffer) {
+  struct Frame {
+    uint32_t values[8];
+  };
+  const uint32_t frames = 20000;
+  TripleBuffer<Frame> buffer;
+  std::atomic<bool> done = false;
+
+  // The reader only ever sees whole frames and never goes backwards
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  uint32_t last = 0;
+  std::thread reader([&] {
+    while (!done.load() || last != frames) {
+      const Frame& frame = buffer.take();
+      for (uint32_t value : frame.values) {
+        if (value != frame.values[0]) torn++;
+      }
+      if (frame.values[0] < last) backwards++;
+      last = frame.values[0];
+      backOff();
+    }
+  });
+
+  for (uint32_t i = 1; i <= frames; i++) {
+    Frame& frame = buffer.back();
+    for (uint32_t& value : frame.values) value = i;
+    buffer.publish();
+    if (i % 64 == 0) backOff();
+  }
+  done.store(true);
+  reader.join();
+
+  ASSERT_EQ(torn, 0);
+  ASSERT_EQ(backwards, 0);
+}
+
+TEST(LcdRenderTest, Renderer_Thread) {
+  FakeLcdBus bus;
+  LCD1602 lcd(bus);
+  std::atomic<bool> stop = false;
+  // Renders from another thread, ie core 1 if it ever takes the LCD over
+  std::thread renderer([&] {
+    while (!stop.load()) {
+      if (!lcd.render()) backOff();
+    }
+  });
+
+  // Typing faster than the panel can keep up, update never waits
+  for (int i = 0; i < 500; i++) {
+    std::string equation = std::to_string(i) + "+1";
+    lcd.clear();
+    lcd.setCursor(0, 0);
+    lcd.put(equation);
+    lcd.setCursor(1, 0);
+    lcd.put("=" + std::to_string(i + 1));
+    lcd.setCursor(0, equation.size());
+    lcd.update();
+  }
+  lcd.waitForRender();
+  stop.store(true);
+  renderer.join();
+
+  ASSERT_EQ(bus.screen[0], "499+1           ");
+  ASSERT_EQ(bus.screen[1], "=500            ");
+}
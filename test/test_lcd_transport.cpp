@@ -0,0 +1,93 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <larrys_pico/LCD1602.h>
+#include <larrys_pico/lcd_transport.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "fake_lcd_bus.h"
+
+using picolator::test::FakeLcdBus;
+
+// What the old driver took for the same LCD bytes: six one byte writes with
+// three 600us sleeps per nibble at 100kHz
+static double legacyUs(size_t lcd_bytes) {
+  return lcd_bytes * (6 * 2 * 9 * 1e6 / 100000 + 6 * 600.0);
+}
+
+TEST(LcdTransportTest, Init_And_Write) {
+  FakeLcdBus bus;
+  LcdTransport transport(bus);
+  transport.init();
+  const char text[] = "Picolator";
+  transport.writeAt(1, 3, text, sizeof(text) - 1);
+  ASSERT_EQ(bus.screen[1], "   Picolator    ");
+  ASSERT_EQ(bus.screen[0], std::string(16, ' '));
+
+  // One write for the cursor and every character
+  bus.reset();
+  transport.writeAt(0, 0, "12345", 5);
+  ASSERT_EQ(bus.writes, 1);
+  ASSERT_EQ(bus.lcd_bytes, 6);
+  ASSERT_EQ(bus.bytes, 6 * LcdTransport::BYTES_PER_BYTE + 1);
+  ASSERT_EQ(bus.delay_us, 0);
+  ASSERT_EQ(bus.screen[0], "12345           ");
+
+  // Custom characters don't land on the screen
+  uint8_t smile[8] = {0x00, 0x00, 0x0A, 0x00, 0x11, 0x0E, 0x00, 0x00};
+  transport.createChar(1, smile);
+  transport.writeAt(0, 5, "\x01", 1);
+  ASSERT_EQ(bus.screen[0], "12345\x01          ");
+}
+
+TEST(LcdTransportTest, Update_Bus_Time) {
+  FakeLcdBus bus;
+  LCD1602 lcd(bus);
+  lcd.clear();
+  lcd.update();
+  while (lcd.render()) {
+  }
+
+  // Both lines from blank, the worst case for a single update
+  bus.reset();
+  lcd.setCursor(0, 0);
+  lcd.put("1234567890+12345");
+  lcd.setCursor(1, 0);
+  lcd.put("=1234567890.1234");
+  lcd.update();
+  // Nothing is sent until the renderer gets to it
+  ASSERT_EQ(bus.writes, 0);
+  while (lcd.render()) {
+  }
+  ASSERT_EQ(bus.screen[0], "1234567890+12345");
+  ASSERT_EQ(bus.screen[1], "=1234567890.1234");
+
+  printf("full redraw: %zu writes, %zu bytes, %zu lcd bytes\n", bus.writes,
+         bus.bytes, bus.lcd_bytes);
+  printf("  %.0f us on the bus at %.0fkHz, %.0f us before\n", bus.totalUs(),
+         FakeLcdBus::BAUD / 1000, legacyUs(bus.lcd_bytes));
+  ASSERT_LT(bus.totalUs() * 10, legacyUs(bus.lcd_bytes));
+
+  // Changing one character only sends that character, the panel's cursor
+  // ends up after it which is where it should be
+  bus.reset();
+  lcd.setCursor(1, 1);
+  lcd.put('9');
+  lcd.update();
+  while (lcd.render()) {
+  }
+  ASSERT_EQ(bus.screen[1], "=9234567890.1234");
+  ASSERT_EQ(bus.lcd_bytes, 2);
+  ASSERT_EQ(bus.writes, 1);
+}
@@ -11,6 +11,13 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "math/error.h"
+#include "math/eval_environment.h"
 #include "math/literals.h"
 
 using picolator::math::Literals;
@@ -60,8 +67,222 @@ TEST(LiteralsTest, Addition) {
       2 * picolator::math::PI::value);
 }
 
-// Tests that Variables work as expected
+// Variables are only placeholders, the value comes from an EvalEnvironment
 TEST(LiteralsTest, Variable) {
-  Literals::getVariable('A') = Literals(10);
-  ASSERT_EQ(Literals('A').getValue(), 10);
+  picolator::math::EvalEnvironment env;
+  env.variable('A') = Literals(10);
+  ASSERT_EQ(Literals('A').getTokenType(), Literals::Type::VARIABLE);
+  ASSERT_EQ(Literals('A').getVariableName(), 'A');
+  ASSERT_EQ(env.variable('A').getValue(), 10);
+  ASSERT_EQ(env.ans().getValue(), 0);
+  ASSERT_THROW(env.variable('G'), picolator::math::DomainError);
+}
+
+TEST(LiteralsTest, Division) {
+  ASSERT_EQ((Literals(6) / Literals(3)).getType(), Literals::Type::LONG);
+  ASSERT_EQ((Literals(2) / Literals(4)).toString(), "1/2");
+
+  // Negative divisors used to be treated as 0
+  ASSERT_EQ((Literals(3) / Literals(-6)).toString(), "-1/2");
+  ASSERT_ANY_THROW(Literals(3) / Literals(0));
+
+  // Constants cancel
+  ASSERT_EQ((Literals(Literals::Type::PI, 4, 2) / Literals(Literals::Type::PI))
+                .toString(),
+            "4\xF7");
+  ASSERT_EQ((Literals(2) / Literals(Literals::Type::PI)).toString(), "2/\xF7");
+}
+
+// Number is the value type behind Literals, it has to stay small and never
+// touch the heap
+TEST(LiteralsTest, Number) {
+  using picolator::math::Number;
+
+  Number frac = Number::fraction(4, -8);
+  ASSERT_EQ(frac.kind, Number::Kind::FRACTION);
+  ASSERT_EQ(frac.num, -1);
+  ASSERT_EQ(frac.den, 2);
+  ASSERT_EQ(Number::fraction(4, 2).kind, Number::Kind::LONG);
+
+  ASSERT_EQ((Number::fraction(2, 3) ^ Number::fromLong(-2)).toString(), "9/4");
+  ASSERT_EQ((Number::fromLong(7) % Number::fromLong(4)).num, 3);
+  ASSERT_ANY_THROW(Number::fromDouble(7) % Number::fromLong(4));
+
+  // pi^2 / pi^2 is rational again
+  Number pi2 = Number::monomial(1, 1, 2, 0);
+  ASSERT_EQ((pi2 / pi2).kind, Number::Kind::LONG);
+}
+
+TEST(LiteralsTest, Decimals) {
+  using picolator::math::Number;
+
+  Literals a(Number::parseDecimal("0.1")), b(Number::parseDecimal("0.2"));
+  ASSERT_EQ(a.getType(), Literals::Type::DECIMAL);
+  Literals sum = a + b;
+  ASSERT_EQ(sum.getType(), Literals::Type::DECIMAL);
+  ASSERT_EQ(sum.toString(), "0.3");
+  ASSERT_EQ(sum.getValue(), 0.3);
+  ASSERT_EQ(sum, Literals(Number::parseDecimal("0.30")));
+
+  Literals price(Number::parseDecimal("19.99"));
+  ASSERT_EQ((price * Literals(3)).toString(), "59.97");
+  ASSERT_EQ((price * Literals(Number::parseDecimal("0.5"))).toString(),
+            "9.995");
+  ASSERT_EQ((-price).toString(), "-19.99");
+  ASSERT_EQ((Literals(Number::parseDecimal("0.05")) ^ Literals(2)).toString(),
+            "0.0025");
+
+  // Whole numbers and divisions that end stay exact
+  ASSERT_EQ((sum * Literals(10)).getType(), Literals::Type::LONG);
+  ASSERT_EQ((Literals(1) / Literals(Number::parseDecimal("0.8"))).toString(),
+            "1.25");
+  Literals third = Literals(1) / Literals(Number::parseDecimal("0.3"));
+  ASSERT_EQ(third.toString(), "10/3");
+
+  // Too many digits for the mantissa, the tokenizer redoes it as a BigRational
+  ASSERT_EQ(Number::parseDecimal("1234567890.1234567890").kind,
+            Number::Kind::BIG);
+  ASSERT_EQ(Number::parseDecimal("2.").kind, Number::Kind::LONG);
+
+  // Overflowing the mantissa keeps going as a BigRational
+  Literals tiny(Number::parseDecimal("0.000000001"));
+  Literals small = tiny * tiny * tiny;
+  ASSERT_EQ(small.getType(), Literals::Type::DECIMAL);
+  ASSERT_TRUE((small + Literals(1)).isExact());
+  ASSERT_EQ(((small + Literals(1)) + (-small)).toString(), "1");
+}
+
+TEST(LiteralsTest, Move_Semantics) {
+  static_assert(std::is_nothrow_move_constructible_v<Literals>);
+  static_assert(std::is_nothrow_move_assignable_v<Literals>);
+
+  // Big enough to need a BigRational
+  Literals big = Literals(2) ^ Literals(200);
+  Literals other = Literals(3) ^ Literals(150);
+
+  picolator::test::AllocCounter counter;
+  Literals moved(std::move(big));
+  moved = std::move(other);
+  ASSERT_EQ(counter.count(), 0);
+  ASSERT_EQ(moved, Literals(3) ^ Literals(150));
+
+  // Copies share the BigRational and the symbol isn't built yet
+  picolator::test::AllocCounter copy_counter;
+  Literals copy(moved);
+  ASSERT_EQ(copy_counter.count(), 0);
+}
+
+TEST(LiteralsTest, Lazy_Symbol) {
+  Literals half(0.5);
+
+  // Nothing gets printed until the symbol is asked for
+  picolator::test::AllocCounter counter;
+  Literals res = half * Literals(3);
+  Literals sum = Literals(1, 3) + Literals(1, 6);
+  ASSERT_EQ(counter.count(), 0);
+
+  ASSERT_EQ(res.getSymbol(), "1.500000");
+  ASSERT_EQ(sum.getSymbol(), "1/2");
+  ASSERT_EQ(Literals(1, 3).getSymbol(), "1/3");
+
+  // Tokens keep their own symbol
+  ASSERT_EQ(Literals('A').getSymbol(), "A");
+  ASSERT_EQ(Literals(Literals::Type::PI).getSymbol(), "\xF7");
+}
+
+TEST(LiteralsTest, Fraction_Chain_Allocations) {
+  Literals sum(0), product(1);
+  picolator::test::AllocCounter counter;
+  for (int i = 1; i <= 10; i++) {
+    sum += Literals(1, i);
+    product *= Literals(i, i + 1);
+  }
+  sum = sum / product;
+  ASSERT_EQ(counter.count(), 0);
+  ASSERT_EQ(sum.toString(), "81191/2520");
+}
+
+TEST(LiteralsTest, Monomials) {
+  const double pi = picolator::math::PI::value;
+  const double e = picolator::math::E::value;
+  Literals l_pi(Literals::Type::PI), l_e(Literals::Type::E);
+
+  Literals pi_e = l_pi * l_e;
+  ASSERT_EQ(pi_e.getType(), Literals::Type::MONOMIAL);
+  ASSERT_EQ(pi_e.toString(), "\xF7" "e");
+  ASSERT_DOUBLE_EQ(pi_e.getValue(), pi * e);
+
+  ASSERT_EQ((Literals(2) * l_pi / l_e).toString(), "2\xF7/e");
+  ASSERT_EQ((Literals(3) / (l_pi * l_pi * l_e)).toString(), "3/\xF7^2" "e");
+  ASSERT_EQ((-pi_e).toString(), "-\xF7" "e");
+
+  // Cancels back to a plain number
+  ASSERT_EQ((pi_e / l_e / l_pi).getType(), Literals::Type::LONG);
+}
+
+TEST(LiteralsTest, Polynomials) {
+  const double pi = picolator::math::PI::value;
+  Literals l_pi(Literals::Type::PI), l_e(Literals::Type::E);
+
+  Literals sum = Literals(2) + l_pi;
+  ASSERT_EQ(sum.getType(), Literals::Type::POLYNOMIAL);
+  ASSERT_EQ(sum.toString(), "\xF7+2");
+  ASSERT_DOUBLE_EQ(sum.getValue(), 2 + pi);
+
+  // Goes back to a LONG once the pi cancels
+  Literals back = sum + (-l_pi);
+  ASSERT_EQ(back.getType(), Literals::Type::LONG);
+  ASSERT_EQ(back.toString(), "2");
+
+  Literals square = (Literals(1) + l_pi) ^ Literals(2);
+  ASSERT_EQ(square.toString(), "\xF7^2+2\xF7+1");
+  ASSERT_DOUBLE_EQ(square.getValue(), (1 + pi) * (1 + pi));
+
+  ASSERT_EQ(((Literals(1) + l_pi) / l_pi).toString(), "1+1/\xF7");
+
+  // Only division by a single term stays exact
+  Literals quotient = (Literals(1) + l_pi) / (Literals(1) + l_e);
+  ASSERT_EQ(quotient.getType(), Literals::Type::DOUBLE);
+}
+
+// The compound ops update a plain Number in place and fall back to the
+// binary ops for everything else, either way the results have to match
+TEST(LiteralsTest, Compound_Matches_Binary) {
+  const double pi = picolator::math::PI::value;
+  Literals big = Literals(2) ^ Literals(70);
+  std::vector<Literals> values = {Literals(3),
+                                  Literals(2, 7),
+                                  Literals(0.5),
+                                  Literals(Literals::Type::PI),
+                                  Literals(Literals::Type::COMPLEX),
+                                  big,
+                                  Literals(Literals::Type::PI) + Literals(1),
+                                  Literals(int64_t{1} << 40)};
+  for (const auto& lhs : values) {
+    for (const auto& rhs : values) {
+      Literals sum = lhs, product = lhs, quotient = lhs;
+      sum += rhs;
+      product *= rhs;
+      quotient /= rhs;
+      ASSERT_EQ(sum.toString(), (lhs + rhs).toString());
+      ASSERT_EQ(product.toString(), (lhs * rhs).toString());
+      ASSERT_EQ(quotient.toString(), (lhs / rhs).toString());
+      ASSERT_EQ(sum.getType(), (lhs + rhs).getType());
+      ASSERT_EQ(product.getValue(), (lhs * rhs).getValue());
+    }
+  }
+
+  // The token's symbol doesn't stick around
+  Literals typed(Literals::Type::PI);
+  typed *= Literals(2);
+  ASSERT_EQ(typed.getSymbol(), "2\xF7");
+
+  // rhs can be the same literal
+  Literals x(Literals::Type::PI);
+  x *= x;
+  ASSERT_DOUBLE_EQ(x.getValue(), pi * pi);
+  Literals y(1 << 20);
+  y *= y;
+  y *= y;
+  ASSERT_EQ(y.toString(), (Literals(2) ^ Literals(80)).toString());
 }
@@ -0,0 +1,313 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "alloc_counter.h"
+#include "math/binary_operator.h"
+#include "math/bracket.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+#include "math/program.h"
+#include "math/unary_operator.h"
+
+using picolator::math::BinaryOperator;
+using picolator::math::Bracket;
+using picolator::math::EvalEnvironment;
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::Program;
+using picolator::math::UnaryOperator;
+
+TEST(ProgramTest, Postfix_Order) {
+  // A+B*C, variables so it doesn't get folded
+  ExprTree tree({ExprTree::LetterPtr(new Literals('A')),
+                 ExprTree::LetterPtr(
+                     new BinaryOperator("+", BinaryOperator::Type::ADDITION)),
+                 ExprTree::LetterPtr(new Literals('B')),
+                 ExprTree::LetterPtr(new BinaryOperator(
+                     "*", BinaryOperator::Type::MULTIPLICATION)),
+                 ExprTree::LetterPtr(new Literals('C'))});
+
+  const auto& code = tree.getProgram().getCode();
+  ASSERT_EQ(5, code.size());
+  ASSERT_EQ(Program::OpCode::LOAD_SLOT, code[0].op);
+  ASSERT_EQ(Program::OpCode::LOAD_SLOT, code[1].op);
+  ASSERT_EQ(Program::OpCode::LOAD_SLOT, code[2].op);
+  ASSERT_EQ(Program::OpCode::BINARY, code[3].op);
+  ASSERT_EQ(static_cast<uint16_t>(BinaryOperator::Type::MULTIPLICATION),
+            code[3].arg);
+  ASSERT_EQ(Program::OpCode::BINARY, code[4].op);
+  ASSERT_EQ(static_cast<uint16_t>(BinaryOperator::Type::ADDITION),
+            code[4].arg);
+
+  EvalEnvironment env;
+  env.variable('A') = Literals(1);
+  env.variable('B') = Literals(2);
+  env.variable('C') = Literals(3);
+  ASSERT_EQ(tree.getProgram().run(env), Literals(7));
+}
+
+TEST(ProgramTest, Run_With_New_Variables) {
+  // -(2*A)+ANS
+  ExprTree tree({ExprTree::LetterPtr(
+                     new UnaryOperator("-", UnaryOperator::Type::MINUS)),
+                 ExprTree::LetterPtr(new Bracket(Bracket::Type::OPEN)),
+                 ExprTree::LetterPtr(new Literals(2)),
+                 ExprTree::LetterPtr(new BinaryOperator(
+                     "*", BinaryOperator::Type::MULTIPLICATION)),
+                 ExprTree::LetterPtr(new Literals('A')),
+                 ExprTree::LetterPtr(new Bracket(Bracket::Type::CLOSED)),
+                 ExprTree::LetterPtr(
+                     new BinaryOperator("+", BinaryOperator::Type::ADDITION)),
+                 ExprTree::LetterPtr(new Literals(Literals::Type::ANS))});
+
+  const auto& code = tree.getProgram().getCode();
+  // Variables are bound to their slot when compiled
+  ASSERT_EQ(Program::OpCode::LOAD_SLOT, code[1].op);
+  ASSERT_EQ(EvalEnvironment::variableSlot('A'), code[1].arg);
+  ASSERT_EQ(Program::OpCode::UNARY, code[3].op);
+  ASSERT_EQ(Program::OpCode::LOAD_SLOT, code[4].op);
+  ASSERT_EQ(EvalEnvironment::ANS_SLOT, code[4].arg);
+
+  EvalEnvironment env;
+  env.ans() = Literals(100);
+  for (int a = 0; a < 10; a++) {
+    env.variable('A') = Literals(a);
+    ASSERT_EQ(tree.getProgram().run(env), Literals(100 - 2 * a));
+  }
+
+  // Fractions stay exact
+  env.variable('A') = Literals(1, 4);
+  ASSERT_EQ(tree.getValue(env)->toString(), "199/2");
+
+  // Nothing is shared between environments
+  ASSERT_EQ(tree.getValue()->getValue(), 0);
+}
+
+TEST(ProgramTest, Empty) {
+  Program program;
+  ASSERT_TRUE(program.empty());
+  ASSERT_THROW(program.run(), picolator::math::SyntaxError);
+}
+
+static ExprTree::LetterPtr op_add(
+    new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+static ExprTree::LetterPtr op_mul(
+    new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION));
+static ExprTree::LetterPtr op_div(
+    new BinaryOperator("/", BinaryOperator::Type::DIVISION));
+static ExprTree::LetterPtr op_sin(
+    new UnaryOperator("sin", UnaryOperator::Type::SIN));
+static ExprTree::LetterPtr b_open(new Bracket(Bracket::Type::OPEN));
+static ExprTree::LetterPtr b_close(new Bracket(Bracket::Type::CLOSED));
+
+TEST(ProgramTest, Constant_Folding) {
+  // sin(2pi)+sin(2pi)*3
+  ExprTree::LetterPtr two_pi(new Literals(Literals::Type::PI, 2, 1));
+  ExprTree::LetterPtr three(new Literals(3));
+  ExprTree tree({op_sin, b_open, two_pi, b_close, op_add, op_sin, b_open,
+                 two_pi, b_close, op_mul, three});
+
+  const auto& code = tree.getProgram().getCode();
+  ASSERT_EQ(1, code.size());
+  ASSERT_EQ(Program::OpCode::PUSH_LITERAL, code[0].op);
+  ASSERT_EQ(tree.getValue()->getValue(), 0);
+}
+
+TEST(ProgramTest, Folding_Stays_Exact) {
+  ExprTree::LetterPtr one(new Literals(1));
+  ExprTree::LetterPtr three(new Literals(3));
+  ExprTree::LetterPtr pi(new Literals(Literals::Type::PI));
+
+  // 1/3+1/3
+  ExprTree fraction({one, op_div, three, op_add, one, op_div, three});
+  ASSERT_EQ(1, fraction.getProgram().getCode().size());
+  ASSERT_EQ(Literals::Type::FRACTION, fraction.getValue()->getType());
+  ASSERT_EQ("2/3", fraction.getValue()->toString());
+
+  // 3*pi*pi
+  ExprTree constant({three, op_mul, pi, op_mul, pi});
+  ASSERT_EQ(1, constant.getProgram().getCode().size());
+  ASSERT_EQ(Literals::Type::PI, constant.getValue()->getType());
+  ASSERT_EQ("3\xF7^2", constant.getValue()->toString());
+}
+
+TEST(ProgramTest, Folding_Keeps_Errors) {
+  ExprTree::LetterPtr zero(new Literals(0));
+
+  // 1/0 can't be folded, it should still fail when it is solved
+  ExprTree tree({ExprTree::LetterPtr(new Literals(1)), op_div, zero});
+  ASSERT_EQ(3, tree.getProgram().getCode().size());
+  ASSERT_ANY_THROW(tree.getValue());
+}
+
+TEST(ProgramTest, Common_Subexpression) {
+  // sin(A*2)+sin(A*2)*(1+2)
+  ExprTree::LetterPtr a(new Literals('A'));
+  ExprTree::LetterPtr two(new Literals(2));
+  ExprTree tree({op_sin, b_open, a, op_mul, two, b_close, op_add, op_sin,
+                 b_open, ExprTree::LetterPtr(new Literals('A')), op_mul,
+                 ExprTree::LetterPtr(new Literals(2)), b_close, op_mul, b_open,
+                 ExprTree::LetterPtr(new Literals(1)), op_add,
+                 ExprTree::LetterPtr(new Literals(2)), b_close});
+
+  // A 2 * sin STORE LOAD 3 * +
+  const auto& code = tree.getProgram().getCode();
+  ASSERT_EQ(9, code.size());
+  ASSERT_EQ(1, std::count_if(code.begin(), code.end(), [](const auto& ins) {
+              return ins.op == Program::OpCode::LOAD_SLOT;
+            }));
+  ASSERT_EQ(Program::OpCode::STORE_TEMP, code[4].op);
+  ASSERT_EQ(Program::OpCode::LOAD_TEMP, code[5].op);
+
+  EvalEnvironment env;
+  for (int i = 0; i < 4; i++) {
+    env.variable('A') = Literals(i);
+    ASSERT_EQ(tree.getProgram().run(env), Literals(4 * sin(2.0 * i)));
+  }
+}
+
+// A/2+A/3+...+A/n, the stack and temps are the only allocations no matter how
+// many fractions get added up
+TEST(ProgramTest, Fraction_Chain_Allocations) {
+  auto chain = [](int n) {
+    ExprTree::ExprVec equation;
+    for (int i = 2; i <= n; i++) {
+      if (i != 2) {
+        equation.emplace_back(
+            new BinaryOperator("+", BinaryOperator::Type::ADDITION));
+      }
+      equation.emplace_back(new Literals('A'));
+      equation.emplace_back(
+          new BinaryOperator("/", BinaryOperator::Type::DIVISION));
+      equation.emplace_back(new Literals(i));
+    }
+    return ExprTree(equation);
+  };
+  ExprTree short_chain = chain(3);
+  ExprTree long_chain = chain(12);
+  EvalEnvironment env;
+  env.variable('A') = Literals(1);
+
+  picolator::test::AllocCounter short_counter;
+  Literals short_res = short_chain.getProgram().run(env);
+  size_t short_allocs = short_counter.count();
+
+  picolator::test::AllocCounter long_counter;
+  Literals long_res = long_chain.getProgram().run(env);
+  size_t long_allocs = long_counter.count();
+
+  ASSERT_EQ(short_res.toString(), "5/6");
+  ASSERT_EQ(long_res.toString(), "58301/27720");
+  ASSERT_LE(short_allocs, 2);
+  ASSERT_EQ(long_allocs, short_allocs);
+}
+
+TEST(ProgramTest, Modes) {
+  using picolator::math::Fixed;
+  using LP = ExprTree::LetterPtr;
+
+  // sin(A)*A+A/3
+  ExprTree tree(
+      {LP(new UnaryOperator("sin", UnaryOperator::Type::SIN)),
+       LP(new Bracket(Bracket::Type::OPEN)), LP(new Literals('A')),
+       LP(new Bracket(Bracket::Type::CLOSED)),
+       LP(new BinaryOperator("*", BinaryOperator::Type::MULTIPLICATION)),
+       LP(new Literals('A')),
+       LP(new BinaryOperator("+", BinaryOperator::Type::ADDITION)),
+       LP(new Literals('A')),
+       LP(new BinaryOperator("/", BinaryOperator::Type::DIVISION)),
+       LP(new Literals(3))});
+  const Program& program = tree.getProgram();
+
+  EvalEnvironment env;
+  for (double a = -5; a <= 5; a += 0.5) {
+    env.variable('A') = Literals(a);
+    double expected = std::sin(a) * a + a / 3;
+    ASSERT_DOUBLE_EQ(program.runAs<double>(env), expected);
+    ASSERT_NEAR(program.runAs<float>(env), expected, 1e-5);
+    ASSERT_NEAR(static_cast<double>(program.runAs<Fixed>(env)), expected,
+                1e-8);
+    ASSERT_NEAR(tree.getValue(Program::Mode::FIXED, env)->getValue(),
+                expected, 1e-8);
+  }
+  ASSERT_EQ(tree.getValue(Program::Mode::FLOAT)->getType(),
+            Literals::Type::DOUBLE);
+
+  // Same errors as the exact path, A is 0
+  ExprTree ln({LP(new UnaryOperator("ln", UnaryOperator::Type::LN)),
+               LP(new Bracket(Bracket::Type::OPEN)), LP(new Literals('A')),
+               LP(new Bracket(Bracket::Type::CLOSED))});
+  ASSERT_THROW(ln.getProgram().runAs<Fixed>(), picolator::math::DomainError);
+  ASSERT_THROW(ln.getProgram().runAs<float>(), picolator::math::DomainError);
+}
+
+// Constants are only folded with exact math for EXACT, the other modes see
+// the same rounding and overflow a variable would
+TEST(ProgramTest, Modes_Constants) {
+  using picolator::math::Fixed;
+  using LP = ExprTree::LetterPtr;
+  LP big(new Literals(100000));
+  LP ten(new Literals(10));
+
+  // (100000*100000)/100000, too big for Q32.32 part way through
+  ExprTree overflow({b_open, big, op_mul, big, b_close, op_div, big});
+  ASSERT_EQ(1, overflow.getProgram().getCode().size());
+  ASSERT_EQ(overflow.getValue()->getValue(), 100000);
+  ASSERT_EQ(overflow.getValue(Program::Mode::DOUBLE)->getValue(), 100000);
+  ASSERT_EQ(overflow.getValue(Program::Mode::FLOAT)->getValue(), 100000);
+  // Only the repeated 100000 gets merged
+  ASSERT_EQ(overflow.compile(Program::Mode::FIXED).getCode().size(), 6);
+  ASSERT_NEAR(overflow.getValue(Program::Mode::FIXED)->getValue(),
+              static_cast<double>(Fixed::max()) / 100000, 1e-6);
+
+  // 1/10+2/10, 3/10 exactly but not in binary
+  ExprTree tenths({LP(new Literals(1)), op_div, ten, op_add,
+                   LP(new Literals(2)), op_div, ten});
+  ASSERT_EQ(tenths.getValue()->getValue(), 0.3);
+  ASSERT_EQ(tenths.getValue(Program::Mode::DOUBLE)->getValue(), 0.1 + 0.2);
+  ASSERT_EQ(tenths.getValue(Program::Mode::FLOAT)->getValue(),
+            static_cast<double>(0.1f + 0.2f));
+  ASSERT_NE(tenths.getValue(Program::Mode::FIXED)->getValue(), 0.3);
+  ASSERT_NEAR(tenths.getValue(Program::Mode::FIXED)->getValue(), 0.3, 1e-9);
+
+  // Solving for a mode compiles for it from the start
+  auto result = ExprTree::evaluate(
+      {b_open, big, op_mul, big, b_close, op_div, big}, Program::Mode::FIXED);
+  ASSERT_TRUE(result.ok());
+  ASSERT_NEAR(result.value()->getValue(),
+              static_cast<double>(Fixed::max()) / 100000, 1e-6);
+}
+
+TEST(ProgramTest, Cancel_Folding) {
+  // 3^9000 is constant, folding it is where all the time goes
+  ExprTree::LetterPtr three(new Literals(3));
+  ExprTree::LetterPtr power(new Literals(9000));
+  ExprTree::LetterPtr op_exp(
+      new BinaryOperator("^", BinaryOperator::Type::EXPONENT));
+  ExprTree tree({three, op_exp, power, op_mul, three, op_exp, power});
+
+  std::atomic<bool> cancel = true;
+  EvalEnvironment env;
+  env.setCancelFlag(&cancel);
+  ASSERT_THROW(tree.compile(Program::Mode::EXACT, env),
+               picolator::math::Cancelled);
+  // Nothing gets folded for the other modes, 3^9000 is still only solved
+  // once
+  ASSERT_EQ(tree.compile(Program::Mode::DOUBLE, env).getCode().size(), 6);
+
+  cancel = false;
+  ASSERT_EQ(tree.compile(Program::Mode::EXACT, env).getCode().size(), 1);
+}
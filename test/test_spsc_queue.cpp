@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+// Configure with -DPICOLATOR_TSAN=ON to have ThreadSanitizer check the stress
+// test for data races
+#include <larrys_pico/spsc_queue.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+TEST(SpscQueueTest, Order) {
+  SpscQueue<int, 4> queue;
+  int item = -1;
+  ASSERT_TRUE(queue.empty());
+  ASSERT_FALSE(queue.pop(item));
+
+  // Holds capacity - 1, then wraps around
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 3; i++) ASSERT_TRUE(queue.push(round * 10 + i));
+    ASSERT_FALSE(queue.push(99));
+    ASSERT_EQ(queue.size(), 3);
+    for (int i = 0; i < 3; i++) {
+      ASSERT_TRUE(queue.pop(item));
+      ASSERT_EQ(item, round * 10 + i);
+    }
+    ASSERT_TRUE(queue.empty());
+  }
+}
+
+// Sleeps instead of yield() so the other side gets to run even on one CPU
+static void backOff() {
+  std::this_thread::sleep_for(std::chrono::microseconds(1));
+}
+
+// Every item comes out once, in order, with one thread on each end
+TEST(SpscQueueTest, Concurrent_Stress) {
+  const uint32_t items = 200000;
+  struct Event {
+    uint32_t sequence;
+    uint32_t check;
+  };
+  SpscQueue<Event, 64> queue;
+
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < items; i++) {
+      while (!queue.push({i, ~i})) backOff();
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t wrong = 0;
+  Event event;
+  while (expected < items) {
+    if (!queue.pop(event)) {
+      backOff();
+      continue;
+    }
+    if (event.sequence != expected || event.check != ~expected) wrong++;
+    expected++;
+  }
+  producer.join();
+
+  ASSERT_EQ(wrong, 0);
+  ASSERT_TRUE(queue.empty());
+}
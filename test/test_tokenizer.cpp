@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 2022 Larry Milne (https://www.larrycloud.ca)
+ *
+ * This code is distributed on "AS IS" BASIS,
+ * WITHOUT WARRANTINES OR CONDITIONS OF ANY KIND.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @author: qawse3dr a.k.a Larry Milne
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "alloc_counter.h"
+#include "math/expr_tree.h"
+#include "math/literals.h"
+#include "math/math_util.h"
+#include "math/token.h"
+#include "math/tokenizer.h"
+
+using picolator::math::ExprTree;
+using picolator::math::Literals;
+using picolator::math::Number;
+using picolator::math::TokenId;
+using picolator::math::Tokenizer;
+
+// Keys for a string like "2(3.5)+p", p is pi
+static ExprTree::ExprVec keys(const std::string& text) {
+  ExprTree::ExprVec letters;
+  for (char c : text) {
+    TokenId id = TokenId::NONE;
+    if (c >= '0' && c <= '9') {
+      id = static_cast<TokenId>(static_cast<int>(TokenId::DIGIT_0) + c - '0');
+    } else if (c == '.') {
+      id = TokenId::DECIMAL;
+    } else if (c == '+') {
+      id = TokenId::ADD;
+    } else if (c == '-') {
+      id = TokenId::SUB;
+    } else if (c == '(') {
+      id = TokenId::OPEN;
+    } else if (c == ')') {
+      id = TokenId::CLOSED;
+    } else if (c == 'p') {
+      id = TokenId::PI;
+    }
+    letters.push_back(picolator::math::tokenLetter(id));
+  }
+  return letters;
+}
+
+static ExprTree::ExprVec tokenize(const ExprTree::ExprVec& letters) {
+  Tokenizer tokenizer;
+  for (size_t i = 0; i < letters.size(); i++) {
+    tokenizer.add(letters, i);
+  }
+  tokenizer.finish(letters);
+  return tokenizer.getTokens();
+}
+
+static ExprTree::ExprVec tokenize(const std::string& text) {
+  return tokenize(keys(text));
+}
+
+static const Literals& number(const std::string& text) {
+  static ExprTree::ExprVec tokens;
+  tokens = tokenize(text);
+  EXPECT_EQ(tokens.size(), 1);
+  return reinterpret_cast<const Literals&>(*tokens[0]);
+}
+
+static double solve(const std::string& text) {
+  return ExprTree(keys(text)).getValue()->getValue();
+}
+
+TEST(TokenizerTest, Numbers) {
+  ASSERT_EQ(number("12.50").getNumber().kind, Number::Kind::DECIMAL);
+  ASSERT_EQ(number("12.50").toString(), "12.5");
+  ASSERT_EQ(number("007").getNumber().kind, Number::Kind::LONG);
+  ASSERT_EQ(number("007").getValue(), 7);
+  ASSERT_EQ(number("0.001").getValue(), 0.001);
+  ASSERT_EQ(number("2.").getValue(), 2);
+  // Like stod everything past a second point is ignored
+  ASSERT_EQ(number("1.2.3").getValue(), 1.2);
+  ASSERT_EQ(number("9223372036854775807").getNumber().num, INT64_MAX);
+}
+
+TEST(TokenizerTest, Long_Numbers) {
+  // Past int64 they stay exact as a BigRational, like a computed 2^80
+  ASSERT_TRUE(number("12345678901234567890123").isExact());
+  ASSERT_EQ(number("12345678901234567890123").toString(),
+            "12345678901234567890123");
+  ASSERT_EQ(number("12345678901234567890.5").toString(),
+            "24691357802469135781/2");
+  ASSERT_EQ(number("9007199254740993.00000000000001").toString(),
+            "900719925474099300000000000001/100000000000000");
+  // Only the mantissa has to fit in int64
+  ASSERT_EQ(number("0." + std::string(50, '0') + "1").getNumber().kind,
+            Number::Kind::DECIMAL);
+  ASSERT_EQ(number(std::string(100, '9')).toString(), std::string(100, '9'));
+  ASSERT_DOUBLE_EQ(number(std::string(60, '9')).getValue(), 1e60);
+
+  // 12345678901234567890123-12345678901234567890122
+  ASSERT_EQ(solve("12345678901234567890123-12345678901234567890122"), 1);
+  auto result = ExprTree::evaluate(keys(std::string(100, '9') + "+1"));
+  ASSERT_TRUE(result);
+  ASSERT_EQ((*result)->toString(), "1" + std::string(100, '0'));
+}
+
+TEST(TokenizerTest, Implicit_Multiplication) {
+  ASSERT_EQ(solve("2(3)"), 6);
+  ASSERT_EQ(solve("(2)(3)"), 6);
+  ASSERT_EQ(solve("(2)3"), 6);
+  ASSERT_DOUBLE_EQ(solve("2p"), 2 * M_PI);
+  ASSERT_DOUBLE_EQ(solve("p2"), 2 * M_PI);
+  ASSERT_DOUBLE_EQ(solve("pp"), M_PI * M_PI);
+  // Subtraction still becomes + and a unary minus, no * in between
+  ASSERT_EQ(solve("2-3"), -1);
+  ASSERT_EQ(solve("(2)-3"), -1);
+  ASSERT_EQ(tokenize("2(3)").size(), 5);
+}
+
+TEST(TokenizerTest, No_Per_Digit_Allocations) {
+  ExprTree::ExprVec short_letters = keys("1+2");
+  ExprTree::ExprVec long_letters = keys("123456789.125+2");
+
+  picolator::test::AllocCounter short_counter;
+  tokenize(short_letters);
+  size_t short_allocs = short_counter.count();
+
+  picolator::test::AllocCounter long_counter;
+  tokenize(long_letters);
+  size_t long_allocs = long_counter.count();
+
+  // Only the token vector and one Literals per number, never the digits
+  ASSERT_EQ(short_allocs, long_allocs);
+}